@@ -0,0 +1,65 @@
+#include "allocationcounter.h"
+#include <atomic>
+#include <cstddef>
+
+// glibc 导出的原始分配函数，替换后的 malloc 等转调它们
+extern "C" {
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t count, size_t size);
+void *__libc_realloc(void *pointer, size_t size);
+}
+
+static std::atomic<qint64> allocationCount(0);
+static std::atomic<qint64> allocationBytes(0);
+// 常量初始化的线程局部变量，访问时不会反过来调用 malloc
+static thread_local bool threadEnabled = true;
+
+static inline void countAllocation(size_t size)
+{
+    if (threadEnabled) {
+        allocationCount.fetch_add(1, std::memory_order_relaxed);
+        allocationBytes.fetch_add(static_cast<qint64>(size), std::memory_order_relaxed);
+    }
+}
+
+qint64 AllocationCounter::count()
+{
+    return allocationCount.load(std::memory_order_relaxed);
+}
+
+qint64 AllocationCounter::bytes()
+{
+    return allocationBytes.load(std::memory_order_relaxed);
+}
+
+void AllocationCounter::setThreadEnabled(bool enabled)
+{
+    threadEnabled = enabled;
+}
+
+bool AllocationCounter::isThreadEnabled()
+{
+    return threadEnabled;
+}
+
+// 可执行文件中的定义优先于 libc，Qt 等共享库的分配也会经过这里；free 不需要替换
+extern "C" void *malloc(size_t size)
+{
+    countAllocation(size);
+    return __libc_malloc(size);
+}
+
+extern "C" void *calloc(size_t count, size_t size)
+{
+    countAllocation(count * size);
+    return __libc_calloc(count, size);
+}
+
+extern "C" void *realloc(void *pointer, size_t size)
+{
+    // 扩容也是一次分配；realloc(p, 0) 相当于释放，不计入
+    if (size > 0) {
+        countAllocation(size);
+    }
+    return __libc_realloc(pointer, size);
+}
\ No newline at end of file
@@ -0,0 +1,44 @@
+#ifndef ALLOCATIONCOUNTER_H
+#define ALLOCATIONCOUNTER_H
+
+#include <QtGlobal>
+
+// 堆分配计数
+// 链接了 allocationcounter.cpp 的程序会替换 malloc/calloc/realloc，统计启用计数的线程中的分配次数和字节数，
+// Qt 容器和 operator new 最终都经过这里，用来验证接收路径在稳态下不再分配内存。
+// 依赖 glibc 的 __libc_malloc 等入口，只链接进 Linux 上的基准测试程序，界面程序和命令行版本不受影响。
+// 线程默认计数；测试线程自身的分配可以用 setThreadEnabled(false) 或 Scope 排除。
+class AllocationCounter
+{
+public:
+    // 所有线程累计的分配次数和字节数
+    static qint64 count();
+    static qint64 bytes();
+    
+    // 只影响当前线程
+    static void setThreadEnabled(bool enabled);
+    static bool isThreadEnabled();
+    
+    // 在作用域内开启或关闭当前线程的计数，离开时恢复
+    class Scope
+    {
+    public:
+        explicit Scope(bool enabled)
+            : previous(isThreadEnabled())
+        {
+            setThreadEnabled(enabled);
+        }
+        ~Scope()
+        {
+            setThreadEnabled(previous);
+        }
+        
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+    
+    private:
+        bool previous;
+    };
+};
+
+#endif // ALLOCATIONCOUNTER_H
\ No newline at end of file
@@ -0,0 +1,464 @@
+#include "capturefile.h"
+#include "timestamp.h"
+#include <QThread>
+#include <algorithm>
+#include <cstring>
+
+static const char CAPTURE_MAGIC[8] = {'S', 'C', 'A', 'P', 'T', 'U', 'R', 'E'};
+static const char INDEX_MAGIC[8] = {'S', 'C', 'A', 'P', 'I', 'N', 'D', 'X'};
+static const quint32 CAPTURE_VERSION = 1;
+// 缓冲区积累到该大小时唤醒后台线程写盘
+static const qint64 WRITE_BUFFER_SIZE = 1024 * 1024;
+// 数据较少时最长的写盘间隔
+static const int FLUSH_INTERVAL_MS = 200;
+// 尚未写盘的数据上限，超过后丢弃新记录而不是阻塞I/O线程；两个缓冲区都按该大小预先分配，持锁时不会重新分配
+static const qint64 MAX_PENDING_BYTES = 8 * 1024 * 1024;
+// 端口记录不受上限限制（录制文件中必须有端口名称），为它们预留的余量
+static const qint64 PORT_RECORD_RESERVE = 64 * 1024;
+
+CaptureWriter::CaptureWriter()
+    : thread(nullptr)
+    , offset(0)
+    , nextIndexOffset(0)
+    , records(0)
+    , opened(false)
+    , stopping(false)
+    , failed(false)
+    , committed(0)
+    , dropped(0)
+{
+}
+
+CaptureWriter::~CaptureWriter()
+{
+    close();
+}
+
+bool CaptureWriter::open(const QString &fileName)
+{
+    close();
+    
+    file.setFileName(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        error = file.errorString();
+        return false;
+    }
+    
+    CaptureFileHeader header;
+    std::memcpy(header.magic, CAPTURE_MAGIC, sizeof(header.magic));
+    header.version = CAPTURE_VERSION;
+    header.headerSize = sizeof(CaptureFileHeader);
+    header.created = TimestampClock::now();
+    if (file.write(reinterpret_cast<const char *>(&header), sizeof(header)) != sizeof(header)) {
+        error = file.errorString();
+        file.close();
+        return false;
+    }
+    
+    // 两个缓冲区预先分配好，正常写入时只做拷贝
+    active.reserve(MAX_PENDING_BYTES + PORT_RECORD_RESERVE);
+    flushing.reserve(MAX_PENDING_BYTES + PORT_RECORD_RESERVE);
+    active.resize(0);
+    flushing.resize(0);
+    index.clear();
+    ports.clear();
+    offset = sizeof(header);
+    nextIndexOffset = offset;
+    records = 0;
+    stopping = false;
+    failed = false;
+    error.clear();
+    committed.store(offset);
+    dropped.store(0);
+    opened = true;
+    
+    thread = QThread::create([this]() { run(); });
+    thread->start();
+    return true;
+}
+
+void CaptureWriter::close()
+{
+    if (!thread) {
+        return;
+    }
+    
+    {
+        QMutexLocker locker(&mutex);
+        stopping = true;
+        wake.wakeOne();
+    }
+    thread->wait();
+    delete thread;
+    thread = nullptr;
+    
+    // 数据之后依次写入索引、端口表和文件尾，下次打开时不必扫描数据
+    if (!failed) {
+        CaptureFileFooter footer;
+        footer.indexOffset = offset;
+        footer.indexCount = index.size();
+        footer.recordCount = records;
+        footer.portOffset = offset + index.size() * static_cast<qint64>(sizeof(CaptureIndexEntry));
+        std::memcpy(footer.magic, INDEX_MAGIC, sizeof(footer.magic));
+        
+        QByteArray trailer;
+        trailer.append(reinterpret_cast<const char *>(index.constData()), index.size() * sizeof(CaptureIndexEntry));
+        for (const QString &port : ports) {
+            const QByteArray name = port.toUtf8();
+            const quint32 length = name.size();
+            trailer.append(reinterpret_cast<const char *>(&length), sizeof(length));
+            trailer.append(name);
+        }
+        trailer.append(reinterpret_cast<const char *>(&footer), sizeof(footer));
+        if (file.write(trailer) != trailer.size()) {
+            failed = true;
+            error = file.errorString();
+        } else {
+            committed.fetch_add(trailer.size(), std::memory_order_relaxed);
+        }
+    }
+    file.close();
+    
+    QMutexLocker locker(&mutex);
+    opened = false;
+    active = QByteArray();
+    flushing = QByteArray();
+}
+
+bool CaptureWriter::isOpen() const
+{
+    QMutexLocker locker(&mutex);
+    return opened;
+}
+
+QString CaptureWriter::fileName() const
+{
+    return file.fileName();
+}
+
+QString CaptureWriter::errorString() const
+{
+    QMutexLocker locker(&mutex);
+    return error;
+}
+
+quint16 CaptureWriter::addPort(const QString &name)
+{
+    QMutexLocker locker(&mutex);
+    const int existing = ports.indexOf(name);
+    if (existing >= 0) {
+        return static_cast<quint16>(existing);
+    }
+    
+    ports.append(name);
+    const quint16 port = static_cast<quint16>(ports.size() - 1);
+    if (opened && !stopping) {
+        const QByteArray utf8 = name.toUtf8();
+        appendRecord(TimestampClock::now(), CAPTURE_PORT_RECORD, port, utf8.constData(), utf8.size(), 0);
+    }
+    return port;
+}
+
+void CaptureWriter::write(qint64 timestamp, RecordDirection direction, quint16 port, const char *data, qint64 length, quint8 flags)
+{
+    QMutexLocker locker(&mutex);
+    if (!opened || stopping || length <= 0) {
+        return;
+    }
+    if (active.size() + static_cast<qint64>(sizeof(CaptureRecordHeader)) + length > MAX_PENDING_BYTES) {
+        dropped.fetch_add(length, std::memory_order_relaxed);
+        return;
+    }
+    
+    appendRecord(timestamp, static_cast<quint8>(direction), port, data, length, flags);
+    if (active.size() >= WRITE_BUFFER_SIZE) {
+        wake.wakeOne();
+    }
+}
+
+qint64 CaptureWriter::bytesWritten() const
+{
+    return committed.load(std::memory_order_relaxed);
+}
+
+qint64 CaptureWriter::droppedBytes() const
+{
+    return dropped.load(std::memory_order_relaxed);
+}
+
+void CaptureWriter::appendRecord(qint64 timestamp, quint8 direction, quint16 port, const char *data, qint64 length, quint8 flags)
+{
+    // 调用者已持有 mutex
+    if (direction != CAPTURE_PORT_RECORD) {
+        if (offset >= nextIndexOffset) {
+            CaptureIndexEntry entry;
+            entry.timestamp = timestamp;
+            entry.offset = offset;
+            entry.record = records;
+            index.append(entry);
+            nextIndexOffset = offset + CAPTURE_INDEX_INTERVAL;
+        }
+        ++records;
+    }
+    
+    CaptureRecordHeader header;
+    header.timestamp = timestamp;
+    header.length = static_cast<quint32>(length);
+    header.direction = direction;
+    header.flags = flags;
+    header.port = port;
+    active.append(reinterpret_cast<const char *>(&header), sizeof(header));
+    active.append(data, length);
+    offset += sizeof(header) + length;
+}
+
+void CaptureWriter::run()
+{
+    // 后台写盘线程：与I/O线程交换缓冲区后在锁外写文件
+    for (;;) {
+        QMutexLocker locker(&mutex);
+        if (!stopping && active.size() < WRITE_BUFFER_SIZE) {
+            wake.wait(&mutex, FLUSH_INTERVAL_MS);
+        }
+        const bool finish = stopping;
+        active.swap(flushing);
+        const bool skip = failed;
+        locker.unlock();
+        
+        if (!flushing.isEmpty() && !skip) {
+            if (file.write(flushing) != flushing.size() || !file.flush()) {
+                locker.relock();
+                failed = true;
+                error = file.errorString();
+                locker.unlock();
+            } else {
+                // 只统计确实写入文件的字节，写盘失败后不再增加
+                committed.fetch_add(flushing.size(), std::memory_order_relaxed);
+            }
+        }
+        flushing.resize(0);
+        
+        if (finish) {
+            break;
+        }
+    }
+}
+
+CaptureReader::CaptureReader()
+    : records(-1)
+    , begin(0)
+    , end(0)
+    , indexed(false)
+{
+}
+
+bool CaptureReader::open(const QString &fileName)
+{
+    close();
+    
+    file.setFileName(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        error = file.errorString();
+        return false;
+    }
+    
+    CaptureFileHeader header;
+    if (file.read(reinterpret_cast<char *>(&header), sizeof(header)) != sizeof(header)
+        || std::memcmp(header.magic, CAPTURE_MAGIC, sizeof(header.magic)) != 0
+        || header.version != CAPTURE_VERSION
+        || header.headerSize < sizeof(header)) {
+        error = "不是有效的录制文件";
+        file.close();
+        return false;
+    }
+    begin = header.headerSize;
+    end = file.size();
+    
+    // 正常关闭的文件：从文件尾读入索引和端口表
+    const qint64 size = file.size();
+    CaptureFileFooter footer;
+    if (size >= begin + static_cast<qint64>(sizeof(footer))
+        && file.seek(size - sizeof(footer))
+        && file.read(reinterpret_cast<char *>(&footer), sizeof(footer)) == sizeof(footer)
+        && std::memcmp(footer.magic, INDEX_MAGIC, sizeof(footer.magic)) == 0
+        && footer.indexOffset >= begin
+        && footer.indexCount >= 0
+        && footer.portOffset == footer.indexOffset + footer.indexCount * static_cast<qint64>(sizeof(CaptureIndexEntry))
+        && footer.portOffset <= size - static_cast<qint64>(sizeof(footer))) {
+        index.resize(footer.indexCount);
+        const qint64 indexBytes = footer.indexCount * sizeof(CaptureIndexEntry);
+        if (file.seek(footer.indexOffset)
+            && file.read(reinterpret_cast<char *>(index.data()), indexBytes) == indexBytes) {
+            const qint64 portEnd = size - sizeof(footer);
+            qint64 position = footer.portOffset;
+            bool portsValid = file.seek(position);
+            while (portsValid && position < portEnd) {
+                // 每一项的长度字段和名称都必须落在端口表范围内，越界说明文件已损坏
+                quint32 length = 0;
+                if (position + static_cast<qint64>(sizeof(length)) > portEnd
+                    || file.read(reinterpret_cast<char *>(&length), sizeof(length)) != sizeof(length)
+                    || position + static_cast<qint64>(sizeof(length)) + length > portEnd) {
+                    portsValid = false;
+                    break;
+                }
+                const QByteArray name = file.read(length);
+                if (name.size() != static_cast<qsizetype>(length)) {
+                    portsValid = false;
+                    break;
+                }
+                ports.append(QString::fromUtf8(name));
+                position += sizeof(length) + length;
+            }
+            if (!portsValid) {
+                error = "录制文件端口表已损坏";
+                close();
+                return false;
+            }
+            end = footer.indexOffset;
+            records = footer.recordCount;
+            indexed = true;
+        } else {
+            index.clear();
+        }
+    }
+    return true;
+}
+
+void CaptureReader::close()
+{
+    file.close();
+    index.clear();
+    ports.clear();
+    records = -1;
+    begin = 0;
+    end = 0;
+    indexed = false;
+}
+
+bool CaptureReader::isOpen() const
+{
+    return file.isOpen();
+}
+
+QString CaptureReader::errorString() const
+{
+    return error;
+}
+
+bool CaptureReader::hasIndex() const
+{
+    return indexed;
+}
+
+const QVector<CaptureIndexEntry> &CaptureReader::indexEntries() const
+{
+    return index;
+}
+
+qint64 CaptureReader::recordCount() const
+{
+    return records;
+}
+
+qint64 CaptureReader::dataBegin() const
+{
+    return begin;
+}
+
+qint64 CaptureReader::dataEnd() const
+{
+    return end;
+}
+
+QString CaptureReader::portName(quint16 port) const
+{
+    return ports.value(port);
+}
+
+QStringList CaptureReader::portNames() const
+{
+    return ports;
+}
+
+qint64 CaptureReader::seekTime(qint64 timestamp)
+{
+    // 从时间早于 timestamp 的最后一个索引点开始顺序查找
+    qint64 position = begin;
+    auto it = std::lower_bound(index.constBegin(), index.constEnd(), timestamp,
+                               [](const CaptureIndexEntry &entry, qint64 value) { return entry.timestamp < value; });
+    if (it != index.constBegin()) {
+        position = (it - 1)->offset;
+    }
+    
+    CaptureRecordHeader header;
+    while (readHeader(position, &header)) {
+        if (header.direction != CAPTURE_PORT_RECORD && header.timestamp >= timestamp) {
+            return position;
+        }
+        position += sizeof(header) + header.length;
+    }
+    return end;
+}
+
+qint64 CaptureReader::seekOffset(qint64 offset)
+{
+    qint64 position = begin;
+    auto it = std::upper_bound(index.constBegin(), index.constEnd(), offset,
+                               [](qint64 value, const CaptureIndexEntry &entry) { return value < entry.offset; });
+    if (it != index.constBegin()) {
+        position = (it - 1)->offset;
+    }
+    
+    CaptureRecordHeader header;
+    while (readHeader(position, &header)) {
+        if (header.direction != CAPTURE_PORT_RECORD && position >= offset) {
+            return position;
+        }
+        position += sizeof(header) + header.length;
+    }
+    return end;
+}
+
+bool CaptureReader::readRecord(qint64 offset, CaptureRecord *record, qint64 *next)
+{
+    CaptureRecordHeader header;
+    while (readHeader(offset, &header)) {
+        offset += sizeof(header) + header.length;
+        if (header.direction == CAPTURE_PORT_RECORD) {
+            // 没有端口表的文件在读到端口记录时登记名称
+            if (header.port >= ports.size()) {
+                while (ports.size() < header.port) {
+                    ports.append(QString());
+                }
+                ports.append(QString::fromUtf8(file.read(header.length)));
+            }
+            continue;
+        }
+        
+        record->timestamp = header.timestamp;
+        record->direction = static_cast<RecordDirection>(header.direction);
+        record->flags = header.flags;
+        record->port = header.port;
+        record->data = file.read(header.length);
+        if (record->data.size() != static_cast<qint64>(header.length)) {
+            return false;
+        }
+        if (next) {
+            *next = offset;
+        }
+        return true;
+    }
+    return false;
+}
+
+bool CaptureReader::readHeader(qint64 offset, CaptureRecordHeader *header)
+{
+    // 未正常关闭的文件末尾可能有写了一半的记录，超出数据区的记录视为结束
+    if (offset < begin || offset + static_cast<qint64>(sizeof(*header)) > end || !file.seek(offset)) {
+        return false;
+    }
+    if (file.read(reinterpret_cast<char *>(header), sizeof(*header)) != sizeof(*header)) {
+        return false;
+    }
+    return offset + static_cast<qint64>(sizeof(*header)) + header->length <= end;
+}
\ No newline at end of file
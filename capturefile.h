@@ -0,0 +1,170 @@
+#ifndef CAPTUREFILE_H
+#define CAPTUREFILE_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QWaitCondition>
+#include <atomic>
+
+#include "recordsource.h"
+
+class QThread;
+
+// 录制文件格式（小端）：
+//   文件头 CaptureFileHeader
+//   记录   CaptureRecordHeader + 数据，依次追加
+//   索引   CaptureIndexEntry 数组（正常关闭时写入）
+//   端口表 每个端口名称为 quint32 长度 + UTF-8 字节
+//   文件尾 CaptureFileFooter
+// 端口名称也作为记录写入（direction 为 CAPTURE_PORT_RECORD），记录头中的 port 为其序号。
+// 未正常关闭的文件没有索引和文件尾，读取时从头扫描记录。
+
+struct CaptureFileHeader
+{
+    char magic[8];          // "SCAPTURE"
+    quint32 version;
+    quint32 headerSize;
+    qint64 created;         // 开始录制的时刻，自1970-01-01 UTC起的纳秒数
+};
+static_assert(sizeof(CaptureFileHeader) == 24, "CaptureFileHeader must stay 24 bytes");
+
+struct CaptureRecordHeader
+{
+    qint64 timestamp;
+    quint32 length;
+    quint8 direction;       // RecordDirection 或 CAPTURE_PORT_RECORD
+    quint8 flags;           // RecordFlag
+    quint16 port;
+};
+static_assert(sizeof(CaptureRecordHeader) == 16, "CaptureRecordHeader must stay 16 bytes");
+
+// 稀疏索引：数据每增长约 CAPTURE_INDEX_INTERVAL 字节记录一个记录起点
+struct CaptureIndexEntry
+{
+    qint64 timestamp;
+    qint64 offset;          // 记录头在文件中的偏移
+    qint64 record;          // 记录序号（不含端口记录）
+};
+static_assert(sizeof(CaptureIndexEntry) == 24, "CaptureIndexEntry must stay 24 bytes");
+
+struct CaptureFileFooter
+{
+    qint64 indexOffset;
+    qint64 indexCount;
+    qint64 recordCount;
+    qint64 portOffset;      // 端口表在文件中的偏移
+    char magic[8];          // "SCAPINDX"
+};
+static_assert(sizeof(CaptureFileFooter) == 40, "CaptureFileFooter must stay 40 bytes");
+
+static const quint8 CAPTURE_PORT_RECORD = 0xFF;
+static const qint64 CAPTURE_INDEX_INTERVAL = 1024 * 1024;
+
+// 从录制文件读出的一条记录
+struct CaptureRecord
+{
+    qint64 timestamp = 0;
+    RecordDirection direction = RecordDirection::Rx;
+    quint8 flags = 0;
+    quint16 port = 0;
+    QByteArray data;
+};
+
+// 录制文件写入器
+// write 只把记录拷贝进内存缓冲区，由后台线程批量写盘，I/O线程不会因磁盘慢而阻塞。
+// 写盘跟不上导致积压超过上限时，新记录被丢弃并计入 droppedBytes。
+// write/addPort 可以在任意一个线程中调用；open/close 由拥有者调用，close 前应确保不再有写入。
+class CaptureWriter
+{
+public:
+    CaptureWriter();
+    ~CaptureWriter();
+    
+    CaptureWriter(const CaptureWriter &) = delete;
+    CaptureWriter &operator=(const CaptureWriter &) = delete;
+    
+    bool open(const QString &fileName);
+    // 写出剩余数据、索引和文件尾后关闭
+    void close();
+    bool isOpen() const;
+    QString fileName() const;
+    QString errorString() const;
+    
+    // 登记端口名称，返回记录中使用的端口序号；同名端口只登记一次
+    quint16 addPort(const QString &name);
+    void write(qint64 timestamp, RecordDirection direction, quint16 port, const char *data, qint64 length, quint8 flags = 0);
+    
+    // 已写入文件的字节数（含文件头、记录头和关闭时写入的索引），以及因积压被丢弃的数据字节数
+    qint64 bytesWritten() const;
+    qint64 droppedBytes() const;
+
+private:
+    void appendRecord(qint64 timestamp, quint8 direction, quint16 port, const char *data, qint64 length, quint8 flags);
+    void run();
+    
+    QFile file;
+    QThread *thread;
+    mutable QMutex mutex;
+    QWaitCondition wake;
+    QByteArray active;          // I/O线程写入的缓冲区
+    QByteArray flushing;        // 后台线程正在写盘的缓冲区，与 active 交换使用
+    QVector<CaptureIndexEntry> index;
+    QStringList ports;
+    qint64 offset;              // 下一条记录在文件中的偏移
+    qint64 nextIndexOffset;
+    qint64 records;
+    bool opened;
+    bool stopping;
+    bool failed;
+    QString error;
+    std::atomic<qint64> committed;
+    std::atomic<qint64> dropped;
+};
+
+// 录制文件读取器
+// 正常关闭的文件直接读入文件尾的稀疏索引，打开时不扫描数据；按时间或偏移定位时
+// 先在索引中二分查找，再从最近的索引点向后顺序读取。
+class CaptureReader
+{
+public:
+    CaptureReader();
+    
+    bool open(const QString &fileName);
+    void close();
+    bool isOpen() const;
+    QString errorString() const;
+    
+    // 文件是否带有索引（未正常关闭的录制没有）
+    bool hasIndex() const;
+    const QVector<CaptureIndexEntry> &indexEntries() const;
+    qint64 recordCount() const;
+    qint64 dataBegin() const;
+    qint64 dataEnd() const;
+    QString portName(quint16 port) const;
+    QStringList portNames() const;
+    
+    // 第一条时间不早于 timestamp 的记录的偏移，没有时返回 dataEnd()
+    qint64 seekTime(qint64 timestamp);
+    // 位于 offset 处或其后的第一条记录的偏移
+    qint64 seekOffset(qint64 offset);
+    // 读取 offset 处的记录，next 返回下一条记录的偏移；端口记录被跳过
+    bool readRecord(qint64 offset, CaptureRecord *record, qint64 *next);
+
+private:
+    bool readHeader(qint64 offset, CaptureRecordHeader *header);
+    
+    QFile file;
+    QString error;
+    QVector<CaptureIndexEntry> index;
+    QStringList ports;
+    qint64 records;             // 没有索引时为 -1
+    qint64 begin;
+    qint64 end;
+    bool indexed;
+};
+
+#endif // CAPTUREFILE_H
\ No newline at end of file
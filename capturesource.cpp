@@ -0,0 +1,344 @@
+#include "capturesource.h"
+#include "capturefile.h"
+#include <QThread>
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+
+// 每段的记录数
+static const qint64 SEGMENT_RECORDS = 65536;
+// 扫描线程每积累这么多条记录就公布一次，显示控件随后可以看到
+static const qint64 PUBLISH_RECORDS = 4096;
+// 时间分桶的初始宽度和桶数上限；桶数超过上限时桶宽加倍、相邻两桶合并
+static const qint64 INITIAL_BUCKET_WIDTH = 1000 * 1000;
+static const size_t MAX_TIME_BUCKETS = 1 << 20;
+
+struct CaptureSource::Segment
+{
+    qint64 offsets[SEGMENT_RECORDS];    // 记录头在文件中的偏移
+    quint32 info[SEGMENT_RECORDS];      // 换行数 | TX_FLAG
+};
+
+CaptureSource::CaptureSource()
+    : data(nullptr)
+    , begin(0)
+    , end(0)
+    , indexer(nullptr)
+    , cancel(false)
+    , indexing(false)
+    , published(0)
+    , scanned(0)
+    , firstTime(0)
+    , bucketWidth(INITIAL_BUCKET_WIDTH)
+    , timeIndexReady(false)
+{
+}
+
+CaptureSource::~CaptureSource()
+{
+    close();
+}
+
+bool CaptureSource::open(const QString &fileName)
+{
+    close();
+    
+    // 文件头、数据区范围和端口表的解析与 CaptureReader 共用
+    CaptureReader reader;
+    if (!reader.open(fileName)) {
+        error = reader.errorString();
+        return false;
+    }
+    begin = reader.dataBegin();
+    end = reader.dataEnd();
+    ports = reader.portNames();
+    reader.close();
+    
+    file.setFileName(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        error = file.errorString();
+        return false;
+    }
+    data = file.map(0, file.size());
+    if (!data) {
+        error = file.errorString();
+        file.close();
+        return false;
+    }
+    
+    // 每条记录至少有一个记录头，按此估算段数的上限
+    const qint64 maxRecords = (end - begin) / static_cast<qint64>(sizeof(CaptureRecordHeader)) + 1;
+    segments.assign(static_cast<size_t>(maxRecords / SEGMENT_RECORDS + 1), nullptr);
+    published.store(0);
+    scanned.store(begin);
+    cancel.store(false);
+    indexing.store(true);
+    
+    indexer = QThread::create([this]() { buildIndex(); });
+    indexer->start();
+    return true;
+}
+
+void CaptureSource::close()
+{
+    if (indexer) {
+        cancel.store(true);
+        indexer->wait();
+        delete indexer;
+        indexer = nullptr;
+    }
+    for (Segment *segment : segments) {
+        delete segment;
+    }
+    segments.clear();
+    timeBuckets.clear();
+    timeIndexReady.store(false);
+    indexing.store(false);
+    published.store(0);
+    ports.clear();
+    if (data) {
+        file.unmap(const_cast<uchar *>(data));
+        data = nullptr;
+    }
+    file.close();
+    begin = 0;
+    end = 0;
+}
+
+bool CaptureSource::isOpen() const
+{
+    return data != nullptr;
+}
+
+QString CaptureSource::fileName() const
+{
+    return file.fileName();
+}
+
+QString CaptureSource::errorString() const
+{
+    return error;
+}
+
+QString CaptureSource::portName(quint16 port) const
+{
+    return ports.value(port);
+}
+
+QStringList CaptureSource::portNames() const
+{
+    return ports;
+}
+
+quint16 CaptureSource::recordPort(qint64 index) const
+{
+    if (index < 0 || index >= recordCount()) {
+        return 0;
+    }
+    quint16 port = 0;
+    std::memcpy(&port, data + offsetOf(index) + offsetof(CaptureRecordHeader, port), sizeof(port));
+    return port;
+}
+
+const char *CaptureSource::recordData(qint64 index) const
+{
+    if (index < 0 || index >= recordCount()) {
+        return nullptr;
+    }
+    return reinterpret_cast<const char *>(data) + offsetOf(index) + sizeof(CaptureRecordHeader);
+}
+
+quint8 CaptureSource::recordFlags(qint64 index) const
+{
+    if (index < 0 || index >= recordCount()) {
+        return 0;
+    }
+    return data[offsetOf(index) + offsetof(CaptureRecordHeader, flags)];
+}
+
+bool CaptureSource::isIndexing() const
+{
+    return indexing.load(std::memory_order_acquire);
+}
+
+qint64 CaptureSource::indexedBytes() const
+{
+    return scanned.load(std::memory_order_relaxed) - begin;
+}
+
+qint64 CaptureSource::dataBytes() const
+{
+    return end - begin;
+}
+
+qint64 CaptureSource::recordCount() const
+{
+    return published.load(std::memory_order_acquire);
+}
+
+qint64 CaptureSource::recordLength(qint64 index) const
+{
+    if (index < 0 || index >= recordCount()) {
+        return 0;
+    }
+    quint32 length = 0;
+    std::memcpy(&length, data + offsetOf(index) + offsetof(CaptureRecordHeader, length), sizeof(length));
+    return length;
+}
+
+int CaptureSource::lineBreaks(qint64 index) const
+{
+    if (index < 0 || index >= recordCount()) {
+        return 0;
+    }
+    return static_cast<int>(infoOf(index) & ~TX_FLAG);
+}
+
+RecordDirection CaptureSource::direction(qint64 index) const
+{
+    if (index < 0 || index >= recordCount()) {
+        return RecordDirection::Rx;
+    }
+    return (infoOf(index) & TX_FLAG) ? RecordDirection::Tx : RecordDirection::Rx;
+}
+
+qint64 CaptureSource::timestamp(qint64 index) const
+{
+    if (index < 0 || index >= recordCount()) {
+        return 0;
+    }
+    qint64 value = 0;
+    std::memcpy(&value, data + offsetOf(index) + offsetof(CaptureRecordHeader, timestamp), sizeof(value));
+    return value;
+}
+
+Record CaptureSource::record(qint64 index) const
+{
+    Record result;
+    if (index < 0 || index >= recordCount()) {
+        return result;
+    }
+    
+    CaptureRecordHeader header;
+    const qint64 offset = offsetOf(index);
+    std::memcpy(&header, data + offset, sizeof(header));
+    result.timestamp = header.timestamp;
+    result.direction = static_cast<RecordDirection>(header.direction);
+    result.flags = header.flags;
+    result.data = QByteArray(reinterpret_cast<const char *>(data) + offset + sizeof(header), header.length);
+    return result;
+}
+
+qint64 CaptureSource::findRecord(qint64 timestamp) const
+{
+    if (!timeIndexReady.load(std::memory_order_acquire)) {
+        // 索引尚未建完，在已索引的部分中二分查找
+        return RecordSource::findRecord(timestamp);
+    }
+    
+    // 直接算出目标时间所在的桶，只在桶内的记录中查找
+    const qint64 count = recordCount();
+    if (timeBuckets.empty() || timestamp <= firstTime) {
+        return 0;
+    }
+    const qint64 bucket = (timestamp - firstTime) / bucketWidth;
+    qint64 low = count;
+    qint64 high = count;
+    if (bucket < static_cast<qint64>(timeBuckets.size())) {
+        low = timeBuckets[static_cast<size_t>(bucket)];
+        high = bucket + 1 < static_cast<qint64>(timeBuckets.size()) ? timeBuckets[static_cast<size_t>(bucket + 1)] : count;
+    } else {
+        low = timeBuckets.back();
+    }
+    while (low < high) {
+        const qint64 middle = low + (high - low) / 2;
+        if (this->timestamp(middle) < timestamp) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+QString CaptureSource::recordLabel(qint64 index) const
+{
+    if (ports.size() < 2 || index < 0 || index >= recordCount()) {
+        return QString();
+    }
+    return ports.value(recordPort(index));
+}
+
+void CaptureSource::buildIndex()
+{
+    // 顺序扫描记录头：只有换行数需要读数据，其余信息都来自记录头
+    qint64 offset = begin;
+    qint64 count = 0;
+    Segment *segment = nullptr;
+    while (offset + static_cast<qint64>(sizeof(CaptureRecordHeader)) <= end
+           && !cancel.load(std::memory_order_relaxed)) {
+        CaptureRecordHeader header;
+        std::memcpy(&header, data + offset, sizeof(header));
+        const qint64 next = offset + sizeof(header) + header.length;
+        if (next > end) {
+            // 未正常关闭的文件末尾写了一半的记录
+            break;
+        }
+        
+        if (header.direction != CAPTURE_PORT_RECORD) {
+            const qint64 slot = count % SEGMENT_RECORDS;
+            if (slot == 0) {
+                segment = new Segment;
+                segments[static_cast<size_t>(count / SEGMENT_RECORDS)] = segment;
+            }
+            const quint32 breaks = countLineBreaks(reinterpret_cast<const char *>(data) + offset + sizeof(header), header.length);
+            segment->offsets[slot] = offset;
+            segment->info[slot] = (breaks & ~TX_FLAG)
+                | (header.direction == static_cast<quint8>(RecordDirection::Tx) ? TX_FLAG : 0);
+            addTimeBucket(count, header.timestamp);
+            ++count;
+            if (count % PUBLISH_RECORDS == 0) {
+                published.store(count, std::memory_order_release);
+            }
+        }
+        offset = next;
+        scanned.store(offset, std::memory_order_relaxed);
+    }
+    
+    published.store(count, std::memory_order_release);
+    if (!cancel.load(std::memory_order_relaxed)) {
+        timeIndexReady.store(true, std::memory_order_release);
+    }
+    indexing.store(false, std::memory_order_release);
+}
+
+void CaptureSource::addTimeBucket(qint64 record, qint64 timestamp)
+{
+    if (timeBuckets.empty()) {
+        firstTime = timestamp;
+        bucketWidth = INITIAL_BUCKET_WIDTH;
+    }
+    // 时间倒退的记录归入当前最后一个桶
+    qint64 bucket = qMax<qint64>(0, (timestamp - firstTime) / bucketWidth);
+    while (bucket >= static_cast<qint64>(MAX_TIME_BUCKETS)) {
+        for (size_t i = 0; 2 * i < timeBuckets.size(); ++i) {
+            timeBuckets[i] = timeBuckets[2 * i];
+        }
+        timeBuckets.resize((timeBuckets.size() + 1) / 2);
+        bucketWidth *= 2;
+        bucket = (timestamp - firstTime) / bucketWidth;
+    }
+    while (static_cast<qint64>(timeBuckets.size()) <= bucket) {
+        timeBuckets.push_back(record);
+    }
+}
+
+qint64 CaptureSource::offsetOf(qint64 index) const
+{
+    return segments[static_cast<size_t>(index / SEGMENT_RECORDS)]->offsets[index % SEGMENT_RECORDS];
+}
+
+quint32 CaptureSource::infoOf(qint64 index) const
+{
+    return segments[static_cast<size_t>(index / SEGMENT_RECORDS)]->info[index % SEGMENT_RECORDS];
+}
\ No newline at end of file
@@ -0,0 +1,84 @@
+#ifndef CAPTURESOURCE_H
+#define CAPTURESOURCE_H
+
+#include <QFile>
+#include <QString>
+#include <QStringList>
+#include <atomic>
+#include <vector>
+
+#include "recordsource.h"
+
+class QThread;
+
+// 打开的录制文件
+// 整个文件以内存映射方式打开，不读入内存；后台线程顺序扫描记录头建立记录索引，
+// 已扫描的部分随时可以显示，记录数随扫描进度增长。显示控件只为可见的记录从映射中取数据。
+// 扫描时同时建立按时间分桶的索引，扫描完成后按时间定位记录只需查一次桶，再在桶内二分查找。
+class CaptureSource : public RecordSource
+{
+public:
+    CaptureSource();
+    ~CaptureSource() override;
+    
+    CaptureSource(const CaptureSource &) = delete;
+    CaptureSource &operator=(const CaptureSource &) = delete;
+    
+    bool open(const QString &fileName);
+    void close();
+    bool isOpen() const;
+    QString fileName() const;
+    QString errorString() const;
+    QString portName(quint16 port) const;
+    QStringList portNames() const;
+    // 记录所属端口的编号，对应 portName
+    quint16 recordPort(qint64 index) const;
+    // 记录数据在映射中的地址，不拷贝；长度为 recordLength
+    const char *recordData(qint64 index) const;
+    // 记录标志位（RecordFlag），直接读映射中的记录头
+    quint8 recordFlags(qint64 index) const;
+    
+    // 后台索引进度
+    bool isIndexing() const;
+    qint64 indexedBytes() const;
+    qint64 dataBytes() const;
+    
+    qint64 recordCount() const override;
+    qint64 recordLength(qint64 index) const override;
+    int lineBreaks(qint64 index) const override;
+    RecordDirection direction(qint64 index) const override;
+    qint64 timestamp(qint64 index) const override;
+    Record record(qint64 index) const override;
+    qint64 findRecord(qint64 timestamp) const override;
+    // 录制了多个端口时返回记录所属的端口名
+    QString recordLabel(qint64 index) const override;
+
+private:
+    // 记录索引按段分配，段地址表在打开时一次分配好，扫描线程追加段时不会移动已有数据
+    struct Segment;
+    
+    void buildIndex();
+    void addTimeBucket(qint64 record, qint64 timestamp);
+    qint64 offsetOf(qint64 index) const;
+    quint32 infoOf(qint64 index) const;
+    
+    QFile file;
+    QString error;
+    QStringList ports;
+    const uchar *data;          // 映射的文件内容
+    qint64 begin;
+    qint64 end;
+    std::vector<Segment *> segments;
+    QThread *indexer;
+    std::atomic<bool> cancel;
+    std::atomic<bool> indexing;
+    std::atomic<qint64> published;      // 已建立索引、可以访问的记录数
+    std::atomic<qint64> scanned;        // 已扫描到的文件偏移
+    // 时间分桶：timeBuckets[i] 为第一条时间不早于 firstTime + i * bucketWidth 的记录
+    std::vector<qint64> timeBuckets;
+    qint64 firstTime;
+    qint64 bucketWidth;
+    std::atomic<bool> timeIndexReady;
+};
+
+#endif // CAPTURESOURCE_H
\ No newline at end of file
@@ -0,0 +1,320 @@
+#include "checksum.h"
+#include <QtEndian>
+#include <array>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(_M_AMD64)
+#define CHECKSUM_HAVE_SSE42 1
+#include <nmmintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define CHECKSUM_TARGET_SSE42
+#else
+#define CHECKSUM_TARGET_SSE42 __attribute__((target("sse4.2")))
+#endif
+#elif defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+#define CHECKSUM_HAVE_ARM_CRC32 1
+#include <arm_acle.h>
+#endif
+
+// slice-by-8 查找表：第 k 张表是单个字节后面再跟 k 个 0 字节时对 CRC 的贡献
+using CrcTable = std::array<std::array<quint32, 256>, 8>;
+
+// 反射（低位先行）CRC，polynomial 为反转后的多项式
+static constexpr CrcTable reflectedTable(quint32 polynomial)
+{
+    CrcTable table{};
+    for (quint32 i = 0; i < 256; ++i) {
+        quint32 crc = i;
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc >> 1) ^ ((crc & 1) ? polynomial : 0);
+        }
+        table[0][i] = crc;
+    }
+    for (int k = 1; k < 8; ++k) {
+        for (int i = 0; i < 256; ++i) {
+            table[k][i] = (table[k - 1][i] >> 8) ^ table[0][table[k - 1][i] & 0xFF];
+        }
+    }
+    return table;
+}
+
+// 高位先行的 16 位 CRC
+static constexpr CrcTable normalTable16(quint32 polynomial)
+{
+    CrcTable table{};
+    for (quint32 i = 0; i < 256; ++i) {
+        quint32 crc = i << 8;
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = ((crc & 0x8000) ? ((crc << 1) ^ polynomial) : (crc << 1)) & 0xFFFF;
+        }
+        table[0][i] = crc;
+    }
+    for (int k = 1; k < 8; ++k) {
+        for (int i = 0; i < 256; ++i) {
+            table[k][i] = ((table[k - 1][i] << 8) & 0xFFFF) ^ table[0][table[k - 1][i] >> 8];
+        }
+    }
+    return table;
+}
+
+static constexpr CrcTable CRC16_MODBUS_TABLE = reflectedTable(0xA001);
+static constexpr CrcTable CRC16_CCITT_TABLE = normalTable16(0x1021);
+static constexpr CrcTable CRC32_TABLE = reflectedTable(0xEDB88320);
+static constexpr CrcTable CRC32C_TABLE = reflectedTable(0x82F63B78);
+
+// 反射 CRC 的宽度不超过 32 位时，前 4 个字节与寄存器异或后查表，寄存器的高位为 0 不影响结果
+static quint32 updateReflected(const CrcTable &t, quint32 crc, const uchar *p, qint64 length)
+{
+    while (length >= 8) {
+        const quint32 one = qFromLittleEndian<quint32>(p) ^ crc;
+        const quint32 two = qFromLittleEndian<quint32>(p + 4);
+        crc = t[7][one & 0xFF] ^ t[6][(one >> 8) & 0xFF] ^ t[5][(one >> 16) & 0xFF] ^ t[4][one >> 24]
+            ^ t[3][two & 0xFF] ^ t[2][(two >> 8) & 0xFF] ^ t[1][(two >> 16) & 0xFF] ^ t[0][two >> 24];
+        p += 8;
+        length -= 8;
+    }
+    while (length-- > 0) {
+        crc = (crc >> 8) ^ t[0][(crc ^ *p++) & 0xFF];
+    }
+    return crc;
+}
+
+static quint32 updateNormal16(const CrcTable &t, quint32 crc, const uchar *p, qint64 length)
+{
+    while (length >= 8) {
+        crc = t[7][((crc >> 8) ^ p[0]) & 0xFF] ^ t[6][(crc ^ p[1]) & 0xFF] ^ t[5][p[2]] ^ t[4][p[3]]
+            ^ t[3][p[4]] ^ t[2][p[5]] ^ t[1][p[6]] ^ t[0][p[7]];
+        p += 8;
+        length -= 8;
+    }
+    while (length-- > 0) {
+        crc = ((crc << 8) & 0xFFFF) ^ t[0][((crc >> 8) ^ *p++) & 0xFF];
+    }
+    return crc;
+}
+
+#ifdef CHECKSUM_HAVE_SSE42
+CHECKSUM_TARGET_SSE42 static quint32 updateCrc32cSse42(quint32 crc, const uchar *p, qint64 length)
+{
+    quint64 value = crc;
+    while (length >= 8) {
+        quint64 word;
+        std::memcpy(&word, p, sizeof(word));
+        value = _mm_crc32_u64(value, word);
+        p += 8;
+        length -= 8;
+    }
+    crc = static_cast<quint32>(value);
+    while (length-- > 0) {
+        crc = _mm_crc32_u8(crc, *p++);
+    }
+    return crc;
+}
+
+static bool detectSse42()
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 1);
+    return (info[2] & (1 << 20)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("sse4.2");
+#endif
+}
+
+static bool hasSse42()
+{
+    static const bool supported = detectSse42();
+    return supported;
+}
+#endif
+
+#ifdef CHECKSUM_HAVE_ARM_CRC32
+static quint32 updateCrc32cArm(quint32 crc, const uchar *p, qint64 length)
+{
+    while (length >= 8) {
+        quint64 word;
+        std::memcpy(&word, p, sizeof(word));
+        crc = __crc32cd(crc, word);
+        p += 8;
+        length -= 8;
+    }
+    while (length-- > 0) {
+        crc = __crc32cb(crc, *p++);
+    }
+    return crc;
+}
+#endif
+
+static quint32 updateCrc32c(quint32 crc, const uchar *p, qint64 length)
+{
+#if defined(CHECKSUM_HAVE_SSE42)
+    if (hasSse42()) {
+        return updateCrc32cSse42(crc, p, length);
+    }
+#elif defined(CHECKSUM_HAVE_ARM_CRC32)
+    return updateCrc32cArm(crc, p, length);
+#endif
+    return updateReflected(CRC32C_TABLE, crc, p, length);
+}
+
+static quint32 sum8(const uchar *p, qint64 length)
+{
+    // 每次取 8 个字节，奇偶字节分别加到 4 个 16 位通道里。每次每个通道最多加 2*255，
+    // 128 次后不超过 65280，在通道进位到相邻通道之前先把各通道累加到 sum 中
+    const quint64 mask = 0x00FF00FF00FF00FFULL;
+    const quint64 laneMask = 0x0000FFFF0000FFFFULL;
+    quint32 sum = 0;
+    while (length >= 8) {
+        quint64 lanes = 0;
+        for (int i = 0; i < 128 && length >= 8; ++i) {
+            quint64 word;
+            std::memcpy(&word, p, sizeof(word));
+            lanes += (word & mask) + ((word >> 8) & mask);
+            p += 8;
+            length -= 8;
+        }
+        lanes = (lanes & laneMask) + ((lanes >> 16) & laneMask);
+        sum += static_cast<quint32>(lanes + (lanes >> 32));
+    }
+    while (length-- > 0) {
+        sum += *p++;
+    }
+    return sum & 0xFF;
+}
+
+static quint32 xor8(const uchar *p, qint64 length)
+{
+    quint64 word = 0;
+    while (length >= 8) {
+        quint64 value;
+        std::memcpy(&value, p, sizeof(value));
+        word ^= value;
+        p += 8;
+        length -= 8;
+    }
+    quint32 result = static_cast<quint32>(word ^ (word >> 32));
+    result ^= result >> 16;
+    result ^= result >> 8;
+    while (length-- > 0) {
+        result ^= *p++;
+    }
+    return result & 0xFF;
+}
+
+Checksum::Checksum(Type type, bool bigEndian)
+    : checksumType(type)
+    , checksumBigEndian(bigEndian)
+{
+}
+
+Checksum::Type Checksum::type() const
+{
+    return checksumType;
+}
+
+bool Checksum::bigEndian() const
+{
+    return checksumBigEndian;
+}
+
+int Checksum::size() const
+{
+    return size(checksumType);
+}
+
+void Checksum::append(QByteArray *data) const
+{
+    const int n = size();
+    if (n == 0) {
+        return;
+    }
+    const quint32 value = compute(data->constData(), data->size());
+    for (int i = 0; i < n; ++i) {
+        const int shift = 8 * (checksumBigEndian ? n - 1 - i : i);
+        data->append(static_cast<char>((value >> shift) & 0xFF));
+    }
+}
+
+bool Checksum::verify(const char *data, qint64 length) const
+{
+    const int n = size();
+    if (n == 0) {
+        return true;
+    }
+    if (length < n) {
+        return false;
+    }
+    const qint64 payload = length - n;
+    const uchar *stored = reinterpret_cast<const uchar *>(data) + payload;
+    quint32 expected = 0;
+    for (int i = 0; i < n; ++i) {
+        const int shift = 8 * (checksumBigEndian ? n - 1 - i : i);
+        expected |= static_cast<quint32>(stored[i]) << shift;
+    }
+    return compute(data, payload) == expected;
+}
+
+quint32 Checksum::compute(Type type, const char *data, qint64 length)
+{
+    const uchar *p = reinterpret_cast<const uchar *>(data);
+    switch (type) {
+    case Sum8:
+        return sum8(p, length);
+    case Xor8:
+        return xor8(p, length);
+    case Crc16Modbus:
+        return updateReflected(CRC16_MODBUS_TABLE, 0xFFFF, p, length);
+    case Crc16Ccitt:
+        return updateNormal16(CRC16_CCITT_TABLE, 0xFFFF, p, length);
+    case Crc16Xmodem:
+        return updateNormal16(CRC16_CCITT_TABLE, 0, p, length);
+    case Crc32:
+        return ~updateReflected(CRC32_TABLE, 0xFFFFFFFF, p, length);
+    case Crc32c:
+        return ~updateCrc32c(0xFFFFFFFF, p, length);
+    default:
+        return 0;
+    }
+}
+
+int Checksum::size(Type type)
+{
+    switch (type) {
+    case Sum8:
+    case Xor8:
+        return 1;
+    case Crc16Modbus:
+    case Crc16Ccitt:
+    case Crc16Xmodem:
+        return 2;
+    case Crc32:
+    case Crc32c:
+        return 4;
+    default:
+        return 0;
+    }
+}
+
+bool Checksum::defaultBigEndian(Type type)
+{
+    return type != Crc16Modbus && type != Crc32 && type != Crc32c;
+}
+
+QStringList Checksum::names()
+{
+    return {"无", "SUM8", "XOR8", "CRC16/MODBUS", "CRC16/CCITT-FALSE", "CRC16/XMODEM", "CRC32", "CRC32C"};
+}
+
+const char *Checksum::crc32cBackend()
+{
+#if defined(CHECKSUM_HAVE_SSE42)
+    return hasSse42() ? "SSE4.2" : "slice-by-8";
+#elif defined(CHECKSUM_HAVE_ARM_CRC32)
+    return "ARMv8";
+#else
+    return "slice-by-8";
+#endif
+}
\ No newline at end of file
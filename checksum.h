@@ -0,0 +1,68 @@
+#ifndef CHECKSUM_H
+#define CHECKSUM_H
+
+#include <QByteArray>
+#include <QStringList>
+
+// 帧校验：累加和、异或和以及常用的 CRC
+// CRC 用 slice-by-8 查找表每次处理 8 个字节，查找表在编译期生成；
+// CRC32C 在支持 SSE4.2（x86-64）或 ARMv8 CRC 扩展的CPU上改用硬件指令。
+// 发送时把校验值追加到数据末尾，接收时按帧校验末尾的校验值。
+class Checksum
+{
+public:
+    // 顺序与界面下拉框和 names() 一致，并保存在配置文件中
+    enum Type
+    {
+        None,
+        Sum8,           // 字节累加和，取低 8 位
+        Xor8,           // 字节异或
+        Crc16Modbus,    // CRC-16/MODBUS：多项式 0x8005 反射，初值 0xFFFF
+        Crc16Ccitt,     // CRC-16/CCITT-FALSE：多项式 0x1021，初值 0xFFFF
+        Crc16Xmodem,    // CRC-16/XMODEM：多项式 0x1021，初值 0
+        Crc32,          // CRC-32（以太网、zip）
+        Crc32c          // CRC-32C（Castagnoli）
+    };
+    static const int TYPE_COUNT = 8;
+    
+    explicit Checksum(Type type = None, bool bigEndian = false);
+    
+    Type type() const;
+    // 校验值按高字节在前追加和比较，单字节校验不区分
+    bool bigEndian() const;
+    // 校验值字节数，None 为 0
+    int size() const;
+    
+    quint32 compute(const char *data, qint64 length) const
+    {
+        return compute(checksumType, data, length);
+    }
+    // 在 data 末尾追加校验值
+    void append(QByteArray *data) const;
+    // data 的最后 size() 个字节为校验值，校验其余字节；None 总是通过，数据不足时失败
+    bool verify(const char *data, qint64 length) const;
+    
+    bool operator==(const Checksum &other) const
+    {
+        return checksumType == other.checksumType && checksumBigEndian == other.checksumBigEndian;
+    }
+    bool operator!=(const Checksum &other) const
+    {
+        return !(*this == other);
+    }
+    
+    static quint32 compute(Type type, const char *data, qint64 length);
+    static int size(Type type);
+    // 惯用的字节序：反射 CRC（如 Modbus RTU）低字节在前，其余高字节在前
+    static bool defaultBigEndian(Type type);
+    // 界面上显示的名称
+    static QStringList names();
+    // 当前CPU上 CRC32C 实际使用的计算路径："SSE4.2"、"ARMv8" 或 "slice-by-8"
+    static const char *crc32cBackend();
+
+private:
+    Type checksumType;
+    bool checksumBigEndian;
+};
+
+#endif // CHECKSUM_H
\ No newline at end of file
@@ -0,0 +1,303 @@
+#include "chunkstore.h"
+#include <QDir>
+#include <QTemporaryFile>
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+
+// 数据块大小，超过该大小的单条记录独占一个块
+static const qint64 BLOCK_SIZE = 256 * 1024;
+// 从磁盘读回的数据块最多缓存的块数
+static const int LOADED_BLOCK_CACHE = 8;
+// 留作复用的空闲块数：清空或写入临时文件后的块缓冲区不释放，稳态下追加记录不再分配内存
+static const int SPARE_BLOCKS = 2;
+
+// 块内每条记录数据前的记录头
+struct RecordHeader
+{
+    qint64 timestamp;
+    quint32 length;
+    quint8 direction;
+    quint8 flags;
+    quint16 reserved;
+};
+static_assert(sizeof(RecordHeader) == 16, "RecordHeader must stay 16 bytes");
+
+ChunkStore::ChunkStore(qint64 memoryBudget)
+    : budget(memoryBudget)
+    , records(0)
+    , bytes(0)
+    , resident(0)
+    , spilled(0)
+    , firstResidentBlock(0)
+    , lastBlock(0)
+    , spillFile(nullptr)
+    , loadedBlocks(LOADED_BLOCK_CACHE)
+{
+    spareBlocks.reserve(SPARE_BLOCKS);
+}
+
+ChunkStore::~ChunkStore()
+{
+    delete spillFile;
+}
+
+void ChunkStore::setMemoryBudget(qint64 value)
+{
+    budget = qMax<qint64>(BLOCK_SIZE, value);
+    enforceBudget();
+}
+
+qint64 ChunkStore::memoryBudget() const
+{
+    return budget;
+}
+
+qint64 ChunkStore::append(qint64 timestamp, RecordDirection direction, const char *data, qint64 length, quint8 flags)
+{
+    const qint64 recordSize = static_cast<qint64>(sizeof(RecordHeader)) + length;
+    if (blocks.empty() || (blocks.back().size > 0 && blocks.back().size + recordSize > BLOCK_SIZE)) {
+        if (!blocks.empty()) {
+            sealCurrentBlock();
+        }
+        startBlock(recordSize);
+    }
+    
+    RecordHeader header;
+    header.timestamp = timestamp;
+    header.length = static_cast<quint32>(length);
+    header.direction = static_cast<quint8>(direction);
+    header.flags = flags;
+    header.reserved = 0;
+    
+    quint32 info = countLineBreaks(data, length) & ~TX_FLAG;
+    if (direction == RecordDirection::Tx) {
+        info |= TX_FLAG;
+    }
+    
+    Block &block = blocks.back();
+    block.offsets.append(static_cast<quint32>(block.size));
+    block.info.append(info);
+    block.data.append(reinterpret_cast<const char *>(&header), sizeof(header));
+    block.data.append(data, length);
+    block.size += recordSize;
+    
+    bytes += recordSize;
+    resident += recordSize;
+    return records++;
+}
+
+void ChunkStore::clear()
+{
+    for (int i = firstResidentBlock; i < static_cast<int>(blocks.size()); ++i) {
+        recycleBlock(std::move(blocks[i]));
+    }
+    blocks.clear();
+    records = 0;
+    bytes = 0;
+    resident = 0;
+    spilled = 0;
+    firstResidentBlock = 0;
+    lastBlock = 0;
+    loadedBlocks.clear();
+    delete spillFile;
+    spillFile = nullptr;
+}
+
+qint64 ChunkStore::recordCount() const
+{
+    return records;
+}
+
+qint64 ChunkStore::totalBytes() const
+{
+    return bytes;
+}
+
+qint64 ChunkStore::residentBytes() const
+{
+    return resident;
+}
+
+qint64 ChunkStore::spilledBytes() const
+{
+    return spilled;
+}
+
+qint64 ChunkStore::recordLength(qint64 index) const
+{
+    const Block &block = blocks[findBlock(index)];
+    const int local = static_cast<int>(index - block.firstRecord);
+    const qint64 end = local + 1 < block.offsets.size() ? block.offsets[local + 1] : block.size;
+    return end - block.offsets[local] - static_cast<qint64>(sizeof(RecordHeader));
+}
+
+int ChunkStore::lineBreaks(qint64 index) const
+{
+    const Block &block = blocks[findBlock(index)];
+    return static_cast<int>(block.info[static_cast<int>(index - block.firstRecord)] & ~TX_FLAG);
+}
+
+RecordDirection ChunkStore::direction(qint64 index) const
+{
+    const Block &block = blocks[findBlock(index)];
+    return (block.info[static_cast<int>(index - block.firstRecord)] & TX_FLAG) ? RecordDirection::Tx : RecordDirection::Rx;
+}
+
+qint64 ChunkStore::timestamp(qint64 index) const
+{
+    if (index < 0 || index >= records) {
+        return 0;
+    }
+    
+    const int blockIndex = findBlock(index);
+    const Block &block = blocks[blockIndex];
+    const qint64 start = block.offsets[static_cast<int>(index - block.firstRecord)];
+    const QByteArray data = blockData(blockIndex);
+    if (data.size() < start + static_cast<qint64>(sizeof(RecordHeader))) {
+        return 0;
+    }
+    
+    qint64 value = 0;
+    std::memcpy(&value, data.constData() + start + offsetof(RecordHeader, timestamp), sizeof(value));
+    return value;
+}
+
+Record ChunkStore::record(qint64 index) const
+{
+    Record result;
+    if (index < 0 || index >= records) {
+        return result;
+    }
+    
+    const int blockIndex = findBlock(index);
+    const Block &block = blocks[blockIndex];
+    const int local = static_cast<int>(index - block.firstRecord);
+    const qint64 start = block.offsets[local];
+    const QByteArray data = blockData(blockIndex);
+    if (data.size() < start + static_cast<qint64>(sizeof(RecordHeader))) {
+        return result;
+    }
+    
+    RecordHeader header;
+    std::memcpy(&header, data.constData() + start, sizeof(header));
+    result.timestamp = header.timestamp;
+    result.direction = static_cast<RecordDirection>(header.direction);
+    result.flags = header.flags;
+    result.data = data.mid(start + static_cast<qint64>(sizeof(header)), header.length);
+    return result;
+}
+
+int ChunkStore::findBlock(qint64 index) const
+{
+    // 显示控件通常按顺序访问记录，先检查上一次命中的块及其后一块
+    const int count = static_cast<int>(blocks.size());
+    for (int candidate = lastBlock; candidate < count && candidate <= lastBlock + 1; ++candidate) {
+        const Block &block = blocks[candidate];
+        if (index >= block.firstRecord && index < block.firstRecord + block.offsets.size()) {
+            lastBlock = candidate;
+            return candidate;
+        }
+    }
+    
+    // 二分查找第一条记录序号不大于 index 的最后一个块
+    auto it = std::upper_bound(blocks.begin(), blocks.end(), index,
+                               [](qint64 value, const Block &block) { return value < block.firstRecord; });
+    lastBlock = qMax(0, static_cast<int>(it - blocks.begin()) - 1);
+    return lastBlock;
+}
+
+QByteArray ChunkStore::blockData(int blockIndex) const
+{
+    const Block &block = blocks[blockIndex];
+    if (block.fileOffset < 0) {
+        return block.data;
+    }
+    
+    if (QByteArray *cached = loadedBlocks.object(blockIndex)) {
+        return *cached;
+    }
+    
+    QByteArray data;
+    if (spillFile && spillFile->seek(block.fileOffset)) {
+        data = spillFile->read(block.size);
+    }
+    loadedBlocks.insert(blockIndex, new QByteArray(data));
+    return data;
+}
+
+void ChunkStore::startBlock(qint64 recordSize)
+{
+    // 优先复用空闲块；索引按上一块的记录数预留，块内追加记录时一般不再扩容
+    const int expected = blocks.empty() ? 0 : static_cast<int>(blocks.back().offsets.size());
+    Block block;
+    if (!spareBlocks.empty() && recordSize <= BLOCK_SIZE) {
+        block = std::move(spareBlocks.back());
+        spareBlocks.pop_back();
+    }
+    block.firstRecord = records;
+    block.size = 0;
+    block.fileOffset = -1;
+    block.data.reserve(qMax(BLOCK_SIZE, recordSize));
+    block.offsets.reserve(expected);
+    block.info.reserve(expected);
+    blocks.push_back(std::move(block));
+}
+
+void ChunkStore::recycleBlock(Block &&block)
+{
+    // 只回收普通大小、没有被读取方共享的缓冲区；清空内容但保留容量
+    const qint64 capacity = block.data.capacity();
+    if (static_cast<int>(spareBlocks.size()) >= SPARE_BLOCKS || !block.data.isDetached()
+        || capacity < BLOCK_SIZE || capacity > 2 * BLOCK_SIZE) {
+        return;
+    }
+    block.data.resize(0);
+    block.offsets.clear();
+    block.info.clear();
+    spareBlocks.push_back(std::move(block));
+}
+
+void ChunkStore::sealCurrentBlock()
+{
+    // 数据缓冲区不再收缩，写入临时文件后可以整块复用
+    enforceBudget();
+}
+
+void ChunkStore::enforceBudget()
+{
+    // 当前正在写入的块始终留在内存中
+    while (resident > budget && firstResidentBlock + 1 < static_cast<int>(blocks.size())) {
+        if (!spillBlock(blocks[firstResidentBlock])) {
+            break;
+        }
+        ++firstResidentBlock;
+    }
+}
+
+bool ChunkStore::spillBlock(Block &block)
+{
+    if (!spillFile) {
+        spillFile = new QTemporaryFile(QDir::tempPath() + "/serialtool_XXXXXX.spill");
+        if (!spillFile->open()) {
+            delete spillFile;
+            spillFile = nullptr;
+            return false;
+        }
+    }
+    
+    const qint64 offset = spillFile->size();
+    if (!spillFile->seek(offset) || spillFile->write(block.data) != block.size) {
+        return false;
+    }
+    
+    block.fileOffset = offset;
+    // 索引留在原块中，只回收数据缓冲区
+    Block spare;
+    spare.data = std::move(block.data);
+    recycleBlock(std::move(spare));
+    block.data = QByteArray();
+    resident -= block.size;
+    spilled += block.size;
+    return true;
+}
\ No newline at end of file
@@ -0,0 +1,85 @@
+#ifndef CHUNKSTORE_H
+#define CHUNKSTORE_H
+
+#include <QByteArray>
+#include <QCache>
+#include <QVector>
+#include <vector>
+
+#include "recordsource.h"
+
+class QTemporaryFile;
+
+// 接收区数据的分块存储
+// 保存原始字节而不是格式化后的文本，十六进制/编码/时间戳等显示方式改变时可以重新渲染历史数据。
+// 记录按顺序追加到固定大小的数据块中，内存中数据块总量超过预算时，
+// 最早的数据块整块写入临时文件并释放内存，需要显示时再按块读回（带少量缓存）。
+// 每条记录在内存中只保留块内偏移和换行数/方向两个整数，便于显示控件快速定位行。
+// 清空或写入临时文件后的块缓冲区留作复用，持续接收时追加记录不会反复分配和释放大块内存。
+class ChunkStore : public RecordSource
+{
+public:
+    explicit ChunkStore(qint64 memoryBudget = 256 * 1024 * 1024);
+    ~ChunkStore() override;
+    
+    ChunkStore(const ChunkStore &) = delete;
+    ChunkStore &operator=(const ChunkStore &) = delete;
+    
+    void setMemoryBudget(qint64 bytes);
+    qint64 memoryBudget() const;
+    
+    // 追加一条记录，返回记录序号
+    qint64 append(qint64 timestamp, RecordDirection direction, const char *data, qint64 length, quint8 flags = 0);
+    qint64 append(qint64 timestamp, RecordDirection direction, const QByteArray &data, quint8 flags = 0)
+    {
+        return append(timestamp, direction, data.constData(), data.size(), flags);
+    }
+    void clear();
+    
+    qint64 recordCount() const override;
+    qint64 totalBytes() const;
+    qint64 residentBytes() const;
+    qint64 spilledBytes() const;
+    
+    qint64 recordLength(qint64 index) const override;
+    int lineBreaks(qint64 index) const override;
+    // 记录方向，只访问内存中的索引，不会读盘
+    RecordDirection direction(qint64 index) const override;
+    // 记录时间戳，只读取记录头
+    qint64 timestamp(qint64 index) const override;
+    // 读取完整记录，记录所在块已写入磁盘时会从临时文件读回
+    Record record(qint64 index) const override;
+
+private:
+    struct Block
+    {
+        qint64 firstRecord = 0;
+        qint64 size = 0;             // 块内数据字节数
+        qint64 fileOffset = -1;      // 已写入临时文件时在文件中的偏移
+        QByteArray data;             // 驻留内存时的数据
+        QVector<quint32> offsets;    // 每条记录（含记录头）在块内的起始偏移
+        QVector<quint32> info;       // 每条记录的换行数，最高位为方向（1表示发送）
+    };
+    
+    int findBlock(qint64 index) const;
+    QByteArray blockData(int blockIndex) const;
+    void startBlock(qint64 recordSize);
+    void recycleBlock(Block &&block);
+    void sealCurrentBlock();
+    void enforceBudget();
+    bool spillBlock(Block &block);
+    
+    std::vector<Block> blocks;
+    std::vector<Block> spareBlocks;   // 回收的空闲块，保留缓冲区容量
+    qint64 budget;
+    qint64 records;
+    qint64 bytes;
+    qint64 resident;
+    qint64 spilled;
+    int firstResidentBlock;           // 之前的块都已写入磁盘
+    mutable int lastBlock;            // 最近一次查找命中的块，顺序访问时免去二分查找
+    QTemporaryFile *spillFile;
+    mutable QCache<int, QByteArray> loadedBlocks;   // 从磁盘读回的块
+};
+
+#endif // CHUNKSTORE_H
\ No newline at end of file
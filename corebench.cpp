@@ -0,0 +1,807 @@
+// corebench.cpp - 数据处理代码的自检和微基准测试
+// 只链接 SerialToolCore 静态库，不创建任何窗口：先逐项检查十六进制格式化/解析、编解码、分帧、帧校验、触发匹配、遥测解析、波形抽取和录制文件的结果，
+// 全部通过后再对每个热点函数计时。循环次数自动增加到单项运行时间不少于 --min-time，
+// 每项输出一行 JSON（名称、数据长度、循环次数、每次耗时、吞吐量），便于在不同版本之间比较。
+
+#include "capturefile.h"
+#include "checksum.h"
+#include "framer.h"
+#include "hexformatter.h"
+#include "hexparser.h"
+#include "plotseries.h"
+#include "sessioncodec.h"
+#include "telemetryparser.h"
+#include "timestamp.h"
+#include "triggermatcher.h"
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QRandomGenerator>
+#include <QRegularExpression>
+#include <QTemporaryDir>
+#include <QtCore5Compat/QTextCodec>
+#include <algorithm>
+#include <cstdio>
+#include <functional>
+#include <vector>
+
+// 防止编译器把被测函数的结果当作无用代码删掉
+static volatile qint64 sink = 0;
+
+static int failures = 0;
+
+#define CHECK(condition) \
+    do { \
+        if (!(condition)) { \
+            std::fprintf(stderr, "%s:%d: 检查失败：%s\n", __FILE__, __LINE__, #condition); \
+            ++failures; \
+        } \
+    } while (0)
+
+static QByteArray randomBytes(qint64 length, quint32 seed)
+{
+    QRandomGenerator generator(seed);
+    QByteArray data(length, Qt::Uninitialized);
+    for (qint64 i = 0; i < length; ++i) {
+        data[i] = static_cast<char>(generator.bounded(256));
+    }
+    return data;
+}
+
+// 一行文本，每行以 \r\n 结尾，用于分隔符分帧
+static QByteArray textLines(qint64 length)
+{
+    QByteArray data;
+    data.reserve(length);
+    int line = 0;
+    while (data.size() < length) {
+        data += "temperature=" + QByteArray::number(20 + line % 10) + ".5,humidity=" + QByteArray::number(line % 100) + "\r\n";
+        ++line;
+    }
+    data.truncate(length);
+    return data;
+}
+
+static QByteArray encodeCobs(const QByteArray &data)
+{
+    QByteArray out;
+    out.reserve(data.size() + data.size() / 254 + 2);
+    qsizetype codeIndex = out.size();
+    out.append('\0');
+    uchar code = 1;
+    for (char c : data) {
+        if (c == 0) {
+            out[codeIndex] = static_cast<char>(code);
+            codeIndex = out.size();
+            out.append('\0');
+            code = 1;
+            continue;
+        }
+        out.append(c);
+        if (++code == 0xFF) {
+            out[codeIndex] = static_cast<char>(code);
+            codeIndex = out.size();
+            out.append('\0');
+            code = 1;
+        }
+    }
+    out[codeIndex] = static_cast<char>(code);
+    out.append('\0');
+    return out;
+}
+
+static QByteArray encodeSlip(const QByteArray &data)
+{
+    QByteArray out;
+    out.reserve(data.size() * 2 + 1);
+    for (char c : data) {
+        if (c == static_cast<char>(0xC0)) {
+            out.append("\xDB\xDC", 2);
+        } else if (c == static_cast<char>(0xDB)) {
+            out.append("\xDB\xDD", 2);
+        } else {
+            out.append(c);
+        }
+    }
+    out.append(static_cast<char>(0xC0));
+    return out;
+}
+
+// 把数据分成若干块输入分帧器，收集所有帧
+static QVector<QByteArray> frameAll(const FramingConfig &config, const QByteArray &data, qint64 blockSize, int *errors = nullptr)
+{
+    QVector<QByteArray> frames;
+    Framer framer;
+    framer.setConfig(config);
+    framer.setFrameHandler([&frames, errors](const char *frame, qint64 length, qint64, bool error) {
+        frames.append(QByteArray(frame, length));
+        if (errors && error) {
+            ++*errors;
+        }
+    });
+    for (qint64 offset = 0; offset < data.size(); offset += blockSize) {
+        framer.feed(data.constData() + offset, qMin(blockSize, data.size() - offset), 0);
+    }
+    return frames;
+}
+
+static void checkHexFormatter()
+{
+    const QByteArray data("\x01\xAB\x7F\x00", 4);
+    HexFormatOptions options;
+    CHECK(HexFormatter(options).format(data) == "01 AB 7F 00");
+    options.upperCase = false;
+    options.groupSize = 2;
+    options.separator = QLatin1Char('-');
+    CHECK(HexFormatter(options).format(data) == "01ab-7f00");
+    options = HexFormatOptions();
+    options.bytesPerLine = 2;
+    CHECK(HexFormatter(options).formatLines(data) == QStringList({"01 AB", "7F 00"}));
+    CHECK(HexFormatter(options).lineCount(5) == 3);
+    
+    // SIMD 路径与 QByteArray::toHex 结果一致，覆盖各种长度的尾部
+    for (qint64 length : {0, 1, 15, 16, 17, 31, 32, 33, 1000}) {
+        const QByteArray bytes = randomBytes(length, static_cast<quint32>(length + 1));
+        QString out(length * 2, Qt::Uninitialized);
+        HexFormatter::toHex(reinterpret_cast<const uchar *>(bytes.constData()), length, reinterpret_cast<char16_t *>(out.data()), false);
+        CHECK(out == QString::fromLatin1(bytes.toHex()));
+    }
+}
+
+static void checkHexParser()
+{
+    QByteArray out;
+    CHECK(HexParser::parse(QString("AA BB cc"), &out) && out == "\xAA\xBB\xCC");
+    out.clear();
+    CHECK(HexParser::parse(QString("0xAA,0xBB;0x01"), &out) && out == QByteArray("\xAA\xBB\x01"));
+    out.clear();
+    CHECK(HexParser::parse(QString("\\xAA\\xBB"), &out) && out == "\xAA\xBB");
+    out.clear();
+    CHECK(HexParser::parse(QString("A"), &out) && out == "\x0A");
+    out.clear();
+    qsizetype errorOffset = -1;
+    CHECK(!HexParser::parse(QString("AA BBC"), &out, &errorOffset) && errorOffset >= 3);
+    out.clear();
+    CHECK(!HexParser::parse(QString("AA GG"), &out, &errorOffset) && errorOffset == 3);
+    
+    // 格式化后再解析得到原数据
+    const QByteArray bytes = randomBytes(4096, 7);
+    out.clear();
+    CHECK(HexParser::parse(HexFormatter().format(bytes), &out) && out == bytes);
+    
+    // 分隔符和触发规则使用的转义
+    CHECK(HexParser::parseEscaped(QString("\\r\\n"), &out) && out == "\r\n");
+    CHECK(HexParser::parseEscaped(QString("a\\x00\\tb\\\\"), &out) && out == QByteArray("a\0\tb\\", 5));
+    CHECK(HexParser::parseEscaped(QString(), &out) && out.isEmpty());
+    CHECK(!HexParser::parseEscaped(QString("\\xG1"), &out));
+    CHECK(!HexParser::parseEscaped(QString("abc\\"), &out));
+}
+
+static void checkSessionCodec()
+{
+    // UTF-8 多字节字符被数据块切开时仍能正确拼接
+    const QByteArray text = QString("温度 25℃").toUtf8();
+    SessionCodec utf8("UTF-8");
+    CHECK(utf8.isMultiByte());
+    CHECK(utf8.decode(text.left(4)) + utf8.decode(text.mid(4)) == QString("温度 25℃"));
+    CHECK(utf8.completeLength(text.constData(), 4) == 3);
+    CHECK(utf8.encode(QString("温度")) == QString("温度").toUtf8());
+    
+    SessionCodec gbk("GBK");
+    const QByteArray encoded = gbk.encode(QString("中文"));
+    CHECK(encoded == QByteArray("\xD6\xD0\xCE\xC4"));
+    CHECK(gbk.completeLength(encoded.constData(), 3) == 2);
+    CHECK(gbk.decode(encoded.left(3)) + gbk.decode(encoded.mid(3)) == QString("中文"));
+    
+    SessionCodec latin1("ISO-8859-1");
+    CHECK(!latin1.isMultiByte());
+    CHECK(latin1.toUnicode(QByteArray("\xE9")) == QString(QChar(0xE9)));
+    
+    // 换行数与解码后拆出的行数一致：UTF-16 中 0x0A 字节可能属于其他字符
+    CHECK(utf8.hasByteNewline() && utf8.countLineBreaks(QByteArray("a\r\nb\n")) == 1);
+    SessionCodec utf16("UTF-16LE");
+    CHECK(!utf16.hasByteNewline());
+    CHECK(utf16.countLineBreaks(QByteArray("A\0\n\0", 4)) == 0);
+    CHECK(utf16.countLineBreaks(QByteArray("A\0\n\0B\0", 6)) == 1);
+    CHECK(utf16.countLineBreaks(QByteArray("\x41\x0A\x0A\x00\x42\x00", 6)) == 1);
+    
+    // UTF-16 代理对被数据块切开时，高代理项留到下一块
+    const QByteArray emoji("A\0\x3D\xD8\x00\xDE", 6);
+    CHECK(utf16.completeLength(emoji.constData(), 6) == 6);
+    CHECK(utf16.completeLength(emoji.constData(), 5) == 2 && utf16.completeLength(emoji.constData(), 4) == 2);
+    CHECK(utf16.toUnicode(emoji) == QString::fromUtf8("A\xF0\x9F\x98\x80"));
+    
+    // ASCII 不能把 0x80 以上的字符编码成 Latin-1 字节，解码时 0x80 以上的字节显示为替换字符；没有该编码的平台上按 UTF-8 处理，不检查
+    if (QTextCodec::codecForName("US-ASCII")) {
+        SessionCodec ascii("US-ASCII");
+        CHECK(ascii.encode(QString("ok")) == "ok");
+        CHECK(ascii.encode(QString::fromUtf8("a\xC3\xA9\xF0\x9F\x98\x80b")) == "a??b");
+        CHECK(ascii.toUnicode(QByteArray("a\xE9")) == QString("a") + QChar(QChar::ReplacementCharacter));
+    }
+}
+
+static void checkFramer()
+{
+    // 分隔符跨数据块
+    FramingConfig config;
+    config.mode = FramingConfig::Delimiter;
+    QVector<QByteArray> frames = frameAll(config, "ab\r\ncd\r\n", 3);
+    CHECK(frames == QVector<QByteArray>({"ab\r\n", "cd\r\n"}));
+    config.keepDelimiter = false;
+    frames = frameAll(config, "ab\r\ncd\r\n", 1);
+    CHECK(frames == QVector<QByteArray>({"ab", "cd"}));
+    
+    config = FramingConfig();
+    config.mode = FramingConfig::FixedLength;
+    config.fixedLength = 3;
+    frames = frameAll(config, "abcdefg", 2);
+    CHECK(frames == QVector<QByteArray>({"abc", "def"}));
+    
+    // 长度字段：1字节，值为其后数据长度
+    int errors = 0;
+    config = FramingConfig();
+    config.mode = FramingConfig::LengthPrefixed;
+    frames = frameAll(config, QByteArray("\x02xy\x01z", 5), 1);
+    CHECK(frames == QVector<QByteArray>({QByteArray("\x02xy"), QByteArray("\x01z")}));
+    // 长度字段不合理时只跳过一个字节：帧头中其余字节可能是下一帧的开头
+    config.lengthOffset = 1;
+    config.maxFrameLength = 8;
+    for (qint64 blockSize : {1, 16}) {
+        errors = 0;
+        frames = frameAll(config, QByteArray("GS\x02xy", 5), blockSize, &errors);
+        CHECK(frames == QVector<QByteArray>({QByteArray("G"), QByteArray("S\x02xy")}) && errors == 1);
+    }
+    
+    // SLIP/COBS 分帧同时解码
+    const QByteArray payload("\x11\xC0\x00\xDB\x22", 5);
+    config = FramingConfig();
+    config.mode = FramingConfig::Slip;
+    frames = frameAll(config, encodeSlip(payload) + encodeSlip("x"), 2);
+    CHECK(frames == QVector<QByteArray>({payload, "x"}));
+    config.mode = FramingConfig::Cobs;
+    CHECK(encodeCobs(QByteArray("\x11\x22\x00\x33", 4)) == QByteArray("\x03\x11\x22\x02\x33\x00", 6));
+    errors = 0;
+    frames = frameAll(config, encodeCobs(payload), 4, &errors);
+    CHECK(frames == QVector<QByteArray>({payload}) && errors == 0);
+    
+    // 超过最大帧长的帧被截断并标记错误
+    config = FramingConfig();
+    config.mode = FramingConfig::Delimiter;
+    config.maxFrameLength = 4;
+    errors = 0;
+    frames = frameAll(config, "abcdefgh\r\n", 16, &errors);
+    CHECK(!frames.isEmpty() && frames.first().size() == 4 && errors > 0);
+}
+
+// 逐位计算的反射 CRC，作为查找表和硬件指令结果的参照
+static quint32 bitwiseReflectedCrc(quint32 polynomial, quint32 crc, const QByteArray &data)
+{
+    for (const char c : data) {
+        crc ^= static_cast<uchar>(c);
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc >> 1) ^ ((crc & 1) ? polynomial : 0);
+        }
+    }
+    return crc;
+}
+
+static void checkChecksum()
+{
+    // 各算法的标准校验值
+    const QByteArray digits("123456789");
+    CHECK(Checksum::compute(Checksum::Sum8, digits.constData(), digits.size()) == 0xDD);
+    CHECK(Checksum::compute(Checksum::Xor8, digits.constData(), digits.size()) == 0x31);
+    CHECK(Checksum::compute(Checksum::Crc16Modbus, digits.constData(), digits.size()) == 0x4B37);
+    CHECK(Checksum::compute(Checksum::Crc16Ccitt, digits.constData(), digits.size()) == 0x29B1);
+    CHECK(Checksum::compute(Checksum::Crc16Xmodem, digits.constData(), digits.size()) == 0x31C3);
+    CHECK(Checksum::compute(Checksum::Crc32, digits.constData(), digits.size()) == 0xCBF43926);
+    CHECK(Checksum::compute(Checksum::Crc32c, digits.constData(), digits.size()) == 0xE3069283);
+    
+    // Modbus RTU 的 CRC 低字节在前
+    QByteArray request("\x01\x03\x00\x00\x00\x0A", 6);
+    Checksum(Checksum::Crc16Modbus, false).append(&request);
+    CHECK(request == QByteArray("\x01\x03\x00\x00\x00\x0A\xC5\xCD", 8));
+    
+    // slice-by-8 和硬件指令在各种长度和起始位置下与逐位计算一致
+    bool consistent = true;
+    for (qint64 length : {0, 1, 7, 8, 9, 15, 16, 17, 63, 64, 65, 1000}) {
+        const QByteArray data = randomBytes(length + 3, static_cast<quint32>(length + 11)).mid(length % 3, length);
+        consistent = consistent
+            && Checksum::compute(Checksum::Crc32, data.constData(), data.size()) == ~bitwiseReflectedCrc(0xEDB88320, 0xFFFFFFFF, data)
+            && Checksum::compute(Checksum::Crc32c, data.constData(), data.size()) == ~bitwiseReflectedCrc(0x82F63B78, 0xFFFFFFFF, data)
+            && Checksum::compute(Checksum::Crc16Modbus, data.constData(), data.size()) == bitwiseReflectedCrc(0xA001, 0xFFFF, data);
+    }
+    CHECK(consistent);
+    
+    // 按字处理的 Sum8 在长数据（全 0xFF 时通道增长最快）上与逐字节求和一致
+    bool sumConsistent = true;
+    for (qint64 length : {1024, 4096, 65536}) {
+        for (const QByteArray &data : {QByteArray(length, '\xFF'), randomBytes(length, static_cast<quint32>(length))}) {
+            quint32 expected = 0;
+            for (char byte : data) {
+                expected += static_cast<uchar>(byte);
+            }
+            sumConsistent = sumConsistent && Checksum::compute(Checksum::Sum8, data.constData(), data.size()) == (expected & 0xFF);
+        }
+    }
+    CHECK(sumConsistent);
+    
+    // 追加后能通过校验，改动任意一个字节后不能通过
+    bool roundTrip = true;
+    const QByteArray payload = randomBytes(100, 3);
+    for (int type = Checksum::Sum8; type < Checksum::TYPE_COUNT; ++type) {
+        for (bool bigEndian : {false, true}) {
+            const Checksum checksum(static_cast<Checksum::Type>(type), bigEndian);
+            QByteArray frame = payload;
+            checksum.append(&frame);
+            roundTrip = roundTrip && frame.size() == payload.size() + checksum.size() && checksum.verify(frame.constData(), frame.size());
+            frame[10] = static_cast<char>(frame.at(10) ^ 0x01);
+            roundTrip = roundTrip && !checksum.verify(frame.constData(), frame.size());
+        }
+    }
+    CHECK(roundTrip);
+    CHECK(!Checksum(Checksum::Crc32).verify("abc", 3));
+    CHECK(Checksum().verify("abc", 3));
+}
+
+static void checkTriggerMatcher()
+{
+    // 与逐位置比较的结果一致：模式互相重叠、互为前缀，数据按不同块大小切开送入
+    const QVector<QByteArray> patterns = {"he", "she", "his", "hers", "\x01\x02", "\x02\x01\x02", "hhh"};
+    QByteArray data = randomBytes(20000, 9);
+    for (int i = 0; i < data.size(); ++i) {
+        data[i] = "hers\x01\x02 i"[static_cast<uchar>(data.at(i)) % 8];
+    }
+    QVector<QPair<int, qint64>> expected;
+    for (qint64 end = 1; end <= data.size(); ++end) {
+        for (int p = 0; p < patterns.size(); ++p) {
+            const qint64 size = patterns.at(p).size();
+            if (end >= size && data.mid(end - size, size) == patterns.at(p)) {
+                expected.append({p, end});
+            }
+        }
+    }
+    bool consistent = !expected.isEmpty();
+    for (qint64 blockSize : {1, 3, 64, 20000}) {
+        TriggerMatcher matcher;
+        matcher.setPatterns(patterns);
+        QVector<QPair<int, qint64>> found;
+        matcher.setMatchHandler([&found](int pattern, qint64 end) { found.append({pattern, end}); });
+        for (qint64 offset = 0; offset < data.size(); offset += blockSize) {
+            matcher.feed(data.constData() + offset, qMin(blockSize, data.size() - offset));
+        }
+        std::sort(found.begin(), found.end(), [](const QPair<int, qint64> &a, const QPair<int, qint64> &b) {
+            return a.second != b.second ? a.second < b.second : a.first < b.first;
+        });
+        consistent = consistent && found == expected && matcher.position() == data.size();
+    }
+    CHECK(consistent);
+    
+    // 所有模式首字节相同时走 memchr 路径；reset 丢弃部分匹配
+    TriggerMatcher matcher;
+    matcher.setPatterns({"login:", "logout"});
+    int matches = 0;
+    matcher.setMatchHandler([&matches](int, qint64) { ++matches; });
+    matcher.feed("xxlog", 5);
+    matcher.feed("in: logout", 10);
+    CHECK(matches == 2);
+    matcher.feed("lo", 2);
+    matcher.reset();
+    matcher.feed("gout", 4);
+    CHECK(matches == 2 && matcher.position() == 4);
+    
+    // 规则文本
+    TriggerRule rule;
+    CHECK(rule.parse(" login: => send:root\\r ") && rule.pattern == "login:" && rule.action == TriggerRule::Send
+          && rule.payload == "root\r");
+    CHECK(rule.parse("\\x02ERR => mark") && rule.pattern == "\x02" "ERR" && rule.action == TriggerRule::Marker
+          && rule.markerText() == "\x02" "ERR");
+    CHECK(rule.parse("PANIC=>STOP") && rule.action == TriggerRule::StopRecord);
+    CHECK(!rule.parse("login: send:root"));
+    CHECK(!rule.parse(" => mark"));
+    CHECK(!rule.parse("ok => send"));
+    CHECK(!rule.parse("ok => reboot"));
+    QVector<TriggerRule> rules;
+    QString errorString;
+    CHECK(TriggerRule::parseList("# 注释\n\nboot => record\r\nOK => pause\n", &rules) && rules.size() == 2
+          && rules.at(1).action == TriggerRule::PauseDisplay);
+    CHECK(!TriggerRule::parseList("a => mark\nb =>\n", &rules, &errorString) && errorString.startsWith("第 2 行"));
+}
+
+static void checkTimestamp()
+{
+    // 与 QDateTime 的格式化结果一致，跨整点时重新计算前缀
+    TimestampFormatter formatter(TimestampFormatter::Milliseconds);
+    const qint64 base = QDateTime(QDate(2024, 5, 1), QTime(10, 59, 59, 999)).toMSecsSinceEpoch();
+    for (qint64 ms : {base, base + 1, base + 3600 * 1000}) {
+        const QString expected = QDateTime::fromMSecsSinceEpoch(ms).toString("[yyyy-MM-dd HH:mm:ss.zzz] ");
+        CHECK(formatter.format(ms * 1000 * 1000) == expected);
+    }
+}
+
+static void checkTelemetryParser()
+{
+    struct Sample
+    {
+        int channel;
+        qint64 line;
+        double value;
+        bool operator==(const Sample &other) const
+        {
+            return channel == other.channel && line == other.line && value == other.value;
+        }
+    };
+    TelemetryParser parser;
+    QVector<Sample> samples;
+    parser.setSampleHandler([&samples](int channel, qint64 line, double value) {
+        samples.append({channel, line, value});
+    });
+    
+    // 逐字节输入，结果与整块输入相同；按列、按名字编号，单位和非数值字段被忽略
+    const QByteArray text = "1.5,-2e3;0.25\r\nT=25.5C H:40\n\nid 7\n";
+    for (char c : text) {
+        parser.feed(&c, 1);
+    }
+    CHECK(samples == QVector<Sample>({{0, 0, 1.5}, {1, 0, -2000}, {2, 0, 0.25}, {3, 1, 25.5}, {4, 1, 40}, {1, 2, 7}}));
+    CHECK(parser.channelCount() == 5 && parser.channelName(0) == "1" && parser.channelName(3) == "T");
+    CHECK(parser.lineCount() == 3);
+    
+    // 超长的行整行丢弃，下一行照常解析
+    samples.clear();
+    parser.feed(QByteArray(TelemetryParser::MAX_LINE + 10, '1').constData(), TelemetryParser::MAX_LINE + 10);
+    parser.feed("\n9\n", 3);
+    CHECK(samples == QVector<Sample>({{0, 3, 9}}));
+    
+    double value = 0;
+    const char number[] = "-.5e-1x";
+    CHECK(TelemetryParser::parseNumber(number, number + 7, &value) == number + 6 && value == -0.05);
+    const char word[] = "abc";
+    CHECK(!TelemetryParser::parseNumber(word, word + 3, &value));
+}
+
+static void checkPlotSeries()
+{
+    // 写满并覆盖后，任意区间的最值与逐个比较的结果一致
+    PlotSeries series(256);
+    QRandomGenerator random(7);
+    for (qint64 i = 0; i < 2000; ++i) {
+        series.append(i, static_cast<float>(random.bounded(10000)));
+    }
+    CHECK(series.firstIndex() == 2000 - series.capacity() && series.endIndex() == 2000);
+    CHECK(series.lowerBound(1900) == 1900 && series.lowerBound(5000) == 2000);
+    bool consistent = true;
+    for (int i = 0; i < 500; ++i) {
+        const qint64 begin = series.firstIndex() + random.bounded(static_cast<int>(series.capacity()));
+        const qint64 end = begin + 1 + random.bounded(static_cast<int>(series.endIndex() - begin));
+        float low = 0;
+        float high = 0;
+        series.range(begin, end, &low, &high);
+        float expectedLow = series.value(begin);
+        float expectedHigh = expectedLow;
+        for (qint64 index = begin; index < end; ++index) {
+            expectedLow = std::min(expectedLow, series.value(index));
+            expectedHigh = std::max(expectedHigh, series.value(index));
+        }
+        consistent = consistent && low == expectedLow && high == expectedHigh;
+    }
+    CHECK(consistent);
+}
+
+static void checkCaptureFile()
+{
+    // 正常关闭的录制文件能读回端口表；端口表中的长度越界时打开失败
+    QTemporaryDir dir;
+    CHECK(dir.isValid());
+    const QString fileName = dir.filePath("check.scap");
+    CaptureWriter writer;
+    CHECK(writer.open(fileName));
+    const quint16 port = writer.addPort("COM1");
+    CHECK(writer.addPort("COM1") == port);
+    writer.write(1, RecordDirection::Rx, port, "abc", 3);
+    writer.close();
+    CaptureReader reader;
+    CHECK(reader.open(fileName) && reader.hasIndex() && reader.portNames() == QStringList({"COM1"}));
+    reader.close();
+    
+    QFile file(fileName);
+    CHECK(file.open(QIODevice::ReadWrite));
+    CaptureFileFooter footer;
+    file.seek(file.size() - sizeof(footer));
+    file.read(reinterpret_cast<char *>(&footer), sizeof(footer));
+    const quint32 length = 0x7FFFFFFF;
+    file.seek(footer.portOffset);
+    file.write(reinterpret_cast<const char *>(&length), sizeof(length));
+    file.close();
+    CHECK(!reader.open(fileName) && !reader.isOpen());
+}
+
+// 基准测试状态，与 Google Benchmark 的 State 类似：循环次数由框架决定
+class BenchState
+{
+public:
+    explicit BenchState(qint64 iterations)
+        : total(iterations)
+        , done(0)
+    {
+    }
+    
+    bool keepRunning()
+    {
+        return done++ < total;
+    }
+    
+    qint64 iterations() const
+    {
+        return total;
+    }
+
+private:
+    qint64 total;
+    qint64 done;
+};
+
+struct Benchmark
+{
+    QString name;
+    qint64 bytes;       // 每次循环处理的字节数，用于计算吞吐量
+    std::function<void(BenchState &)> body;
+};
+
+static QVector<Benchmark> benchmarks()
+{
+    QVector<Benchmark> list;
+    for (qint64 size : {64, 4096, 65536}) {
+        const QByteArray bytes = randomBytes(size, 1);
+        const QString hex = HexFormatter().format(bytes);
+        const QByteArray text = textLines(size);
+        const QByteArray utf8 = QString("温度 25℃ 湿度 40% ").repeated(static_cast<int>(size / 16 + 1)).toUtf8().left(size);
+        const QString unicode = QString::fromUtf8(utf8);
+        
+        list.append({"HexFormatter::toHex", size, [bytes](BenchState &state) {
+            QString out(bytes.size() * 2, Qt::Uninitialized);
+            while (state.keepRunning()) {
+                HexFormatter::toHex(reinterpret_cast<const uchar *>(bytes.constData()), bytes.size(), reinterpret_cast<char16_t *>(out.data()));
+                sink += out.at(0).unicode();
+            }
+        }});
+        list.append({"HexFormatter::format", size, [bytes](BenchState &state) {
+            const HexFormatter formatter;
+            while (state.keepRunning()) {
+                sink += formatter.format(bytes).size();
+            }
+        }});
+        list.append({"HexFormatter::format/dump", size, [bytes](BenchState &state) {
+            HexFormatOptions options;
+            options.dumpLayout = true;
+            const HexFormatter formatter(options);
+            while (state.keepRunning()) {
+                sink += formatter.format(bytes).size();
+            }
+        }});
+        list.append({"HexParser::parse", size, [hex](BenchState &state) {
+            QByteArray out;
+            while (state.keepRunning()) {
+                out.clear();
+                HexParser::parse(hex, &out);
+                sink += out.size();
+            }
+        }});
+        list.append({"SessionCodec::decode/UTF-8", size, [utf8](BenchState &state) {
+            SessionCodec codec("UTF-8");
+            while (state.keepRunning()) {
+                sink += codec.decode(utf8).size();
+            }
+        }});
+        list.append({"SessionCodec::decode/GBK", size, [unicode](BenchState &state) {
+            SessionCodec codec("GBK");
+            const QByteArray gbk = codec.encode(unicode);
+            while (state.keepRunning()) {
+                sink += codec.decode(gbk).size();
+            }
+        }});
+        list.append({"SessionCodec::encode/UTF-8", size, [unicode](BenchState &state) {
+            SessionCodec codec("UTF-8");
+            while (state.keepRunning()) {
+                sink += codec.encode(unicode).size();
+            }
+        }});
+        list.append({"SessionCodec::completeLength/UTF-8", size, [utf8](BenchState &state) {
+            const SessionCodec codec("UTF-8");
+            while (state.keepRunning()) {
+                sink += codec.completeLength(utf8.constData(), utf8.size());
+            }
+        }});
+        
+        const auto framerBenchmark = [](FramingConfig::Mode mode, const QByteArray &data) {
+            return [mode, data](BenchState &state) {
+                FramingConfig config;
+                config.mode = mode;
+                Framer framer;
+                framer.setConfig(config);
+                framer.setFrameHandler([](const char *, qint64 length, qint64, bool) { sink += length; });
+                while (state.keepRunning()) {
+                    framer.feed(data.constData(), data.size(), 0);
+                }
+            };
+        };
+        list.append({"Framer::feed/delimiter", size, framerBenchmark(FramingConfig::Delimiter, text)});
+        const QByteArray slip = encodeSlip(bytes);
+        list.append({"Framer::feed/slip", slip.size(), framerBenchmark(FramingConfig::Slip, slip)});
+        const QByteArray cobs = encodeCobs(bytes);
+        list.append({"Framer::feed/cobs", cobs.size(), framerBenchmark(FramingConfig::Cobs, cobs)});
+    }
+    
+    // 帧校验：64KB 数据
+    const QByteArray checksumData = randomBytes(65536, 5);
+    const QStringList checksumNames = Checksum::names();
+    for (int type = Checksum::Sum8; type < Checksum::TYPE_COUNT; ++type) {
+        list.append({"Checksum::compute/" + checksumNames.at(type), checksumData.size(), [checksumData, type](BenchState &state) {
+            while (state.keepRunning()) {
+                sink += Checksum::compute(static_cast<Checksum::Type>(type), checksumData.constData(), checksumData.size());
+            }
+        }});
+    }
+    
+    // 触发匹配：8 条规则，文本中偶尔出现匹配，以及所有模式首字节相同的情况
+    const QByteArray log = textLines(65536);
+    list.append({"TriggerMatcher::feed/8 patterns", log.size(), [log](BenchState &state) {
+        TriggerMatcher matcher;
+        matcher.setPatterns({"login:", "Password:", "ERROR", "PANIC", "OK\r\n", "\x02", "reboot", "$ "});
+        matcher.setMatchHandler([](int pattern, qint64 end) { sink += pattern + end; });
+        while (state.keepRunning()) {
+            matcher.feed(log.constData(), log.size());
+        }
+    }});
+    list.append({"TriggerMatcher::feed/same first byte", log.size(), [log](BenchState &state) {
+        TriggerMatcher matcher;
+        matcher.setPatterns({"\x02" "ERR", "\x02" "OK", "\x02" "BOOT"});
+        matcher.setMatchHandler([](int pattern, qint64 end) { sink += pattern + end; });
+        while (state.keepRunning()) {
+            matcher.feed(log.constData(), log.size());
+        }
+    }});
+    
+    // 遥测解析：每行一组三通道的 CSV 采样
+    QByteArray telemetry;
+    for (int i = 0; telemetry.size() < 65536; ++i) {
+        telemetry += QByteArray::number(i * 0.5) + "," + QByteArray::number(-i) + "," + QByteArray::number(i % 100) + "\r\n";
+    }
+    list.append({"TelemetryParser::feed/csv", telemetry.size(), [telemetry](BenchState &state) {
+        TelemetryParser parser;
+        parser.setSampleHandler([](int channel, qint64, double value) { sink += channel + static_cast<qint64>(value); });
+        while (state.keepRunning()) {
+            parser.feed(telemetry.constData(), telemetry.size());
+        }
+    }});
+    // 波形抽取：一百万个采样抽取到 1920 个像素列
+    list.append({"PlotSeries::range/1M->1920", 0, [](BenchState &state) {
+        PlotSeries series(1 << 20);
+        for (qint64 i = 0; i < (1 << 20); ++i) {
+            series.append(i, static_cast<float>(i % 1000));
+        }
+        const qint64 columns = 1920;
+        while (state.keepRunning()) {
+            qint64 index = series.firstIndex();
+            for (qint64 column = 0; column < columns; ++column) {
+                const qint64 next = series.lowerBound((column + 1) * series.endIndex() / columns);
+                float low = 0;
+                float high = 0;
+                series.range(index, next, &low, &high);
+                sink += static_cast<qint64>(high - low);
+                index = next;
+            }
+        }
+    }});
+    
+    list.append({"TimestampFormatter::format/us", 0, [](BenchState &state) {
+        TimestampFormatter formatter(TimestampFormatter::Microseconds);
+        qint64 timestamp = TimestampClock::now();
+        while (state.keepRunning()) {
+            timestamp += 1000;
+            sink += formatter.format(timestamp).size();
+        }
+    }});
+    return list;
+}
+
+// 循环次数从1开始按耗时估算增加，直到单轮运行时间不少于 minTime
+static QJsonObject runBenchmark(const Benchmark &benchmark, qint64 minTimeNs)
+{
+    qint64 iterations = 1;
+    qint64 elapsed = 0;
+    for (;;) {
+        BenchState state(iterations);
+        QElapsedTimer timer;
+        timer.start();
+        benchmark.body(state);
+        elapsed = timer.nsecsElapsed();
+        if (elapsed >= minTimeNs || iterations >= (qint64(1) << 40)) {
+            break;
+        }
+        // 按已测得的速度估算所需次数，多估一些以减少轮数，但每轮最多增加100倍
+        const qint64 estimate = elapsed > 0 ? iterations * minTimeNs * 14 / 10 / elapsed : iterations * 100;
+        iterations = qBound(iterations + 1, estimate, iterations * 100);
+    }
+    
+    const double nsPerIteration = static_cast<double>(elapsed) / static_cast<double>(iterations);
+    QJsonObject object;
+    object["name"] = benchmark.name;
+    object["bytes"] = benchmark.bytes;
+    object["iterations"] = iterations;
+    object["nsPerIteration"] = nsPerIteration;
+    if (benchmark.bytes > 0) {
+        object["bytesPerSecond"] = static_cast<double>(benchmark.bytes) * 1e9 / nsPerIteration;
+    }
+    return object;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    
+    QCommandLineParser parser;
+    parser.setApplicationDescription("数据处理代码的自检和微基准测试：每项输出一行 JSON");
+    parser.addHelpOption();
+    const QCommandLineOption checkOption("check", "只运行自检，不计时");
+    const QCommandLineOption filterOption("filter", "只运行名称匹配正则表达式的测试项", "regex");
+    const QCommandLineOption minTimeOption("min-time", "每项最少运行的秒数（默认 0.5）", "seconds", "0.5");
+    const QCommandLineOption outputOption(QStringList() << "o" << "output", "结果追加到文件，而不是标准输出", "file");
+    parser.addOptions({checkOption, filterOption, minTimeOption, outputOption});
+    parser.process(app);
+    
+    // 结果不对时计时没有意义，先自检
+    checkHexFormatter();
+    checkHexParser();
+    checkSessionCodec();
+    checkFramer();
+    checkChecksum();
+    checkTriggerMatcher();
+    checkTimestamp();
+    checkTelemetryParser();
+    checkPlotSeries();
+    checkCaptureFile();
+    std::fprintf(stderr, "自检%s（HexFormatter 使用 %s，CRC32C 使用 %s）\n", failures == 0 ? "通过" : "失败",
+                 HexFormatter::backend(), Checksum::crc32cBackend());
+    if (failures > 0) {
+        return 1;
+    }
+    if (parser.isSet(checkOption)) {
+        return 0;
+    }
+    
+    const QRegularExpression filter(parser.value(filterOption));
+    if (!filter.isValid()) {
+        std::fprintf(stderr, "无效的正则表达式：%s\n", qPrintable(filter.errorString()));
+        return 1;
+    }
+    const qint64 minTime = static_cast<qint64>(parser.value(minTimeOption).toDouble() * 1e9);
+    
+    QFile output;
+    if (parser.isSet(outputOption)) {
+        output.setFileName(parser.value(outputOption));
+        if (!output.open(QIODevice::WriteOnly | QIODevice::Append)) {
+            std::fprintf(stderr, "无法打开 %s：%s\n", qPrintable(output.fileName()), qPrintable(output.errorString()));
+            return 1;
+        }
+    } else {
+        output.open(stdout, QIODevice::WriteOnly);
+    }
+    
+    for (const Benchmark &benchmark : benchmarks()) {
+        if (!filter.match(benchmark.name).hasMatch()) {
+            continue;
+        }
+        QJsonObject result = runBenchmark(benchmark, minTime);
+        // 实现后端只对十六进制格式化有意义
+        if (benchmark.name.startsWith("HexFormatter")) {
+            result["backend"] = HexFormatter::backend();
+        }
+        output.write(QJsonDocument(result).toJson(QJsonDocument::Compact) + "\n");
+        output.flush();
+    }
+    return 0;
+}
\ No newline at end of file
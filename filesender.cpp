@@ -0,0 +1,178 @@
+#include "filesender.h"
+#include "timestamp.h"
+#include <QSerialPort>
+
+// 每次写入串口的块大小
+static const qint64 CHUNK_SIZE = 4096;
+// 本发送器写入而未写出的数据上限，超过后等 bytesWritten 再写
+static const qint64 MAX_PENDING_BYTES = 4 * CHUNK_SIZE;
+// CTS 无效或串口暂时不接受数据时的重试间隔（毫秒）
+static const int FLOW_POLL_INTERVAL = 10;
+
+FileSender::FileSender(QSerialPort *port, QObject *parent)
+    : QObject(parent)
+    , port(port)
+    , flowTimer(new QTimer(this))
+    , data(nullptr)
+    , offset(0)
+    , drained(0)
+    , confirmed(0)
+    , running(false)
+    , sentBytes(0)
+    , totalBytes(0)
+    , startStamp(0)
+    , stopStamp(0)
+{
+    flowTimer->setSingleShot(true);
+    flowTimer->setInterval(FLOW_POLL_INTERVAL);
+    connect(flowTimer, &QTimer::timeout, this, &FileSender::pump);
+    connect(port, &QSerialPort::bytesWritten, this, &FileSender::onBytesWritten);
+}
+
+void FileSender::setWriteHook(const std::function<void(const char *, qint64)> &hook)
+{
+    writeHook = hook;
+}
+
+FileSender::Progress FileSender::progress() const
+{
+    Progress result;
+    result.running = running.load(std::memory_order_acquire);
+    result.sent = sentBytes.load(std::memory_order_relaxed);
+    result.total = totalBytes.load(std::memory_order_relaxed);
+    const qint64 begin = startStamp.load(std::memory_order_relaxed);
+    const qint64 end = result.running ? TimestampClock::now() : stopStamp.load(std::memory_order_relaxed);
+    result.elapsed = begin > 0 ? qMax<qint64>(0, end - begin) : 0;
+    return result;
+}
+
+void FileSender::start(const QString &fileName)
+{
+    cancel();
+    offset = 0;
+    drained = 0;
+    confirmed = 0;
+    inFlight.clear();
+    sentBytes.store(0, std::memory_order_relaxed);
+    totalBytes.store(0, std::memory_order_relaxed);
+    startStamp.store(0, std::memory_order_relaxed);
+    if (!port->isOpen()) {
+        emit finished(false, "串口未打开");
+        return;
+    }
+    
+    file.setFileName(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        emit finished(false, file.errorString());
+        return;
+    }
+    const qint64 size = file.size();
+    if (size > 0) {
+        data = file.map(0, size);
+        if (!data) {
+            const QString error = file.errorString();
+            file.close();
+            emit finished(false, error);
+            return;
+        }
+    }
+    
+    totalBytes.store(size, std::memory_order_relaxed);
+    startStamp.store(TimestampClock::now(), std::memory_order_relaxed);
+    running.store(true, std::memory_order_release);
+    pump();
+}
+
+void FileSender::cancel()
+{
+    if (running.load(std::memory_order_acquire)) {
+        finish(false, "已取消");
+    }
+}
+
+void FileSender::pump()
+{
+    if (!running.load(std::memory_order_acquire)) {
+        return;
+    }
+    if (!port->isOpen()) {
+        finish(false, "串口已关闭");
+        return;
+    }
+    
+    const qint64 size = totalBytes.load(std::memory_order_relaxed);
+    if (port->bytesToWrite() == 0 && !inFlight.empty()) {
+        // 输出缓冲区已空（例如被清空而没有 bytesWritten），写入的数据都不会再有通知
+        drained = inFlight.back().start + inFlight.back().length;
+        settle();
+    }
+    while (offset < size && offset - confirmed < MAX_PENDING_BYTES) {
+        if (port->flowControl() == QSerialPort::HardwareControl
+            && !(port->pinoutSignals() & QSerialPort::ClearToSendSignal)) {
+            // 对方暂停接收，等 CTS 恢复
+            flowTimer->start();
+            break;
+        }
+        const qint64 length = qMin(CHUNK_SIZE, size - offset);
+        const char *chunk = reinterpret_cast<const char *>(data) + offset;
+        // 本块排在输出缓冲区中已有数据之后
+        const qint64 start = drained + port->bytesToWrite();
+        const qint64 written = port->write(chunk, length);
+        if (written < 0) {
+            finish(false, port->errorString());
+            return;
+        }
+        if (written == 0) {
+            // 串口暂时不接受数据，之后不一定还有 bytesWritten，定时重试
+            flowTimer->start();
+            break;
+        }
+        if (writeHook) {
+            writeHook(chunk, written);
+        }
+        inFlight.push_back({start, written});
+        offset += written;
+    }
+    
+    if (offset >= size && inFlight.empty()) {
+        finish(true, QString());
+    }
+}
+
+void FileSender::onBytesWritten(qint64 bytes)
+{
+    if (!running.load(std::memory_order_acquire)) {
+        return;
+    }
+    drained += bytes;
+    settle();
+    pump();
+}
+
+void FileSender::settle()
+{
+    // 输出队列按先后顺序写出，drained 越过一块的末尾即表示该块已全部写出
+    while (!inFlight.empty() && inFlight.front().start + inFlight.front().length <= drained) {
+        confirmed += inFlight.front().length;
+        inFlight.pop_front();
+    }
+    qint64 sent = confirmed;
+    if (!inFlight.empty() && drained > inFlight.front().start) {
+        sent += drained - inFlight.front().start;
+    }
+    sentBytes.store(sent, std::memory_order_relaxed);
+}
+
+void FileSender::finish(bool ok, const QString &errorString)
+{
+    flowTimer->stop();
+    inFlight.clear();
+    stopStamp.store(TimestampClock::now(), std::memory_order_relaxed);
+    running.store(false, std::memory_order_release);
+    if (data) {
+        file.unmap(const_cast<uchar *>(data));
+        data = nullptr;
+    }
+    file.close();
+    emit finished(ok, errorString);
+}
\ No newline at end of file
@@ -0,0 +1,92 @@
+#ifndef FILESENDER_H
+#define FILESENDER_H
+
+#include <QFile>
+#include <QObject>
+#include <QTimer>
+#include <atomic>
+#include <deque>
+#include <functional>
+
+class QSerialPort;
+
+// 文件发送器，运行在会话的I/O线程中
+// 文件以内存映射方式打开，不读入内存；每次只把一小块写入串口，本发送器写入而未写出的数据
+// 不超过固定上限，由 bytesWritten 信号驱动继续写入，因此任意大小的文件内存占用都不变。
+// 串口输出缓冲区中可能夹杂其他发送来源的数据，进度按每块在输出队列中的位置和 bytesWritten 累计，
+// 只统计本发送器自己的字节。
+// 硬件流控时 CTS 无效则暂停写入；软件流控由驱动按 XON/XOFF 暂停输出，输出缓冲区积压后同样不再写入。
+class FileSender : public QObject
+{
+    Q_OBJECT
+
+public:
+    // 发送进度，任意线程都可以读取
+    struct Progress
+    {
+        qint64 sent = 0;            // 已由串口写出的字节数
+        qint64 total = 0;
+        qint64 elapsed = 0;         // 纳秒
+        bool running = false;
+        
+        // 平均吞吐量（字节/秒）
+        double throughput() const
+        {
+            return elapsed > 0 ? sent * 1e9 / elapsed : 0.0;
+        }
+        // 按平均吞吐量估计的剩余时间（秒），无法估计时返回 -1
+        qint64 remainingSeconds() const
+        {
+            const double rate = throughput();
+            return rate > 0 ? static_cast<qint64>((total - sent) / rate) : -1;
+        }
+    };
+    
+    explicit FileSender(QSerialPort *port, QObject *parent = nullptr);
+    
+    // 每次写入成功后在I/O线程中调用，用于录制等
+    void setWriteHook(const std::function<void(const char *, qint64)> &hook);
+    
+    Progress progress() const;
+
+public slots:
+    // 以下槽函数都应通过排队连接在I/O线程中调用
+    void start(const QString &fileName);
+    void cancel();
+
+signals:
+    // 发送结束：全部写出、出错或被取消
+    void finished(bool ok, const QString &errorString);
+
+private slots:
+    void pump();
+    void onBytesWritten(qint64 bytes);
+
+private:
+    // 已写入串口输出缓冲区、尚未全部写出的一块数据
+    struct Chunk
+    {
+        qint64 start;           // 在输出队列中的位置，与 drained 同一起点
+        qint64 length;
+    };
+    
+    void settle();
+    void finish(bool ok, const QString &errorString);
+    
+    QSerialPort *port;
+    QTimer *flowTimer;          // CTS 无效或串口不接受数据时定时重试
+    std::function<void(const char *, qint64)> writeHook;
+    QFile file;
+    const uchar *data;
+    qint64 offset;              // 已写入串口输出缓冲区的位置
+    qint64 drained;             // 开始发送后串口报告写出的字节数，含其他来源写入的数据
+    qint64 confirmed;           // 本发送器写入且已全部写出的字节数
+    std::deque<Chunk> inFlight;
+    std::atomic<bool> running;
+    std::atomic<qint64> sentBytes;
+    std::atomic<qint64> totalBytes;
+    std::atomic<qint64> startStamp;
+    std::atomic<qint64> stopStamp;
+};
+
+#endif // FILESENDER_H
\ No newline at end of file
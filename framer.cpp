@@ -0,0 +1,463 @@
+#include "framer.h"
+#include "hexparser.h"
+#include <cstring>
+
+// SLIP 特殊字节
+static const uchar SLIP_END = 0xC0;
+static const uchar SLIP_ESC = 0xDB;
+static const uchar SLIP_ESC_END = 0xDC;
+static const uchar SLIP_ESC_ESC = 0xDD;
+
+bool FramingConfig::setParameter(const QString &text, QString *errorString)
+{
+    auto fail = [errorString](const QString &message) {
+        if (errorString) {
+            *errorString = message;
+        }
+        return false;
+    };
+    
+    const QString value = text.trimmed();
+    switch (mode) {
+    case Delimiter: {
+        QByteArray bytes;
+        if (!HexParser::parseEscaped(value, &bytes) || bytes.isEmpty()) {
+            return fail("分隔符无效，例如 \\r\\n、; 或 \\x7E");
+        }
+        delimiter = bytes;
+        return true;
+    }
+    case FixedLength: {
+        bool ok = false;
+        const int length = value.toInt(&ok);
+        if (!ok || length <= 0 || length > maxFrameLength) {
+            return fail(QString("帧长应为 1-%1").arg(maxFrameLength));
+        }
+        fixedLength = length;
+        return true;
+    }
+    case LengthPrefixed: {
+        // 偏移,字节数[,BE|LE[,修正值]]
+        const QStringList parts = value.split(',', Qt::SkipEmptyParts);
+        bool ok1 = false;
+        bool ok2 = false;
+        const int offset = parts.value(0).trimmed().toInt(&ok1);
+        const int size = parts.value(1).trimmed().toInt(&ok2);
+        if (parts.size() < 2 || !ok1 || !ok2 || offset < 0 || (size != 1 && size != 2 && size != 4)) {
+            return fail("格式为 偏移,字节数[,BE|LE[,修正值]]，字节数为 1、2 或 4");
+        }
+        bool bigEndian = true;
+        if (parts.size() > 2) {
+            const QString endian = parts.at(2).trimmed().toUpper();
+            if (endian != "BE" && endian != "LE") {
+                return fail("字节序应为 BE 或 LE");
+            }
+            bigEndian = endian == "BE";
+        }
+        int adjust = 0;
+        if (parts.size() > 3) {
+            bool ok = false;
+            adjust = parts.at(3).trimmed().toInt(&ok);
+            if (!ok) {
+                return fail("修正值应为整数");
+            }
+        }
+        lengthOffset = offset;
+        lengthSize = size;
+        lengthBigEndian = bigEndian;
+        lengthAdjust = adjust;
+        return true;
+    }
+    case IdleGap: {
+        bool ok = false;
+        const double ms = value.toDouble(&ok);
+        if (!ok || ms <= 0 || ms > 60000) {
+            return fail("空闲时间应为大于0的毫秒数");
+        }
+        idleGapUs = static_cast<int>(ms * 1000);
+        return true;
+    }
+    default:
+        return true;
+    }
+}
+
+QString FramingConfig::parameter() const
+{
+    switch (mode) {
+    case Delimiter: {
+        QString text;
+        for (const char c : delimiter) {
+            switch (c) {
+            case '\r': text += "\\r"; break;
+            case '\n': text += "\\n"; break;
+            case '\t': text += "\\t"; break;
+            case '\\': text += "\\\\"; break;
+            default:
+                if (static_cast<uchar>(c) < 0x20 || static_cast<uchar>(c) >= 0x7F) {
+                    text += QString("\\x%1").arg(static_cast<int>(static_cast<uchar>(c)), 2, 16, QLatin1Char('0'));
+                } else {
+                    text += QLatin1Char(c);
+                }
+                break;
+            }
+        }
+        return text;
+    }
+    case FixedLength:
+        return QString::number(fixedLength);
+    case LengthPrefixed:
+        return QString("%1,%2,%3,%4").arg(lengthOffset).arg(lengthSize)
+            .arg(lengthBigEndian ? "BE" : "LE").arg(lengthAdjust);
+    case IdleGap:
+        return QString::number(idleGapUs / 1000.0);
+    default:
+        return QString();
+    }
+}
+
+Framer::Framer()
+    : used(0)
+    , frameTime(0)
+    , chunkTime(0)
+    , lastTime(0)
+    , frameError(false)
+    , matched(0)
+    , expected(-1)
+    , escape(false)
+    , cobsRemaining(0)
+    , cobsPendingZero(false)
+    , cobsStarted(false)
+{
+    setConfig(FramingConfig());
+}
+
+void Framer::setConfig(const FramingConfig &config)
+{
+    cfg = config;
+    cfg.maxFrameLength = qMax(1, cfg.maxFrameLength);
+    buffer.resize(cfg.maxFrameLength);
+    
+    // 分隔符的 KMP 失配表，部分匹配失败时不必回退已读过的字节
+    const int length = static_cast<int>(cfg.delimiter.size());
+    delimiterFailure.fill(0, length);
+    for (int i = 1, k = 0; i < length; ++i) {
+        while (k > 0 && cfg.delimiter.at(i) != cfg.delimiter.at(k)) {
+            k = delimiterFailure.at(k - 1);
+        }
+        if (cfg.delimiter.at(i) == cfg.delimiter.at(k)) {
+            ++k;
+        }
+        delimiterFailure[i] = k;
+    }
+    reset();
+}
+
+FramingConfig Framer::config() const
+{
+    return cfg;
+}
+
+void Framer::setFrameHandler(const FrameHandler &value)
+{
+    handler = value;
+}
+
+void Framer::feed(const char *data, qint64 length, qint64 timestamp)
+{
+    if (length <= 0) {
+        return;
+    }
+    
+    chunkTime = timestamp;
+    switch (cfg.mode) {
+    case FramingConfig::None:
+        if (handler) {
+            handler(data, length, timestamp, false);
+        }
+        break;
+    case FramingConfig::Delimiter:
+        if (cfg.delimiter.isEmpty()) {
+            appendBlock(data, length);
+            emitFrame();
+        } else {
+            feedDelimiter(data, length);
+        }
+        break;
+    case FramingConfig::FixedLength:
+        feedFixed(data, length);
+        break;
+    case FramingConfig::LengthPrefixed:
+        feedLengthPrefixed(data, length);
+        break;
+    case FramingConfig::IdleGap:
+        // 本块与上一块之间的空闲超过设定值，之前的数据自成一帧。串口只按块给出读取时刻，
+        // 同一块内的字节视为连续到达，块内的空闲无法分辨
+        if (used > 0 && timestamp - lastTime >= static_cast<qint64>(cfg.idleGapUs) * 1000) {
+            emitFrame();
+        }
+        appendBlock(data, length);
+        break;
+    case FramingConfig::Slip:
+        feedSlip(data, length);
+        break;
+    case FramingConfig::Cobs:
+        feedCobs(data, length);
+        break;
+    }
+    lastTime = timestamp;
+}
+
+bool Framer::flushIfIdle(qint64 now)
+{
+    if (cfg.mode != FramingConfig::IdleGap || used == 0
+        || now - lastTime < static_cast<qint64>(cfg.idleGapUs) * 1000) {
+        return false;
+    }
+    emitFrame();
+    return true;
+}
+
+void Framer::flush()
+{
+    if (used > 0) {
+        // 分隔符等模式下未完成的帧属于不完整数据
+        emitFrame(cfg.mode != FramingConfig::IdleGap);
+    }
+    reset();
+}
+
+void Framer::reset()
+{
+    used = 0;
+    frameError = false;
+    matched = 0;
+    expected = -1;
+    escape = false;
+    cobsRemaining = 0;
+    cobsPendingZero = false;
+    cobsStarted = false;
+}
+
+bool Framer::hasPending() const
+{
+    return used > 0 || cobsStarted || escape;
+}
+
+qint64 Framer::lastByteTime() const
+{
+    return lastTime;
+}
+
+inline void Framer::append(char byte)
+{
+    if (used == 0) {
+        frameTime = chunkTime;
+    }
+    if (used == buffer.size()) {
+        // 超过最大帧长：输出已有部分并标记错误，后续字节开始新的一段
+        frameError = true;
+        emitFrame(true);
+        frameTime = chunkTime;
+    }
+    buffer.data()[used++] = byte;
+}
+
+void Framer::appendBlock(const char *data, qint64 length)
+{
+    while (length > 0) {
+        if (used == 0) {
+            frameTime = chunkTime;
+        }
+        if (used == buffer.size()) {
+            frameError = true;
+            emitFrame(true);
+            continue;
+        }
+        const qint64 n = qMin(length, buffer.size() - used);
+        std::memcpy(buffer.data() + used, data, static_cast<size_t>(n));
+        used += n;
+        data += n;
+        length -= n;
+    }
+}
+
+void Framer::emitFrame(bool error)
+{
+    if (handler) {
+        handler(buffer.constData(), used, frameTime, error || frameError);
+    }
+    used = 0;
+    frameError = false;
+}
+
+void Framer::feedDelimiter(const char *data, qint64 length)
+{
+    const char *delimiter = cfg.delimiter.constData();
+    const int delimiterLength = static_cast<int>(cfg.delimiter.size());
+    
+    if (delimiterLength == 1) {
+        // 单字节分隔符：用 memchr 找分隔符，中间的数据整段拷贝
+        const char *p = data;
+        const char *end = data + length;
+        while (p < end) {
+            const char *hit = static_cast<const char *>(std::memchr(p, delimiter[0], static_cast<size_t>(end - p)));
+            if (!hit) {
+                appendBlock(p, end - p);
+                break;
+            }
+            appendBlock(p, hit - p + (cfg.keepDelimiter ? 1 : 0));
+            emitFrame();
+            p = hit + 1;
+        }
+        return;
+    }
+    
+    for (qint64 i = 0; i < length; ++i) {
+        const char c = data[i];
+        while (matched > 0 && c != delimiter[matched]) {
+            matched = delimiterFailure.at(matched - 1);
+        }
+        if (c == delimiter[matched]) {
+            ++matched;
+        }
+        append(c);
+        if (matched == delimiterLength) {
+            if (!cfg.keepDelimiter) {
+                used = qMax<qint64>(0, used - delimiterLength);
+            }
+            emitFrame();
+            matched = 0;
+        }
+    }
+}
+
+void Framer::feedFixed(const char *data, qint64 length)
+{
+    const qint64 frameLength = qMin<qint64>(cfg.fixedLength, buffer.size());
+    while (length > 0) {
+        const qint64 n = qMin(length, frameLength - used);
+        appendBlock(data, n);
+        data += n;
+        length -= n;
+        if (used == frameLength) {
+            emitFrame();
+        }
+    }
+}
+
+void Framer::feedLengthPrefixed(const char *data, qint64 length)
+{
+    const qint64 headerLength = cfg.lengthOffset + cfg.lengthSize;
+    while (length > 0) {
+        if (expected < 0) {
+            // 先凑齐帧头，再从长度字段算出帧总长
+            const qint64 n = qMin(length, headerLength - used);
+            appendBlock(data, n);
+            data += n;
+            length -= n;
+            if (used < headerLength) {
+                break;
+            }
+            
+            const uchar *field = reinterpret_cast<const uchar *>(buffer.constData()) + cfg.lengthOffset;
+            quint64 value = 0;
+            for (int i = 0; i < cfg.lengthSize; ++i) {
+                const int index = cfg.lengthBigEndian ? i : cfg.lengthSize - 1 - i;
+                value = (value << 8) | field[index];
+            }
+            const qint64 total = headerLength + static_cast<qint64>(value) + cfg.lengthAdjust;
+            if (total < headerLength || total > buffer.size()) {
+                // 长度字段不合理：只把第一个字节作为错误帧输出，帧头其余字节移到缓冲区开头，
+                // 从下一个字节开始重新找帧头
+                const qint64 rest = used - 1;
+                used = 1;
+                emitFrame(true);
+                std::memmove(buffer.data(), buffer.constData() + 1, static_cast<size_t>(rest));
+                used = rest;
+                continue;
+            }
+            expected = total;
+        }
+        
+        const qint64 n = qMin(length, expected - used);
+        appendBlock(data, n);
+        data += n;
+        length -= n;
+        if (used == expected) {
+            emitFrame();
+            expected = -1;
+        }
+    }
+    if (expected >= 0 && used == expected) {
+        emitFrame();
+        expected = -1;
+    }
+}
+
+void Framer::feedSlip(const char *data, qint64 length)
+{
+    for (qint64 i = 0; i < length; ++i) {
+        const uchar c = static_cast<uchar>(data[i]);
+        if (escape) {
+            escape = false;
+            if (c == SLIP_ESC_END) {
+                append(static_cast<char>(SLIP_END));
+            } else if (c == SLIP_ESC_ESC) {
+                append(static_cast<char>(SLIP_ESC));
+            } else {
+                // 非法转义，保留原字节并在帧上标记错误
+                frameError = true;
+                append(static_cast<char>(c));
+            }
+        } else if (c == SLIP_END) {
+            // 连续的 END 之间没有数据，不产生空帧
+            if (used > 0) {
+                emitFrame();
+            }
+        } else if (c == SLIP_ESC) {
+            escape = true;
+            if (used == 0) {
+                frameTime = chunkTime;
+            }
+        } else {
+            append(static_cast<char>(c));
+        }
+    }
+}
+
+void Framer::feedCobs(const char *data, qint64 length)
+{
+    for (qint64 i = 0; i < length; ++i) {
+        const uchar c = static_cast<uchar>(data[i]);
+        if (c == 0) {
+            // 帧结束；最后一个块若未读完则帧不完整
+            if (cobsStarted) {
+                if (used == 0) {
+                    frameTime = chunkTime;
+                }
+                emitFrame(cobsRemaining != 0);
+            }
+            cobsRemaining = 0;
+            cobsPendingZero = false;
+            cobsStarted = false;
+            continue;
+        }
+        
+        if (cobsRemaining == 0) {
+            // 块首的码字节：上一块若不足 254 字节，块之间原本是一个 0
+            if (cobsPendingZero) {
+                append('\0');
+            }
+            if (!cobsStarted) {
+                frameTime = chunkTime;
+                cobsStarted = true;
+            }
+            cobsRemaining = c - 1;
+            cobsPendingZero = c != 0xFF;
+        } else {
+            append(static_cast<char>(c));
+            --cobsRemaining;
+        }
+    }
+}
\ No newline at end of file
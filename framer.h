@@ -0,0 +1,101 @@
+#ifndef FRAMER_H
+#define FRAMER_H
+
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+#include <functional>
+
+#include "checksum.h"
+
+// 分帧方式及参数
+struct FramingConfig
+{
+    enum Mode
+    {
+        None,               // 不分帧，按读到的数据块显示
+        Delimiter,          // 以分隔符结尾，如 \r\n
+        FixedLength,        // 固定长度
+        LengthPrefixed,     // 帧头中带长度字段
+        IdleGap,            // 相邻两次读取之间空闲超过设定时间即为一帧（读取时刻按块记录，块内不分帧）
+        Slip,               // RFC 1055 SLIP
+        Cobs                // COBS，以 0x00 结尾
+    };
+    
+    Mode mode = None;
+    QByteArray delimiter = "\r\n";
+    bool keepDelimiter = true;      // 帧数据中保留分隔符
+    int fixedLength = 16;
+    int lengthOffset = 0;           // 长度字段在帧头中的偏移
+    int lengthSize = 1;             // 长度字段字节数：1、2 或 4
+    bool lengthBigEndian = true;
+    int lengthAdjust = 0;           // 帧总长 = 长度字段之前及自身的字节数 + 字段值 + lengthAdjust
+    int idleGapUs = 5000;
+    int maxFrameLength = 65536;     // 超过该长度的帧被截断并标记为错误
+    Checksum checksum;              // 帧末尾（分隔符之前）的校验值，分帧时逐帧校验
+    
+    // 按界面上的一行参数文本设置当前模式的参数，格式见实现；出错时返回 false 并给出原因
+    bool setParameter(const QString &text, QString *errorString = nullptr);
+    QString parameter() const;
+};
+
+// 增量分帧状态机
+// 按字节流逐块输入，不关心数据在哪里被 readyRead 切开；每凑齐一帧调用一次帧回调。
+// 帧缓冲区按最大帧长一次性分配，之后逐字节处理不再分配内存。
+// SLIP/COBS 在分帧的同时完成解码，回调得到的是解码后的数据。
+class Framer
+{
+public:
+    // 帧回调：帧数据、长度、帧第一个字节读到的时刻、是否出错（截断、格式错误）
+    using FrameHandler = std::function<void(const char *data, qint64 length, qint64 timestamp, bool error)>;
+    
+    Framer();
+    
+    void setConfig(const FramingConfig &config);
+    FramingConfig config() const;
+    void setFrameHandler(const FrameHandler &handler);
+    
+    // 输入一段数据，timestamp 为这段数据读到的时刻
+    void feed(const char *data, qint64 length, qint64 timestamp);
+    // 空闲分帧：距最后一个字节已超过空闲时间时输出未完成的帧，返回是否输出了帧
+    bool flushIfIdle(qint64 now);
+    // 把未完成的帧原样输出（例如关闭串口时）
+    void flush();
+    // 丢弃未完成的帧
+    void reset();
+    
+    bool hasPending() const;
+    // 最后一个字节读到的时刻
+    qint64 lastByteTime() const;
+
+private:
+    inline void append(char byte);
+    void appendBlock(const char *data, qint64 length);
+    void emitFrame(bool error = false);
+    void feedDelimiter(const char *data, qint64 length);
+    void feedFixed(const char *data, qint64 length);
+    void feedLengthPrefixed(const char *data, qint64 length);
+    void feedSlip(const char *data, qint64 length);
+    void feedCobs(const char *data, qint64 length);
+    
+    FramingConfig cfg;
+    FrameHandler handler;
+    QByteArray buffer;          // 帧缓冲区，长度固定为最大帧长
+    qint64 used;                // 帧缓冲区中已有的字节数
+    qint64 frameTime;           // 当前帧第一个字节的时刻
+    qint64 chunkTime;           // 正在处理的数据块的时刻
+    qint64 lastTime;
+    bool frameError;            // 当前帧已截断或含非法转义
+    // 分隔符匹配（KMP）
+    QVector<int> delimiterFailure;
+    int matched;
+    // 长度前缀
+    qint64 expected;            // 已知帧总长后为帧总长，否则为 -1
+    // SLIP/COBS
+    bool escape;
+    int cobsRemaining;          // 当前 COBS 块还剩的数据字节数
+    bool cobsPendingZero;       // 下一个块开始前需要补一个 0
+    bool cobsStarted;
+};
+
+#endif // FRAMER_H
\ No newline at end of file
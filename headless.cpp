@@ -0,0 +1,418 @@
+#include "headless.h"
+#include "capturefile.h"
+#include "renderscheduler.h"
+#include "session.h"
+#include "timestamp.h"
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QSocketNotifier>
+#include <QTimer>
+#include <atomic>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+
+#ifdef Q_OS_UNIX
+#include <unistd.h>
+#endif
+
+// 收到 SIGINT/SIGTERM 后置位，由定时器在事件循环中检查，保证录制文件正常写完索引
+static std::atomic<bool> interrupted(false);
+
+static void onSignal(int)
+{
+    interrupted.store(true);
+}
+
+// 进程退出码
+static const int EXIT_OK = 0;
+static const int EXIT_USAGE = 1;
+static const int EXIT_PORT = 2;
+
+bool HeadlessRunner::requested(int argc, char *argv[])
+{
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--headless") == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+int HeadlessRunner::run(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    app.setOrganizationName("QtSerialTool");
+    app.setApplicationName("SerialTool");
+    
+    HeadlessRunner runner;
+    QString errorString;
+    if (!runner.start(app.arguments(), &errorString)) {
+        std::fprintf(stderr, "%s\n", qPrintable(errorString));
+        return EXIT_USAGE;
+    }
+    app.exec();
+    return runner.exitCode();
+}
+
+HeadlessRunner::HeadlessRunner(QObject *parent)
+    : QObject(parent)
+    , captureWriter(nullptr)
+    , scheduler(new RenderScheduler(this))
+    , stdinNotifier(nullptr)
+    , signalTimer(new QTimer(this))
+    , output(OutputRaw)
+    , pendingOpens(0)
+    , code(EXIT_OK)
+    , stopping(false)
+{
+    connect(scheduler, &RenderScheduler::frame, this, &HeadlessRunner::drain);
+    connect(signalTimer, &QTimer::timeout, this, [this]() {
+        if (interrupted.load()) {
+            stop(EXIT_OK);
+        }
+    });
+}
+
+HeadlessRunner::~HeadlessRunner()
+{
+    // 先关闭串口并停止I/O线程，再写出录制文件的剩余数据和索引
+    qDeleteAll(sessions);
+    delete captureWriter;
+}
+
+bool HeadlessRunner::start(const QStringList &arguments, QString *errorString)
+{
+    QCommandLineParser parser;
+    parser.setApplicationDescription("串口工具无界面模式：接收数据写到标准输出，标准输入发往第一个串口");
+    parser.addHelpOption();
+    const QCommandLineOption headlessOption("headless", "以无界面模式运行");
+    const QCommandLineOption portOption(QStringList() << "p" << "port", "串口名，可重复指定以同时打开多个串口", "name");
+    const QCommandLineOption baudOption(QStringList() << "b" << "baud", "波特率（默认 115200）", "rate", "115200");
+    const QCommandLineOption dataBitsOption("data-bits", "数据位 5-8（默认 8）", "bits", "8");
+    const QCommandLineOption parityOption("parity", "校验位 none|odd|even|mark|space（默认 none）", "parity", "none");
+    const QCommandLineOption stopBitsOption("stop-bits", "停止位 1|1.5|2（默认 1）", "bits", "1");
+    const QCommandLineOption flowOption("flow", "流控制 none|hw|sw（默认 none）", "mode", "none");
+    const QCommandLineOption framingOption("framing", "分帧方式 none|delimiter|fixed|length|idle|slip|cobs（默认 none）", "mode", "none");
+    const QCommandLineOption framingParameterOption("framing-param", "分帧参数，格式与界面中的参数框相同", "parameter");
+    const QCommandLineOption checksumOption("checksum", "逐帧校验帧末尾的校验值 none|sum8|xor8|crc16-modbus|crc16-ccitt|crc16-xmodem|crc32|crc32c，"
+                                            "可加 :le 或 :be 指定字节序（默认 none）", "type", "none");
+    const QCommandLineOption recordOption(QStringList() << "r" << "record", "把收发数据录制到文件", "file");
+    const QCommandLineOption bridgeOption("bridge", "把串口桥接到本机套接字 tcp:[地址:]端口 或 unix:路径，按顺序对应 --port", "address");
+    const QCommandLineOption triggerOption("trigger", "触发规则 \"匹配内容 => 动作[:参数]\"，动作为 send|mark|record|stop|pause，"
+                                           "可重复指定，例如 --trigger \"login: => send:root\\r\"", "rule");
+    const QCommandLineOption outputOption("output", "标准输出格式 raw|hex|none（默认 raw）", "format", "raw");
+    const QCommandLineOption durationOption("duration", "运行指定秒数后退出", "seconds");
+    parser.addOptions({headlessOption, portOption, baudOption, dataBitsOption, parityOption, stopBitsOption,
+                       flowOption, framingOption, framingParameterOption, checksumOption, recordOption, bridgeOption,
+                       triggerOption, outputOption, durationOption});
+    if (!parser.parse(arguments)) {
+        *errorString = parser.errorText();
+        return false;
+    }
+    if (parser.isSet("help")) {
+        parser.showHelp(EXIT_OK);
+    }
+    
+    const QStringList ports = parser.values(portOption);
+    if (ports.isEmpty()) {
+        *errorString = "缺少 --port";
+        return false;
+    }
+    
+    // 串口参数，取值与界面中的下拉框一致
+    SerialConfig config;
+    bool ok = false;
+    config.baudRate = parser.value(baudOption).toInt(&ok);
+    if (!ok || config.baudRate <= 0) {
+        *errorString = "无效的波特率：" + parser.value(baudOption);
+        return false;
+    }
+    const int dataBits = parser.value(dataBitsOption).toInt(&ok);
+    if (!ok || dataBits < 5 || dataBits > 8) {
+        *errorString = "无效的数据位：" + parser.value(dataBitsOption);
+        return false;
+    }
+    config.dataBits = static_cast<QSerialPort::DataBits>(dataBits);
+    
+    const QString parity = parser.value(parityOption).toLower();
+    const QStringList parities = {"none", "odd", "even", "mark", "space"};
+    const QSerialPort::Parity parityValues[] = {QSerialPort::NoParity, QSerialPort::OddParity, QSerialPort::EvenParity,
+                                                QSerialPort::MarkParity, QSerialPort::SpaceParity};
+    if (!parities.contains(parity)) {
+        *errorString = "无效的校验位：" + parity;
+        return false;
+    }
+    config.parity = parityValues[parities.indexOf(parity)];
+    
+    const QString stopBits = parser.value(stopBitsOption);
+    if (stopBits == "1") {
+        config.stopBits = QSerialPort::OneStop;
+    } else if (stopBits == "1.5") {
+        config.stopBits = QSerialPort::OneAndHalfStop;
+    } else if (stopBits == "2") {
+        config.stopBits = QSerialPort::TwoStop;
+    } else {
+        *errorString = "无效的停止位：" + stopBits;
+        return false;
+    }
+    
+    const QString flow = parser.value(flowOption).toLower();
+    if (flow == "none") {
+        config.flowControl = QSerialPort::NoFlowControl;
+    } else if (flow == "hw") {
+        config.flowControl = QSerialPort::HardwareControl;
+    } else if (flow == "sw") {
+        config.flowControl = QSerialPort::SoftwareControl;
+    } else {
+        *errorString = "无效的流控制：" + flow;
+        return false;
+    }
+    
+    // 分帧方式，顺序与 FramingConfig::Mode 一致
+    const QStringList modes = {"none", "delimiter", "fixed", "length", "idle", "slip", "cobs"};
+    const int mode = modes.indexOf(parser.value(framingOption).toLower());
+    if (mode < 0) {
+        *errorString = "无效的分帧方式：" + parser.value(framingOption);
+        return false;
+    }
+    FramingConfig framing;
+    framing.mode = static_cast<FramingConfig::Mode>(mode);
+    if (parser.isSet(framingParameterOption) && !framing.setParameter(parser.value(framingParameterOption), errorString)) {
+        *errorString = "分帧参数错误：" + *errorString;
+        return false;
+    }
+    
+    // 校验方式，顺序与 Checksum::Type 一致；不指定字节序时按该校验的惯用字节序
+    const QStringList checksums = {"none", "sum8", "xor8", "crc16-modbus", "crc16-ccitt", "crc16-xmodem", "crc32", "crc32c"};
+    const QStringList checksumParts = parser.value(checksumOption).toLower().split(':');
+    const int checksum = checksums.indexOf(checksumParts.first());
+    const QString byteOrder = checksumParts.value(1, checksum >= 0 && Checksum::defaultBigEndian(static_cast<Checksum::Type>(checksum)) ? "be" : "le");
+    if (checksum < 0 || checksumParts.size() > 2 || (byteOrder != "le" && byteOrder != "be")) {
+        *errorString = "无效的校验方式：" + parser.value(checksumOption);
+        return false;
+    }
+    framing.checksum = Checksum(static_cast<Checksum::Type>(checksum), byteOrder == "be");
+    
+    // 触发规则对每个串口都生效；无界面时没有显示可暂停，pause 只计数
+    QVector<TriggerRule> triggerRules;
+    for (const QString &text : parser.values(triggerOption)) {
+        TriggerRule rule;
+        if (!rule.parse(text, errorString)) {
+            *errorString = "无效的触发规则 " + text + "：" + *errorString;
+            return false;
+        }
+        triggerRules.append(rule);
+    }
+    
+    const QStringList outputs = {"raw", "hex", "none"};
+    const int outputIndex = outputs.indexOf(parser.value(outputOption).toLower());
+    if (outputIndex < 0) {
+        *errorString = "无效的输出格式：" + parser.value(outputOption);
+        return false;
+    }
+    output = static_cast<OutputMode>(outputIndex);
+    
+    double duration = 0;
+    if (parser.isSet(durationOption)) {
+        duration = parser.value(durationOption).toDouble(&ok);
+        if (!ok || duration <= 0 || duration * 1000 > std::numeric_limits<int>::max()) {
+            *errorString = "无效的运行时间：" + parser.value(durationOption);
+            return false;
+        }
+    }
+    
+    const QStringList bridges = parser.values(bridgeOption);
+    if (bridges.size() > ports.size()) {
+        *errorString = "--bridge 的个数多于 --port";
+        return false;
+    }
+    
+    // 参数全部检查通过后才创建录制文件、打开串口
+    if (parser.isSet(recordOption)) {
+        captureWriter = new CaptureWriter;
+        if (!captureWriter->open(parser.value(recordOption))) {
+            *errorString = "无法创建录制文件：" + captureWriter->errorString();
+            return false;
+        }
+    }
+    
+    // 每个串口一个会话，各自在独立的I/O线程中收发
+    for (int i = 0; i < ports.size(); ++i) {
+        const QString &port = ports.at(i);
+        const QString bridge = bridges.value(i);
+        Session *session = new Session;
+        sessions.append(session);
+        session->setFramingConfig(framing);
+        if (captureWriter) {
+            session->setCaptureWriter(captureWriter);
+        }
+        if (!triggerRules.isEmpty()) {
+            session->setTriggerRules(triggerRules);
+        }
+        connect(session, &Session::triggerFired, this, [this, session](TriggerRule::Action action) {
+            // 停止录制已由I/O线程完成；之后重新开始录制时继续写入同一个文件，正在录制时不重复登记
+            if (action == TriggerRule::StopRecord) {
+                recordingStopped.insert(session);
+            } else if (action == TriggerRule::StartRecord && captureWriter && !stopping
+                       && recordingStopped.remove(session)) {
+                session->setCaptureWriter(captureWriter);
+            }
+        });
+        connect(session, &Session::updateRequested, scheduler, &RenderScheduler::requestFrame);
+        connect(session, &Session::opened, this, [this, session, bridge]() {
+            std::fprintf(stderr, "%s: 已打开\n", qPrintable(session->name()));
+            --pendingOpens;
+            if (!bridge.isEmpty()) {
+                session->startBridge(bridge);
+            }
+        });
+        connect(session, &Session::bridgeChanged, this, [session]() {
+            if (session->isBridging()) {
+                std::fprintf(stderr, "%s: 桥接 %s，%d 个客户端\n", qPrintable(session->name()),
+                             qPrintable(session->bridgeAddress()), session->bridgeStatus().clients);
+            }
+        });
+        connect(session, &Session::bridgeFailed, this, [session](const QString &error) {
+            std::fprintf(stderr, "%s: 桥接失败，%s\n", qPrintable(session->name()), qPrintable(error));
+        });
+        connect(session, &Session::openFailed, this, [this, session](const QString &error) {
+            std::fprintf(stderr, "%s: 打开失败，%s\n", qPrintable(session->name()), qPrintable(error));
+            --pendingOpens;
+            checkFinished();
+        });
+        connect(session, &Session::closed, this, &HeadlessRunner::checkFinished);
+        
+        SerialConfig portConfig = config;
+        portConfig.portName = port;
+        ++pendingOpens;
+        session->open(portConfig);
+    }
+    
+    // 无界面时不受显示帧率限制，但仍把频繁的 readyRead 合并成批处理
+    scheduler->setFrameRate(100);
+    
+#ifdef Q_OS_UNIX
+    // 标准输入的数据发往第一个串口
+    stdinNotifier = new QSocketNotifier(STDIN_FILENO, QSocketNotifier::Read, this);
+    connect(stdinNotifier, &QSocketNotifier::activated, this, &HeadlessRunner::readStdin);
+#endif
+    
+    std::signal(SIGINT, onSignal);
+    std::signal(SIGTERM, onSignal);
+    signalTimer->start(100);
+    
+    if (duration > 0) {
+        QTimer::singleShot(static_cast<int>(duration * 1000), this, [this]() {
+            stop(EXIT_OK);
+        });
+    }
+    return true;
+}
+
+int HeadlessRunner::exitCode() const
+{
+    return code;
+}
+
+void HeadlessRunner::drain()
+{
+    // 取走各会话积累的数据写到标准输出，然后清空接收存储，长时间运行内存也不增长
+    TimestampFormatter formatter(TimestampFormatter::Microseconds);
+    for (Session *session : sessions) {
+        session->readData();
+        ChunkStore *store = session->store();
+        const qint64 count = store->recordCount();
+        for (qint64 i = 0; i < count && output != OutputNone; ++i) {
+            const Record record = store->record(i);
+            if (record.direction != RecordDirection::Rx) {
+                continue;
+            }
+            const bool marker = record.flags & RecordMarker;
+            if (output == OutputRaw) {
+                // 原样输出时只输出串口数据，不混入触发标记
+                if (marker) {
+                    continue;
+                }
+                std::fwrite(record.data.constData(), 1, static_cast<size_t>(record.data.size()), stdout);
+            } else {
+                const QByteArray line = (formatter.format(record.timestamp) + "[" + session->name() + "] "
+                                         + (record.flags & RecordFrameError ? "[ERR] " : "")
+                                         + (record.flags & RecordChecksumError ? "[CHK] " : "")
+                                         + (marker ? "[MARK] " : "")).toUtf8()
+                    + (marker ? record.data : record.data.toHex(' ')) + "\n";
+                std::fwrite(line.constData(), 1, static_cast<size_t>(line.size()), stdout);
+            }
+        }
+        store->clear();
+    }
+    std::fflush(stdout);
+}
+
+void HeadlessRunner::readStdin()
+{
+#ifdef Q_OS_UNIX
+    char buffer[65536];
+    const ssize_t length = ::read(STDIN_FILENO, buffer, sizeof(buffer));
+    if (length <= 0) {
+        // 标准输入结束，不再转发，继续接收
+        stdinNotifier->setEnabled(false);
+        return;
+    }
+    if (!sessions.isEmpty()) {
+        sessions.first()->send(QByteArray(buffer, static_cast<int>(length)));
+    }
+#endif
+}
+
+void HeadlessRunner::checkFinished()
+{
+    // 所有串口都已关闭（打开失败或设备断开）时退出
+    if (pendingOpens > 0) {
+        return;
+    }
+    for (Session *session : sessions) {
+        if (session->isOpen()) {
+            return;
+        }
+    }
+    stop(EXIT_PORT);
+}
+
+void HeadlessRunner::stop(int exitCode)
+{
+    if (stopping) {
+        return;
+    }
+    stopping = true;
+    code = exitCode;
+    signalTimer->stop();
+    drain();
+    
+    // 统计写到标准错误
+    for (Session *session : sessions) {
+        std::fprintf(stderr, "%s: 发送 %lld 字节，接收 %lld 字节\n", qPrintable(session->name()),
+                     static_cast<long long>(session->sentBytes()), static_cast<long long>(session->receivedBytes()));
+        if (!session->triggerRules().isEmpty()) {
+            const TriggerEngine::Stats triggers = session->triggerStats();
+            std::fprintf(stderr, "%s: 触发 %lld 次，响应延迟 平均 %.1f 最大 %.1f 微秒\n", qPrintable(session->name()),
+                         static_cast<long long>(triggers.matches), triggers.meanLatency() / 1000.0,
+                         triggers.maxLatency / 1000.0);
+        }
+    }
+    if (captureWriter) {
+        for (Session *session : sessions) {
+            session->setCaptureWriter(nullptr);
+        }
+        const qint64 dropped = captureWriter->droppedBytes();
+        captureWriter->close();
+        std::fprintf(stderr, "录制 %s：%lld 字节%s\n", qPrintable(captureWriter->fileName()),
+                     static_cast<long long>(captureWriter->bytesWritten()),
+                     dropped > 0 ? qPrintable(QString("，写盘不及丢弃 %1 字节").arg(dropped)) : "");
+        if (!captureWriter->errorString().isEmpty()) {
+            std::fprintf(stderr, "录制文件写入失败：%s\n", qPrintable(captureWriter->errorString()));
+        }
+    }
+    QCoreApplication::exit(code);
+}
\ No newline at end of file
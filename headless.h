@@ -0,0 +1,66 @@
+#ifndef HEADLESS_H
+#define HEADLESS_H
+
+#include <QObject>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include "framer.h"
+#include "serialworker.h"
+
+class CaptureWriter;
+class QSocketNotifier;
+class QTimer;
+class RenderScheduler;
+class Session;
+
+// 无界面模式
+// 只创建 QCoreApplication，与界面共用 Session（串口参数、I/O线程、分帧）和 CaptureWriter（录制），
+// 不构造也不依赖任何窗口部件，可以在没有显示器的机器上或脚本中运行，例如：
+//   SerialTool --headless --port /dev/ttyUSB0 --baud 921600 --record out.scap
+// 接收的数据写到标准输出，标准输入的数据发往第一个串口，状态和统计写到标准错误。
+class HeadlessRunner : public QObject
+{
+    Q_OBJECT
+
+public:
+    // 命令行中是否带 --headless，在创建应用程序对象之前调用
+    static bool requested(int argc, char *argv[]);
+    // 创建 QCoreApplication 并运行到结束，返回进程退出码
+    static int run(int argc, char *argv[]);
+    
+    explicit HeadlessRunner(QObject *parent = nullptr);
+    ~HeadlessRunner();
+    
+    // 按命令行参数打开串口和录制文件；参数错误时返回 false
+    bool start(const QStringList &arguments, QString *errorString);
+    int exitCode() const;
+
+private:
+    enum OutputMode
+    {
+        OutputRaw,          // 原样输出接收的字节
+        OutputHex,          // 每条记录一行：时间 [端口] 十六进制
+        OutputNone
+    };
+    
+    void drain();
+    void readStdin();
+    void checkFinished();
+    void stop(int code);
+    
+    QVector<Session *> sessions;
+    QSet<Session *> recordingStopped;   // 被触发规则停止录制的会话
+    CaptureWriter *captureWriter;
+    RenderScheduler *scheduler;
+    QSocketNotifier *stdinNotifier;
+    QTimer *signalTimer;
+    OutputMode output;
+    int pendingOpens;
+    int code;
+    bool stopping;
+};
+
+#endif // HEADLESS_H
\ No newline at end of file
@@ -0,0 +1,7 @@
+#include "headless.h"
+
+// 无界面命令行版本的入口，只链接 Qt Core 和 SerialPort
+int main(int argc, char *argv[])
+{
+    return HeadlessRunner::run(argc, argv);
+}
\ No newline at end of file
@@ -0,0 +1,319 @@
+#include "hexformatter.h"
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define HEX_HAVE_SSE2 1
+#include <emmintrin.h>
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define HEX_TARGET_AVX2
+#else
+#define HEX_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+// 分组输出时每批先连续转换的字节数
+static const int HEX_CHUNK = 256;
+// 经典布局下默认每行字节数
+static const int DUMP_BYTES_PER_LINE = 16;
+
+// 半字节查找表
+static const char16_t UPPER_DIGITS[16] = {u'0', u'1', u'2', u'3', u'4', u'5', u'6', u'7',
+                                          u'8', u'9', u'A', u'B', u'C', u'D', u'E', u'F'};
+static const char16_t LOWER_DIGITS[16] = {u'0', u'1', u'2', u'3', u'4', u'5', u'6', u'7',
+                                          u'8', u'9', u'a', u'b', u'c', u'd', u'e', u'f'};
+
+static void toHexScalar(const uchar *data, qint64 length, char16_t *out, bool upperCase)
+{
+    const char16_t *digits = upperCase ? UPPER_DIGITS : LOWER_DIGITS;
+    for (qint64 i = 0; i < length; ++i) {
+        const uchar byte = data[i];
+        out[0] = digits[byte >> 4];
+        out[1] = digits[byte & 0x0F];
+        out += 2;
+    }
+}
+
+#ifdef HEX_HAVE_SSE2
+// 半字节(0-15)转ASCII：加 '0'，大于9的再加上到 'A'/'a' 的差值，全程无分支
+static inline __m128i nibblesToAscii(__m128i nibbles, bool upperCase)
+{
+    const __m128i letters = _mm_and_si128(_mm_cmpgt_epi8(nibbles, _mm_set1_epi8(9)),
+                                          _mm_set1_epi8(upperCase ? 'A' - '0' - 10 : 'a' - '0' - 10));
+    return _mm_add_epi8(_mm_add_epi8(nibbles, _mm_set1_epi8('0')), letters);
+}
+
+// 每次16字节 -> 32个UTF-16字符，返回已处理的字节数
+static qint64 toHexSse2(const uchar *data, qint64 length, char16_t *out, bool upperCase)
+{
+    const __m128i mask = _mm_set1_epi8(0x0F);
+    const __m128i zero = _mm_setzero_si128();
+    qint64 i = 0;
+    for (; i + 16 <= length; i += 16) {
+        const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+        const __m128i high = nibblesToAscii(_mm_and_si128(_mm_srli_epi16(bytes, 4), mask), upperCase);
+        const __m128i low = nibblesToAscii(_mm_and_si128(bytes, mask), upperCase);
+        // 高低半字节交错成字符对，再零扩展为UTF-16
+        const __m128i first = _mm_unpacklo_epi8(high, low);
+        const __m128i second = _mm_unpackhi_epi8(high, low);
+        __m128i *dst = reinterpret_cast<__m128i *>(out + 2 * i);
+        _mm_storeu_si128(dst, _mm_unpacklo_epi8(first, zero));
+        _mm_storeu_si128(dst + 1, _mm_unpackhi_epi8(first, zero));
+        _mm_storeu_si128(dst + 2, _mm_unpacklo_epi8(second, zero));
+        _mm_storeu_si128(dst + 3, _mm_unpackhi_epi8(second, zero));
+    }
+    return i;
+}
+
+HEX_TARGET_AVX2 static inline __m256i nibblesToAscii256(__m256i nibbles, bool upperCase)
+{
+    const __m256i letters = _mm256_and_si256(_mm256_cmpgt_epi8(nibbles, _mm256_set1_epi8(9)),
+                                             _mm256_set1_epi8(upperCase ? 'A' - '0' - 10 : 'a' - '0' - 10));
+    return _mm256_add_epi8(_mm256_add_epi8(nibbles, _mm256_set1_epi8('0')), letters);
+}
+
+// 每次32字节 -> 64个UTF-16字符，返回已处理的字节数
+HEX_TARGET_AVX2 static qint64 toHexAvx2(const uchar *data, qint64 length, char16_t *out, bool upperCase)
+{
+    const __m256i mask = _mm256_set1_epi8(0x0F);
+    qint64 i = 0;
+    for (; i + 32 <= length; i += 32) {
+        const __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i));
+        const __m256i high = nibblesToAscii256(_mm256_and_si256(_mm256_srli_epi16(bytes, 4), mask), upperCase);
+        const __m256i low = nibblesToAscii256(_mm256_and_si256(bytes, mask), upperCase);
+        // unpack 在每个128位通道内进行，交错后重新拼回字节顺序
+        const __m256i lowPairs = _mm256_unpacklo_epi8(high, low);
+        const __m256i highPairs = _mm256_unpackhi_epi8(high, low);
+        const __m256i first = _mm256_permute2x128_si256(lowPairs, highPairs, 0x20);
+        const __m256i second = _mm256_permute2x128_si256(lowPairs, highPairs, 0x31);
+        __m256i *dst = reinterpret_cast<__m256i *>(out + 2 * i);
+        _mm256_storeu_si256(dst, _mm256_cvtepu8_epi16(_mm256_castsi256_si128(first)));
+        _mm256_storeu_si256(dst + 1, _mm256_cvtepu8_epi16(_mm256_extracti128_si256(first, 1)));
+        _mm256_storeu_si256(dst + 2, _mm256_cvtepu8_epi16(_mm256_castsi256_si128(second)));
+        _mm256_storeu_si256(dst + 3, _mm256_cvtepu8_epi16(_mm256_extracti128_si256(second, 1)));
+    }
+    return i;
+}
+
+static bool detectAvx2()
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) {
+        return false;
+    }
+    __cpuid(info, 1);
+    // 需要CPU支持AVX且操作系统保存YMM寄存器
+    if (!(info[2] & (1 << 27)) || !(info[2] & (1 << 28)) || (_xgetbv(0) & 6) != 6) {
+        return false;
+    }
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+static bool hasAvx2()
+{
+    static const bool supported = detectAvx2();
+    return supported;
+}
+#endif
+
+HexFormatter::HexFormatter(const HexFormatOptions &options)
+    : opts(options)
+{
+}
+
+void HexFormatter::setOptions(const HexFormatOptions &options)
+{
+    opts = options;
+}
+
+HexFormatOptions HexFormatter::options() const
+{
+    return opts;
+}
+
+void HexFormatter::toHex(const uchar *data, qint64 length, char16_t *out, bool upperCase)
+{
+    qint64 done = 0;
+#ifdef HEX_HAVE_SSE2
+    if (hasAvx2()) {
+        done = toHexAvx2(data, length, out, upperCase);
+    }
+    done += toHexSse2(data + done, length - done, out + 2 * done, upperCase);
+#endif
+    toHexScalar(data + done, length - done, out + 2 * done, upperCase);
+}
+
+const char *HexFormatter::backend()
+{
+#ifdef HEX_HAVE_SSE2
+    return hasAvx2() ? "AVX2" : "SSE2";
+#else
+    return "scalar";
+#endif
+}
+
+qint64 HexFormatter::lineCount(qint64 length) const
+{
+    const int perLine = effectiveBytesPerLine();
+    if (perLine <= 0 || length <= perLine) {
+        return 1;
+    }
+    return (length + perLine - 1) / perLine;
+}
+
+QStringList HexFormatter::formatLines(const char *data, qint64 length, qint64 baseOffset) const
+{
+    const uchar *bytes = reinterpret_cast<const uchar *>(data);
+    const int perLine = effectiveBytesPerLine();
+    const qint64 step = perLine > 0 ? perLine : qMax<qint64>(1, length);
+    
+    QStringList lines;
+    lines.reserve(static_cast<int>(lineCount(length)));
+    qint64 offset = 0;
+    do {
+        const qint64 count = qMin(step, length - offset);
+        QString line(static_cast<qsizetype>(lineLength(count)), Qt::Uninitialized);
+        writeLine(bytes + offset, count, baseOffset + offset, reinterpret_cast<char16_t *>(line.data()));
+        lines.append(line);
+        offset += count;
+    } while (offset < length);
+    return lines;
+}
+
+QString HexFormatter::format(const char *data, qint64 length, qint64 baseOffset) const
+{
+    const uchar *bytes = reinterpret_cast<const uchar *>(data);
+    const int perLine = effectiveBytesPerLine();
+    const qint64 step = perLine > 0 ? perLine : qMax<qint64>(1, length);
+    
+    // 先算出总长度，整段输出只分配一次
+    qint64 total = 0;
+    for (qint64 offset = 0; offset == 0 || offset < length; offset += step) {
+        total += lineLength(qMin(step, length - offset)) + (offset > 0 ? 1 : 0);
+    }
+    
+    QString text(static_cast<qsizetype>(total), Qt::Uninitialized);
+    char16_t *out = reinterpret_cast<char16_t *>(text.data());
+    qint64 offset = 0;
+    do {
+        if (offset > 0) {
+            *out++ = u'\n';
+        }
+        const qint64 count = qMin(step, length - offset);
+        out = writeLine(bytes + offset, count, baseOffset + offset, out);
+        offset += count;
+    } while (offset < length);
+    return text;
+}
+
+int HexFormatter::effectiveBytesPerLine() const
+{
+    if (opts.bytesPerLine > 0) {
+        return opts.bytesPerLine;
+    }
+    return opts.dumpLayout ? DUMP_BYTES_PER_LINE : 0;
+}
+
+// 十六进制列的字符数（含组间分隔符）
+qint64 HexFormatter::hexWidth(qint64 bytes) const
+{
+    const bool grouped = opts.groupSize > 0 && !opts.separator.isNull();
+    const qint64 groups = grouped ? (bytes + opts.groupSize - 1) / opts.groupSize : 0;
+    return 2 * bytes + qMax<qint64>(0, groups - 1);
+}
+
+qint64 HexFormatter::lineLength(qint64 bytes) const
+{
+    if (!opts.dumpLayout) {
+        return hexWidth(bytes);
+    }
+    // 8位偏移 + 2空格 + 补齐到整行宽度的十六进制列 + "  |" + ASCII列 + "|"
+    return 8 + 2 + hexWidth(effectiveBytesPerLine()) + 3 + bytes + 1;
+}
+
+char16_t *HexFormatter::writeLine(const uchar *data, qint64 bytes, qint64 offset, char16_t *out) const
+{
+    if (!opts.dumpLayout) {
+        return writeHex(data, bytes, out);
+    }
+    
+    const char16_t *digits = opts.upperCase ? UPPER_DIGITS : LOWER_DIGITS;
+    const quint32 value = static_cast<quint32>(offset);
+    for (int shift = 28; shift >= 0; shift -= 4) {
+        *out++ = digits[(value >> shift) & 0x0F];
+    }
+    *out++ = u' ';
+    *out++ = u' ';
+    
+    // 最后一行不足整行时补空格，保持ASCII列对齐
+    const char16_t *hexEnd = out + hexWidth(effectiveBytesPerLine());
+    out = writeHex(data, bytes, out);
+    while (out < hexEnd) {
+        *out++ = u' ';
+    }
+    
+    *out++ = u' ';
+    *out++ = u' ';
+    *out++ = u'|';
+    for (qint64 i = 0; i < bytes; ++i) {
+        const uchar byte = data[i];
+        *out++ = (byte >= 0x20 && byte < 0x7F) ? char16_t(byte) : u'.';
+    }
+    *out++ = u'|';
+    return out;
+}
+
+char16_t *HexFormatter::writeHex(const uchar *data, qint64 bytes, char16_t *out) const
+{
+    const bool grouped = opts.groupSize > 0 && !opts.separator.isNull();
+    if (!grouped) {
+        toHex(data, bytes, out, opts.upperCase);
+        return out + 2 * bytes;
+    }
+    
+    // 分批连续转换到栈上缓冲区，再按组拷贝并插入分隔符
+    const char16_t separator = opts.separator.unicode();
+    const int group = opts.groupSize;
+    char16_t dense[2 * HEX_CHUNK];
+    int inGroup = 0;
+    for (qint64 done = 0; done < bytes;) {
+        const int count = static_cast<int>(qMin<qint64>(HEX_CHUNK, bytes - done));
+        toHex(data + done, count, dense, opts.upperCase);
+        const char16_t *src = dense;
+        if (group == 1) {
+            for (int i = 0; i < count; ++i) {
+                if (inGroup) {
+                    *out++ = separator;
+                }
+                inGroup = 1;
+                out[0] = src[0];
+                out[1] = src[1];
+                out += 2;
+                src += 2;
+            }
+        } else {
+            for (int i = 0; i < count;) {
+                if (inGroup == group) {
+                    *out++ = separator;
+                    inGroup = 0;
+                }
+                const int take = qMin(group - inGroup, count - i);
+                std::memcpy(out, src, static_cast<size_t>(take) * 2 * sizeof(char16_t));
+                out += 2 * take;
+                src += 2 * take;
+                i += take;
+                inGroup += take;
+            }
+        }
+        done += count;
+    }
+    return out;
+}
\ No newline at end of file
@@ -0,0 +1,60 @@
+#ifndef HEXFORMATTER_H
+#define HEXFORMATTER_H
+
+#include <QByteArray>
+#include <QChar>
+#include <QString>
+#include <QStringList>
+
+// 十六进制显示格式
+struct HexFormatOptions
+{
+    bool upperCase = true;
+    int groupSize = 1;           // 每组字节数，组之间插入分隔符；0 表示不分组
+    QChar separator = QLatin1Char(' ');
+    int bytesPerLine = 0;        // 每行字节数；0 表示不换行（经典布局下默认16）
+    bool dumpLayout = false;     // 经典布局：偏移 | 十六进制 | ASCII
+};
+
+// 十六进制格式化引擎
+// 按输出长度一次性分配 QString，再用半字节查找表直接写入 UTF-16 缓冲区，
+// 每个字节没有任何临时对象。支持 AVX2/SSE2 时按 32/16 字节一批转换，否则逐字节查表。
+class HexFormatter
+{
+public:
+    explicit HexFormatter(const HexFormatOptions &options = HexFormatOptions());
+    
+    void setOptions(const HexFormatOptions &options);
+    HexFormatOptions options() const;
+    
+    // 按当前格式输出的行数，只依赖数据长度
+    qint64 lineCount(qint64 length) const;
+    // 格式化为若干行，baseOffset 为经典布局中第一个字节的偏移
+    QStringList formatLines(const char *data, qint64 length, qint64 baseOffset = 0) const;
+    QStringList formatLines(const QByteArray &data, qint64 baseOffset = 0) const
+    {
+        return formatLines(data.constData(), data.size(), baseOffset);
+    }
+    // 格式化为一个字符串，多行之间以 '\n' 分隔
+    QString format(const char *data, qint64 length, qint64 baseOffset = 0) const;
+    QString format(const QByteArray &data, qint64 baseOffset = 0) const
+    {
+        return format(data.constData(), data.size(), baseOffset);
+    }
+    
+    // 把 length 个字节转换成 2*length 个连续的十六进制字符（不加分隔符）
+    static void toHex(const uchar *data, qint64 length, char16_t *out, bool upperCase = true);
+    // 当前CPU上实际使用的转换路径："AVX2"、"SSE2" 或 "scalar"
+    static const char *backend();
+
+private:
+    int effectiveBytesPerLine() const;
+    qint64 hexWidth(qint64 bytes) const;
+    qint64 lineLength(qint64 bytes) const;
+    char16_t *writeLine(const uchar *data, qint64 bytes, qint64 offset, char16_t *out) const;
+    char16_t *writeHex(const uchar *data, qint64 bytes, char16_t *out) const;
+    
+    HexFormatOptions opts;
+};
+
+#endif // HEXFORMATTER_H
\ No newline at end of file
@@ -0,0 +1,145 @@
+#include "hexparser.h"
+
+// ASCII 字符到十六进制数值的查找表，非十六进制字符为 -1
+static const qint8 HEX_VALUE[128] = {
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+     0,  1,  2,  3,  4,  5,  6,  7,  8,  9, -1, -1, -1, -1, -1, -1,
+    -1, 10, 11, 12, 13, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, 10, 11, 12, 13, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+};
+
+static inline int hexValue(char16_t c)
+{
+    return c < 128 ? HEX_VALUE[c] : -1;
+}
+
+// 字节之间允许的分隔符
+static inline bool isSeparator(char16_t c)
+{
+    switch (c) {
+    case u' ':
+    case u'\t':
+    case u'\r':
+    case u'\n':
+    case u',':
+    case u';':
+    case u':':
+    case u'-':
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool HexParser::parse(const QChar *text, qsizetype length, QByteArray *out, qsizetype *errorOffset)
+{
+    const char16_t *p = reinterpret_cast<const char16_t *>(text);
+    
+    // 每个字节至少占一个字符，按上限一次性分配，结束时截断到实际长度
+    const qsizetype base = out->size();
+    out->resize(base + length / 2 + 1);
+    char *dst = out->data() + base;
+    
+    auto fail = [&](qsizetype offset) {
+        out->resize(base);
+        if (errorOffset) {
+            *errorOffset = offset;
+        }
+        return false;
+    };
+    
+    qsizetype i = 0;
+    while (i < length) {
+        const char16_t c = p[i];
+        if (isSeparator(c)) {
+            ++i;
+            continue;
+        }
+        
+        // 可选的 0x / \x 前缀，前缀后必须紧跟十六进制数字
+        if ((c == u'0' || c == u'\\') && i + 1 < length && (p[i + 1] == u'x' || p[i + 1] == u'X')) {
+            i += 2;
+            if (i >= length || hexValue(p[i]) < 0) {
+                return fail(i);
+            }
+        }
+        
+        const qsizetype start = i;
+        int high = hexValue(p[i]);
+        if (high < 0) {
+            return fail(i);
+        }
+        
+        // 连续数字两位一组直接写出
+        for (;;) {
+            const int low = i + 1 < length ? hexValue(p[i + 1]) : -1;
+            if (low < 0) {
+                break;
+            }
+            *dst++ = static_cast<char>((high << 4) | low);
+            i += 2;
+            high = i < length ? hexValue(p[i]) : -1;
+            if (high < 0) {
+                break;
+            }
+        }
+        
+        if (high >= 0) {
+            // 剩下一位数字：只有整个数字串就这一位时才合法
+            if (i != start) {
+                return fail(i);
+            }
+            *dst++ = static_cast<char>(high);
+            ++i;
+        }
+        
+        // 数字串之后只能是分隔符、下一个 \x 前缀或文本结束
+        if (i < length && !isSeparator(p[i]) && p[i] != u'\\') {
+            return fail(i);
+        }
+    }
+    
+    out->resize(dst - out->constData());
+    return true;
+}
+
+bool HexParser::parseEscaped(const QString &text, QByteArray *out)
+{
+    out->clear();
+    const QByteArray bytes = text.toUtf8();
+    for (qsizetype i = 0; i < bytes.size(); ++i) {
+        const char c = bytes.at(i);
+        if (c != '\\') {
+            out->append(c);
+            continue;
+        }
+        if (++i >= bytes.size()) {
+            return false;
+        }
+        switch (bytes.at(i)) {
+        case 'r': out->append('\r'); break;
+        case 'n': out->append('\n'); break;
+        case 't': out->append('\t'); break;
+        case '0': out->append('\0'); break;
+        case '\\': out->append('\\'); break;
+        case 'x':
+        case 'X': {
+            const int high = i + 1 < bytes.size() ? hexValue(static_cast<uchar>(bytes.at(i + 1))) : -1;
+            const int low = i + 2 < bytes.size() ? hexValue(static_cast<uchar>(bytes.at(i + 2))) : -1;
+            if (high < 0 || low < 0) {
+                return false;
+            }
+            out->append(static_cast<char>(high << 4 | low));
+            i += 2;
+            break;
+        }
+        default:
+            return false;
+        }
+    }
+    return true;
+}
\ No newline at end of file
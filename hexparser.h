@@ -0,0 +1,29 @@
+#ifndef HEXPARSER_H
+#define HEXPARSER_H
+
+#include <QByteArray>
+#include <QChar>
+#include <QString>
+
+// 十六进制文本解析
+// 一次遍历 UTF-16 文本，直接写入预先分配好的 QByteArray，不产生中间字符串。
+// 支持的写法：
+//   AA BB CC / AABBCC / AA,BB;CC / AA:BB-CC
+//   0xAA 0xBB / 0xAA,0xBB / \xAA\xBB
+// 连续的十六进制数字按两位一组，单独的一位数字（如 "A"）解析为一个字节；
+// 除一位数字外，奇数位的连续数字视为错误。
+class HexParser
+{
+public:
+    // 解析结果追加到 out；失败时返回 false，errorOffset 为第一个无效字符在文本中的位置
+    static bool parse(const QChar *text, qsizetype length, QByteArray *out, qsizetype *errorOffset = nullptr);
+    static bool parse(const QString &text, QByteArray *out, qsizetype *errorOffset = nullptr)
+    {
+        return parse(text.constData(), text.size(), out, errorOffset);
+    }
+    // 带转义的文本：普通字符按 UTF-8 编码，支持 \r \n \t \0 \\ 和 \xHH；
+    // 结果替换 out 的内容，转义无效时返回 false
+    static bool parseEscaped(const QString &text, QByteArray *out);
+};
+
+#endif // HEXPARSER_H
\ No newline at end of file
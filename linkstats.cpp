@@ -0,0 +1,177 @@
+#include "linkstats.h"
+
+// 时间片长度（纳秒）
+static const qint64 BUCKET_NS = 100 * 1000 * 1000;
+// 1 秒和 10 秒窗口包含的时间片数
+static const int SHORT_WINDOW = 10;
+static const int LONG_WINDOW = 100;
+
+void LinkStats::Rate::merge(const Rate &other)
+{
+    total += other.total;
+    current += other.current;
+    average += other.average;
+    peak = qMax(peak, other.peak);
+}
+
+void LinkStats::Snapshot::merge(const Snapshot &other)
+{
+    rxBytes.merge(other.rxBytes);
+    txBytes.merge(other.txBytes);
+    frames.merge(other.frames);
+    reads.merge(other.reads);
+    frameErrors += other.frameErrors;
+    checksumErrors += other.checksumErrors;
+    for (int i = 0; i < HISTOGRAM_BUCKETS; ++i) {
+        gaps[i] += other.gaps[i];
+    }
+    for (int i = 0; i < ERROR_KINDS; ++i) {
+        errors[i] += other.errors[i];
+    }
+}
+
+LinkStats::Window::Window()
+{
+    reset();
+}
+
+void LinkStats::Window::add(qint64 timestamp, qint64 value)
+{
+    // 时间略有倒退（如帧时间取首字节时刻）时计入当前片
+    const qint64 tick = qMax(timestamp / BUCKET_NS, currentTick.load(std::memory_order_relaxed));
+    const int slot = static_cast<int>(tick % SLOTS);
+    if (ticks[slot].load(std::memory_order_relaxed) != tick) {
+        // 进入新的时间片：用刚结束的 1 秒更新峰值，再清零本片
+        const qint64 last = currentTick.load(std::memory_order_relaxed);
+        if (last > 0 && tick > last) {
+            const qint64 second = sum(last, SHORT_WINDOW);
+            if (second > peak.load(std::memory_order_relaxed)) {
+                peak.store(second, std::memory_order_relaxed);
+            }
+        }
+        values[slot].store(0, std::memory_order_relaxed);
+        ticks[slot].store(tick, std::memory_order_release);
+        currentTick.store(tick, std::memory_order_relaxed);
+    }
+    values[slot].fetch_add(value, std::memory_order_relaxed);
+    total.fetch_add(value, std::memory_order_relaxed);
+}
+
+LinkStats::Rate LinkStats::Window::rate(qint64 now) const
+{
+    // 只统计已结束的时间片，结果滞后不超过 100ms 但不受当前片未满的影响
+    const qint64 last = now / BUCKET_NS - 1;
+    Rate result;
+    result.total = total.load(std::memory_order_relaxed);
+    result.current = static_cast<double>(sum(last, SHORT_WINDOW)) * 1e9 / (SHORT_WINDOW * BUCKET_NS);
+    result.average = static_cast<double>(sum(last, LONG_WINDOW)) * 1e9 / (LONG_WINDOW * BUCKET_NS);
+    result.peak = qMax(static_cast<double>(peak.load(std::memory_order_relaxed)), result.current);
+    return result;
+}
+
+void LinkStats::Window::reset()
+{
+    for (int i = 0; i < SLOTS; ++i) {
+        values[i].store(0, std::memory_order_relaxed);
+        ticks[i].store(-1, std::memory_order_relaxed);
+    }
+    currentTick.store(0, std::memory_order_relaxed);
+    total.store(0, std::memory_order_relaxed);
+    peak.store(0, std::memory_order_relaxed);
+}
+
+qint64 LinkStats::Window::sum(qint64 lastTick, int count) const
+{
+    qint64 result = 0;
+    for (qint64 tick = lastTick - count + 1; tick <= lastTick; ++tick) {
+        const int slot = static_cast<int>(((tick % SLOTS) + SLOTS) % SLOTS);
+        if (ticks[slot].load(std::memory_order_acquire) == tick) {
+            result += values[slot].load(std::memory_order_relaxed);
+        }
+    }
+    return result;
+}
+
+LinkStats::LinkStats()
+{
+    reset();
+}
+
+int LinkStats::histogramBucket(qint64 micros)
+{
+    int bucket = 0;
+    for (quint64 value = static_cast<quint64>(qMax<qint64>(0, micros)); value > 0 && bucket < HISTOGRAM_BUCKETS - 1; value >>= 1) {
+        ++bucket;
+    }
+    return bucket;
+}
+
+void LinkStats::addRead(qint64 timestamp, qint64 bytes)
+{
+    rxWindow.add(timestamp, bytes);
+    readWindow.add(timestamp, 1);
+    
+    // 两次读取之间的间隔按 2 的幂分格
+    const qint64 previous = lastRead.exchange(timestamp, std::memory_order_relaxed);
+    if (previous > 0 && timestamp >= previous) {
+        gaps[histogramBucket((timestamp - previous) / 1000)].fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void LinkStats::addWrite(qint64 timestamp, qint64 bytes)
+{
+    txWindow.add(timestamp, bytes);
+}
+
+void LinkStats::addError(int error)
+{
+    if (error > 0 && error < ERROR_KINDS) {
+        errors[error].fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void LinkStats::addFrame(qint64 timestamp, bool error, bool checksumError)
+{
+    frameWindow.add(timestamp, 1);
+    if (error) {
+        frameErrors.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (checksumError) {
+        checksumErrors.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+LinkStats::Snapshot LinkStats::snapshot(qint64 now) const
+{
+    Snapshot result;
+    result.rxBytes = rxWindow.rate(now);
+    result.txBytes = txWindow.rate(now);
+    result.frames = frameWindow.rate(now);
+    result.reads = readWindow.rate(now);
+    result.frameErrors = frameErrors.load(std::memory_order_relaxed);
+    result.checksumErrors = checksumErrors.load(std::memory_order_relaxed);
+    for (int i = 0; i < HISTOGRAM_BUCKETS; ++i) {
+        result.gaps[i] = gaps[i].load(std::memory_order_relaxed);
+    }
+    for (int i = 0; i < ERROR_KINDS; ++i) {
+        result.errors[i] = errors[i].load(std::memory_order_relaxed);
+    }
+    return result;
+}
+
+void LinkStats::reset()
+{
+    rxWindow.reset();
+    txWindow.reset();
+    frameWindow.reset();
+    readWindow.reset();
+    frameErrors.store(0, std::memory_order_relaxed);
+    checksumErrors.store(0, std::memory_order_relaxed);
+    lastRead.store(0, std::memory_order_relaxed);
+    for (int i = 0; i < HISTOGRAM_BUCKETS; ++i) {
+        gaps[i].store(0, std::memory_order_relaxed);
+    }
+    for (int i = 0; i < ERROR_KINDS; ++i) {
+        errors[i].store(0, std::memory_order_relaxed);
+    }
+}
\ No newline at end of file
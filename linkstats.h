@@ -0,0 +1,96 @@
+#ifndef LINKSTATS_H
+#define LINKSTATS_H
+
+#include <QtGlobal>
+#include <atomic>
+
+// 串口链路统计
+// 收发字节数、帧数、读取次数按 100ms 时间片计入滑动窗口，另有读取间隔直方图和串口错误计数。
+// 每个计数器只有一个写入线程（收发和错误在I/O线程，分帧在GUI线程），写入只是几次无锁原子加，
+// 全速收发时也可以一直开着；界面定时调用 snapshot 读取。
+class LinkStats
+{
+public:
+    // 读取间隔直方图：第 i 格为 [2^(i-1), 2^i) 微秒，第 0 格为不足 1 微秒，最后一格含更长的间隔
+    static const int HISTOGRAM_BUCKETS = 24;
+    // 错误计数按 QSerialPort::SerialPortError 的取值分类
+    static const int ERROR_KINDS = 16;
+    
+    // 一个计数的总量、最近 1 秒和 10 秒的速率（每秒）以及 1 秒速率的峰值
+    struct Rate
+    {
+        qint64 total = 0;
+        double current = 0.0;
+        double average = 0.0;
+        double peak = 0.0;
+        
+        void merge(const Rate &other);
+    };
+    
+    struct Snapshot
+    {
+        Rate rxBytes;
+        Rate txBytes;
+        Rate frames;
+        Rate reads;
+        qint64 frameErrors = 0;
+        qint64 checksumErrors = 0;
+        qint64 gaps[HISTOGRAM_BUCKETS] = {};
+        qint64 errors[ERROR_KINDS] = {};
+        
+        // 合并多个会话的统计：总量和速率相加，峰值取最大
+        void merge(const Snapshot &other);
+    };
+    
+    LinkStats();
+    
+    // 微秒数所在的直方图格，回放时刻误差也按同样的格统计
+    static int histogramBucket(qint64 micros);
+    
+    LinkStats(const LinkStats &) = delete;
+    LinkStats &operator=(const LinkStats &) = delete;
+    
+    // 以下在I/O线程中调用
+    void addRead(qint64 timestamp, qint64 bytes);
+    void addWrite(qint64 timestamp, qint64 bytes);
+    void addError(int error);
+    // 在GUI线程中调用，每输出一帧调用一次
+    void addFrame(qint64 timestamp, bool error, bool checksumError = false);
+    
+    Snapshot snapshot(qint64 now) const;
+    // 清零，只应在界面清空计数时调用，与写入同时进行时可能漏掉个别计数
+    void reset();
+
+private:
+    // 单写入者的滑动窗口：环形排列的 100ms 时间片，每片记下所属的时间片序号，过期的片在写入时清零
+    class Window
+    {
+    public:
+        Window();
+        void add(qint64 timestamp, qint64 value);
+        Rate rate(qint64 now) const;
+        void reset();
+    
+    private:
+        qint64 sum(qint64 lastTick, int count) const;
+        
+        static const int SLOTS = 128;
+        std::atomic<qint64> values[SLOTS];
+        std::atomic<qint64> ticks[SLOTS];
+        std::atomic<qint64> currentTick;
+        std::atomic<qint64> total;
+        std::atomic<qint64> peak;
+    };
+    
+    Window rxWindow;
+    Window txWindow;
+    Window frameWindow;
+    Window readWindow;
+    std::atomic<qint64> frameErrors;
+    std::atomic<qint64> checksumErrors;
+    std::atomic<qint64> lastRead;
+    std::atomic<qint64> gaps[HISTOGRAM_BUCKETS];
+    std::atomic<qint64> errors[ERROR_KINDS];
+};
+
+#endif // LINKSTATS_H
\ No newline at end of file
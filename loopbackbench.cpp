@@ -0,0 +1,527 @@
+// loopbackbench.cpp - 伪终端回环基准测试
+// 用 openpty 创建的伪终端对代替真实串口：Session 打开从端，测试线程读写主端，
+// 按设定的速率和块大小驱动真实的收发路径（SerialWorker、环形缓冲区、RenderScheduler、ChunkStore），
+// 每组参数输出一行 JSON，便于在不同版本之间比较吞吐量、丢失字节、CPU时间和端到端延迟。
+// 同时统计预热之后被测路径（I/O线程和 Session::readData）的堆分配次数，接收路径稳态下应为0，
+// 只剩每帧至多一次的 rxReady 跨线程通知（Qt 的排队事件对象），与数据速率无关。
+
+#include "allocationcounter.h"
+#include "renderscheduler.h"
+#include "session.h"
+#include "spscringbuffer.h"
+#include "timestamp.h"
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTimer>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <pty.h>
+#include <sys/resource.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+static const qint64 NS_PER_US = 1000;
+static const qint64 NS_PER_SECOND = 1000 * 1000 * 1000;
+// 发送测试不限速时最多在途的字节数，避免把全部数据堆在串口的发送缓冲区中
+static const qint64 MAX_IN_FLIGHT = 64 * 1024;
+// 测试结束后等待剩余数据到达的时间
+static const int DRAIN_TIMEOUT_MS = 1000;
+// 预热时间：数据块、索引和 Qt 内部缓冲区在此期间扩容到稳定大小，之后才统计分配次数
+static const int WARMUP_MS = 1000;
+// 每块数据的发出时刻，随字节流从发送方传给接收方
+static const qint64 MARK_CAPACITY = 1 << 16;
+
+// 测试数据：每个位置的字节值由偏移决定，接收方据此检查数据是否错位或损坏
+static inline char patternByte(quint64 offset)
+{
+    return static_cast<char>((offset * 7 + (offset >> 11)) & 0xFF);
+}
+
+static void fillPattern(char *data, qint64 length, quint64 offset)
+{
+    for (qint64 i = 0; i < length; ++i) {
+        data[i] = patternByte(offset + static_cast<quint64>(i));
+    }
+}
+
+static qint64 countCorrupt(const char *data, qint64 length, quint64 offset)
+{
+    qint64 corrupt = 0;
+    for (qint64 i = 0; i < length; ++i) {
+        corrupt += data[i] != patternByte(offset + static_cast<quint64>(i));
+    }
+    return corrupt;
+}
+
+// 进程或当前线程已用的CPU时间（纳秒）
+static qint64 cpuTime(int who)
+{
+    rusage usage;
+    getrusage(who, &usage);
+    return (static_cast<qint64>(usage.ru_utime.tv_sec) + usage.ru_stime.tv_sec) * NS_PER_SECOND
+        + (static_cast<qint64>(usage.ru_utime.tv_usec) + usage.ru_stime.tv_usec) * NS_PER_US;
+}
+
+static void sleepUntil(qint64 deadline)
+{
+    const qint64 now = TimestampClock::now();
+    if (deadline > now) {
+        const qint64 wait = deadline - now;
+        timespec ts = {static_cast<time_t>(wait / NS_PER_SECOND), static_cast<long>(wait % NS_PER_SECOND)};
+        nanosleep(&ts, nullptr);
+    }
+}
+
+// 延迟分位数（微秒）
+static QJsonObject latencyObject(std::vector<qint64> *samples)
+{
+    QJsonObject object;
+    object["samples"] = static_cast<qint64>(samples->size());
+    if (samples->empty()) {
+        return object;
+    }
+    std::sort(samples->begin(), samples->end());
+    const auto percentile = [samples](double p) {
+        const size_t index = std::min(samples->size() - 1, static_cast<size_t>(p * static_cast<double>(samples->size())));
+        return static_cast<double>((*samples)[index]) / NS_PER_US;
+    };
+    object["p50"] = percentile(0.50);
+    object["p90"] = percentile(0.90);
+    object["p99"] = percentile(0.99);
+    object["p999"] = percentile(0.999);
+    object["max"] = static_cast<double>(samples->back()) / NS_PER_US;
+    return object;
+}
+
+struct BenchConfig
+{
+    bool receive = true;        // true：主端写、会话接收；false：会话发送、主端读
+    qint64 rate = 0;            // 字节/秒，0 为不限速
+    qint64 chunk = 64;          // 每次写入的字节数
+    double duration = 5.0;      // 秒
+    int frameRate = 30;         // 会话取数据的帧率，与界面刷新相同
+    qint32 baudRate = 115200;   // 伪终端忽略波特率，仅传给串口设置
+};
+
+// 一次测试的过程和结果
+class LoopbackBench
+{
+public:
+    explicit LoopbackBench(const BenchConfig &config);
+    ~LoopbackBench();
+    
+    bool run(QString *errorString);
+    QJsonObject result();
+
+private:
+    void drain();
+    void writeMaster();
+    void readMaster();
+    void sendChunks();
+    bool writeAll(const char *data, qint64 length);
+    
+    BenchConfig config;
+    int master;
+    int slave;
+    Session session;
+    RenderScheduler scheduler;
+    SpscQueue<RxMark> marks;            // 每块数据末尾的位置和发出时刻
+    std::atomic<bool> finished;
+    std::atomic<qint64> sentBytes;      // 发送方已写出
+    std::atomic<qint64> receivedBytes;  // 接收方已收到
+    qint64 corruptBytes;
+    qint64 harnessCpu;                  // 测试线程自身的CPU时间，不计入被测路径
+    qint64 pipelineCpu;                 // 被测路径的CPU时间：进程总CPU时间减去测试线程
+    qint64 startTime;
+    qint64 endTime;
+    qint64 steadyTime;                  // 预热结束的时刻
+    qint64 steadyAllocations;           // 预热结束时的分配计数，结束时改为稳态期间的分配次数
+    qint64 steadyAllocatedBytes;
+    std::vector<qint64> latencies;
+    QByteArray chunkData;
+};
+
+LoopbackBench::LoopbackBench(const BenchConfig &config)
+    : config(config)
+    , master(-1)
+    , slave(-1)
+    , marks(MARK_CAPACITY)
+    , finished(false)
+    , sentBytes(0)
+    , receivedBytes(0)
+    , corruptBytes(0)
+    , harnessCpu(0)
+    , pipelineCpu(0)
+    , startTime(0)
+    , endTime(0)
+    , steadyTime(0)
+    , steadyAllocations(0)
+    , steadyAllocatedBytes(0)
+{
+    scheduler.setFrameRate(config.frameRate);
+    QObject::connect(&session, &Session::updateRequested, &scheduler, &RenderScheduler::requestFrame);
+    QObject::connect(&scheduler, &RenderScheduler::frame, [this]() { drain(); });
+}
+
+LoopbackBench::~LoopbackBench()
+{
+    session.close();
+    if (master >= 0) {
+        ::close(master);
+    }
+    if (slave >= 0) {
+        ::close(slave);
+    }
+}
+
+bool LoopbackBench::run(QString *errorString)
+{
+    char name[256];
+    if (openpty(&master, &slave, name, nullptr, nullptr) != 0) {
+        *errorString = QString("openpty 失败：%1").arg(strerror(errno));
+        return false;
+    }
+    // 主端也设为原始模式，数据不经行规程转换；非阻塞以便随时响应结束
+    termios attributes;
+    tcgetattr(master, &attributes);
+    cfmakeraw(&attributes);
+    tcsetattr(master, TCSANOW, &attributes);
+    fcntl(master, F_SETFL, fcntl(master, F_GETFL) | O_NONBLOCK);
+    
+    SerialConfig portConfig;
+    portConfig.portName = QString::fromLocal8Bit(name);
+    portConfig.baudRate = config.baudRate;
+    QEventLoop loop;
+    QString openError;
+    QObject::connect(&session, &Session::opened, &loop, &QEventLoop::quit);
+    QObject::connect(&session, &Session::openFailed, &loop, [&loop, &openError](const QString &error) {
+        openError = error;
+        loop.quit();
+    });
+    session.open(portConfig);
+    loop.exec();
+    if (!session.isOpen()) {
+        *errorString = QString("无法打开 %1：%2").arg(portConfig.portName, openError);
+        return false;
+    }
+    
+    chunkData.resize(config.chunk);
+    latencies.reserve(static_cast<size_t>(MARK_CAPACITY));
+    const qint64 processCpu = cpuTime(RUSAGE_SELF);
+    startTime = TimestampClock::now();
+    
+    // 接收测试由测试线程写主端；发送测试由本线程调用 Session::send，测试线程读主端
+    QTimer sendTimer;
+    std::thread harness;
+    if (config.receive) {
+        harness = std::thread([this]() { writeMaster(); });
+    } else {
+        harness = std::thread([this]() { readMaster(); });
+        sendTimer.setTimerType(Qt::PreciseTimer);
+        QObject::connect(&sendTimer, &QTimer::timeout, [this]() { sendChunks(); });
+        sendTimer.start(1);
+    }
+    
+    // 测试时间不足预热时间的两倍时，后一半作为稳态
+    const int durationMs = static_cast<int>(config.duration * 1000);
+    QTimer::singleShot(qMin(WARMUP_MS, durationMs / 2), &loop, [this]() {
+        steadyTime = TimestampClock::now();
+        steadyAllocations = AllocationCounter::count();
+        steadyAllocatedBytes = AllocationCounter::bytes();
+    });
+    QTimer::singleShot(durationMs, &loop, &QEventLoop::quit);
+    loop.exec();
+    sendTimer.stop();
+    const qint64 steadyEnd = TimestampClock::now();
+    steadyAllocations = AllocationCounter::count() - steadyAllocations;
+    steadyAllocatedBytes = AllocationCounter::bytes() - steadyAllocatedBytes;
+    steadyTime = steadyEnd - steadyTime;
+    
+    // 等待在途数据到达，超时未到的计为丢失
+    QElapsedTimer drainTimer;
+    drainTimer.start();
+    if (config.receive) {
+        finished.store(true);
+        harness.join();
+    }
+    while (receivedBytes.load() < sentBytes.load() && drainTimer.elapsed() < DRAIN_TIMEOUT_MS) {
+        QCoreApplication::processEvents(QEventLoop::AllEvents, 10);
+    }
+    if (!config.receive) {
+        finished.store(true);
+        harness.join();
+    }
+    drain();
+    
+    endTime = TimestampClock::now();
+    pipelineCpu = cpuTime(RUSAGE_SELF) - processCpu - harnessCpu;
+    return true;
+}
+
+QJsonObject LoopbackBench::result()
+{
+    const double seconds = static_cast<double>(endTime - startTime) / NS_PER_SECOND;
+    const qint64 received = receivedBytes.load();
+    QJsonObject object;
+    object["direction"] = config.receive ? "rx" : "tx";
+    object["rate"] = config.rate;
+    object["chunk"] = config.chunk;
+    object["frameRate"] = config.frameRate;
+    object["seconds"] = seconds;
+    object["sentBytes"] = sentBytes.load();
+    object["receivedBytes"] = received;
+    object["droppedBytes"] = sentBytes.load() - received;
+    object["corruptBytes"] = corruptBytes;
+    object["throughput"] = seconds > 0 ? static_cast<double>(received) / seconds : 0.0;
+    object["cpuSeconds"] = static_cast<double>(pipelineCpu) / NS_PER_SECOND;
+    object["cpuPercent"] = seconds > 0 ? 100.0 * static_cast<double>(pipelineCpu) / NS_PER_SECOND / seconds : 0.0;
+    object["latencyUs"] = latencyObject(&latencies);
+    // 稳态期间被测路径的堆分配
+    const double steadySeconds = static_cast<double>(steadyTime) / NS_PER_SECOND;
+    object["allocations"] = steadyAllocations;
+    object["allocatedBytes"] = steadyAllocatedBytes;
+    object["allocationsPerSecond"] = steadySeconds > 0 ? static_cast<double>(steadyAllocations) / steadySeconds : 0.0;
+    return object;
+}
+
+void LoopbackBench::drain()
+{
+    // 与界面相同：每帧把会话积累的数据取到接收存储；检查后清空，长时间运行内存不增长
+    // 只有 readData 属于被测路径，之后的校验和清空不计分配
+    {
+        AllocationCounter::Scope counting(true);
+        session.readData();
+    }
+    ChunkStore *store = session.store();
+    const qint64 count = store->recordCount();
+    for (qint64 i = 0; i < count; ++i) {
+        const Record record = store->record(i);
+        if (!config.receive || record.direction != RecordDirection::Rx) {
+            continue;
+        }
+        const qint64 offset = receivedBytes.load(std::memory_order_relaxed);
+        corruptBytes += countCorrupt(record.data.constData(), record.data.size(), static_cast<quint64>(offset));
+        receivedBytes.store(offset + record.data.size(), std::memory_order_relaxed);
+    }
+    store->clear();
+    
+    if (config.receive) {
+        // 端到端延迟：主端写出到数据进入接收存储
+        const qint64 now = TimestampClock::now();
+        const quint64 received = static_cast<quint64>(receivedBytes.load(std::memory_order_relaxed));
+        RxMark mark;
+        while (marks.peek(&mark) && mark.position <= received) {
+            latencies.push_back(now - mark.timestamp);
+            marks.pop();
+        }
+    }
+}
+
+bool LoopbackBench::writeAll(const char *data, qint64 length)
+{
+    while (length > 0) {
+        const ssize_t written = ::write(master, data, static_cast<size_t>(length));
+        if (written > 0) {
+            data += written;
+            length -= written;
+            continue;
+        }
+        if (written < 0 && errno != EAGAIN && errno != EINTR) {
+            return false;
+        }
+        // 伪终端缓冲区满：接收方跟不上，等待可写
+        if (finished.load()) {
+            return false;
+        }
+        pollfd fd = {master, POLLOUT, 0};
+        poll(&fd, 1, 10);
+    }
+    return true;
+}
+
+void LoopbackBench::writeMaster()
+{
+    AllocationCounter::setThreadEnabled(false);
+    const qint64 threadCpu = cpuTime(RUSAGE_THREAD);
+    qint64 sent = 0;
+    while (!finished.load()) {
+        if (config.rate > 0) {
+            // 按绝对时刻限速：第 sent 字节应在 start + sent / rate 时写出，不累积误差
+            sleepUntil(startTime + (sent + config.chunk) * NS_PER_SECOND / config.rate);
+            if (finished.load()) {
+                break;
+            }
+        }
+        // 不限速时由伪终端缓冲区和会话的环形缓冲区反压
+        fillPattern(chunkData.data(), config.chunk, static_cast<quint64>(sent));
+        const qint64 stamp = TimestampClock::now();
+        if (!writeAll(chunkData.constData(), config.chunk)) {
+            break;
+        }
+        sent += config.chunk;
+        sentBytes.store(sent);
+        // 队列满时只少一个延迟样本，不影响数据
+        RxMark mark;
+        mark.position = static_cast<quint64>(sent);
+        mark.timestamp = stamp;
+        marks.push(mark);
+    }
+    harnessCpu = cpuTime(RUSAGE_THREAD) - threadCpu;
+}
+
+void LoopbackBench::readMaster()
+{
+    AllocationCounter::setThreadEnabled(false);
+    const qint64 threadCpu = cpuTime(RUSAGE_THREAD);
+    std::vector<char> buffer(65536);
+    qint64 received = 0;
+    while (!finished.load()) {
+        const ssize_t length = ::read(master, buffer.data(), buffer.size());
+        if (length <= 0) {
+            pollfd fd = {master, POLLIN, 0};
+            poll(&fd, 1, 10);
+            continue;
+        }
+        const qint64 now = TimestampClock::now();
+        corruptBytes += countCorrupt(buffer.data(), length, static_cast<quint64>(received));
+        received += length;
+        receivedBytes.store(received);
+        // 端到端延迟：调用 Session::send 到数据从主端读出
+        RxMark mark;
+        while (marks.peek(&mark) && mark.position <= static_cast<quint64>(received)) {
+            latencies.push_back(now - mark.timestamp);
+            marks.pop();
+        }
+    }
+    harnessCpu = cpuTime(RUSAGE_THREAD) - threadCpu;
+}
+
+void LoopbackBench::sendChunks()
+{
+    // 每毫秒补发到期的数据块，与自动发送一样由主线程交给I/O线程
+    const qint64 now = TimestampClock::now();
+    qint64 sent = sentBytes.load();
+    for (;;) {
+        if (config.rate > 0) {
+            if (startTime + (sent + config.chunk) * NS_PER_SECOND / config.rate > now) {
+                break;
+            }
+        } else if (sent - receivedBytes.load() > MAX_IN_FLIGHT) {
+            break;
+        }
+        fillPattern(chunkData.data(), config.chunk, static_cast<quint64>(sent));
+        RxMark mark;
+        mark.position = static_cast<quint64>(sent + config.chunk);
+        mark.timestamp = TimestampClock::now();
+        if (!marks.push(mark)) {
+            // 样本队列满说明读端严重落后，本轮不再发送
+            break;
+        }
+        session.send(chunkData);
+        sent += config.chunk;
+        sentBytes.store(sent);
+    }
+}
+
+// 解析逗号分隔的数值列表，如 "115200,1000000,0"
+static bool parseList(const QString &text, QVector<qint64> *values)
+{
+    values->clear();
+    for (const QString &item : text.split(',', Qt::SkipEmptyParts)) {
+        bool ok = false;
+        const qint64 value = item.trimmed().toLongLong(&ok);
+        if (!ok || value < 0) {
+            return false;
+        }
+        values->append(value);
+    }
+    return !values->isEmpty();
+}
+
+int main(int argc, char *argv[])
+{
+    // 主线程只在 Session::readData 期间计数，I/O线程全程计数
+    AllocationCounter::setThreadEnabled(false);
+    QCoreApplication app(argc, argv);
+    
+    QCommandLineParser parser;
+    parser.setApplicationDescription("伪终端回环基准测试：每组参数输出一行 JSON");
+    parser.addHelpOption();
+    const QCommandLineOption directionOption("direction", "测试方向 rx|tx|both（默认 rx）", "direction", "rx");
+    const QCommandLineOption rateOption("rate", "速率（字节/秒，0 为不限速），可用逗号分隔多个值", "rates", "11520,115200,1000000,0");
+    const QCommandLineOption chunkOption("chunk", "每次写入的字节数，可用逗号分隔多个值", "sizes", "1,64,4096");
+    const QCommandLineOption durationOption("duration", "每组测试的秒数（默认 3）", "seconds", "3");
+    const QCommandLineOption fpsOption("fps", "会话取数据的帧率（默认 30）", "fps", "30");
+    const QCommandLineOption outputOption(QStringList() << "o" << "output", "结果追加到文件，而不是标准输出", "file");
+    parser.addOptions({directionOption, rateOption, chunkOption, durationOption, fpsOption, outputOption});
+    parser.process(app);
+    
+    QVector<qint64> rates;
+    QVector<qint64> chunks;
+    bool ok = false;
+    BenchConfig base;
+    base.duration = parser.value(durationOption).toDouble(&ok);
+    base.frameRate = parser.value(fpsOption).toInt();
+    const QString direction = parser.value(directionOption);
+    if (!parseList(parser.value(rateOption), &rates) || !parseList(parser.value(chunkOption), &chunks)
+        || chunks.contains(0) || !ok || base.duration <= 0 || base.frameRate <= 0
+        || (direction != "rx" && direction != "tx" && direction != "both")) {
+        std::fprintf(stderr, "参数错误\n");
+        parser.showHelp(1);
+    }
+    
+    QFile output;
+    if (parser.isSet(outputOption)) {
+        output.setFileName(parser.value(outputOption));
+        if (!output.open(QIODevice::WriteOnly | QIODevice::Append)) {
+            std::fprintf(stderr, "无法打开 %s：%s\n", qPrintable(output.fileName()), qPrintable(output.errorString()));
+            return 1;
+        }
+    } else {
+        output.open(stdout, QIODevice::WriteOnly);
+    }
+    
+    QVector<bool> directions;
+    if (direction != "tx") {
+        directions.append(true);
+    }
+    if (direction != "rx") {
+        directions.append(false);
+    }
+    
+    int failures = 0;
+    for (bool receive : directions) {
+        for (qint64 rate : rates) {
+            for (qint64 chunk : chunks) {
+                BenchConfig config = base;
+                config.receive = receive;
+                config.rate = rate;
+                config.chunk = chunk;
+                LoopbackBench bench(config);
+                QString errorString;
+                if (!bench.run(&errorString)) {
+                    std::fprintf(stderr, "%s\n", qPrintable(errorString));
+                    ++failures;
+                    continue;
+                }
+                output.write(QJsonDocument(bench.result()).toJson(QJsonDocument::Compact) + "\n");
+                output.flush();
+            }
+        }
+    }
+    return failures > 0 ? 2 : 0;
+}
\ No newline at end of file
@@ -1,9 +1,15 @@
+#include "headless.h"
 #include "mainwindow.h"
 
 #include <QApplication>
 
 int main(int argc, char *argv[])
 {
+    // 无界面模式只创建 QCoreApplication，不初始化任何窗口部件
+    if (HeadlessRunner::requested(argc, argv)) {
+        return HeadlessRunner::run(argc, argv);
+    }
+    
     QApplication a(argc, argv);
     
     // 设置应用程序信息，用于QSettings
@@ -1,14 +1,111 @@
 #include "mainwindow.h"
-#include <QFileDialog>
+#include "hexparser.h"
 #include <QDateTime>
+#include <QFileDialog>
+#include <QFileInfo>
+#include <QFontDatabase>
+#include <QSet>
 #include <QSettings>
+#include <QTabBar>
+
+// 速率按 B/s、KB/s、MB/s 显示
+static QString formatRate(double bytesPerSecond)
+{
+    if (bytesPerSecond >= 1024 * 1024) {
+        return QString("%1 MB/s").arg(bytesPerSecond / (1024 * 1024), 0, 'f', 2);
+    }
+    if (bytesPerSecond >= 1024) {
+        return QString("%1 KB/s").arg(bytesPerSecond / 1024, 0, 'f', 1);
+    }
+    return QString("%1 B/s").arg(bytesPerSecond, 0, 'f', 0);
+}
+
+// 直方图第 index 格的区间
+static QString gapBucketName(int index)
+{
+    static const char *const units[] = {"us", "ms", "s"};
+    auto format = [](qint64 micros) {
+        int unit = 0;
+        while (micros >= 1000 && unit < 2) {
+            micros /= 1000;
+            ++unit;
+        }
+        return QString("%1%2").arg(micros).arg(units[unit]);
+    };
+    if (index == 0) {
+        return "<1us";
+    }
+    if (index == LinkStats::HISTOGRAM_BUCKETS - 1) {
+        return ">=" + format(Q_INT64_C(1) << (index - 1));
+    }
+    return format(Q_INT64_C(1) << (index - 1)) + "-" + format(Q_INT64_C(1) << index);
+}
+
+// QSerialPort::errorOccurred 报告的错误名称
+static QString serialErrorName(int error)
+{
+    switch (error) {
+    case QSerialPort::DeviceNotFoundError: return "设备不存在";
+    case QSerialPort::PermissionError: return "无权限";
+    case QSerialPort::OpenError: return "打开错误";
+    case QSerialPort::WriteError: return "写错误";
+    case QSerialPort::ReadError: return "读错误";
+    case QSerialPort::ResourceError: return "设备断开";
+    case QSerialPort::UnsupportedOperationError: return "不支持的操作";
+    case QSerialPort::TimeoutError: return "超时";
+    case QSerialPort::NotOpenError: return "未打开";
+    default: return QString("错误%1").arg(error);
+    }
+}
+
+// 每个字符在线路上占用的位数：起始位 + 数据位 + 校验位 + 停止位
+static double bitsPerCharacter(const SerialConfig &config)
+{
+    double bits = 1 + static_cast<int>(config.dataBits);
+    if (config.parity != QSerialPort::NoParity) {
+        bits += 1;
+    }
+    switch (config.stopBits) {
+    case QSerialPort::OneAndHalfStop: bits += 1.5; break;
+    case QSerialPort::TwoStop: bits += 2; break;
+    default: bits += 1; break;
+    }
+    return bits;
+}
+
+// 切换波形的数据来源时最多回溯解析的接收记录数
+static const qint64 PLOT_BACKFILL_RECORDS = 20000;
+// 每帧最多送入波形解析的记录数，积压的记录分几帧解析，界面不会卡住
+static const qint64 PLOT_RECORDS_PER_FRAME = 50000;
+
+// 回放进度和定时误差：平均、p99 和最大值
+static QString formatReplayStats(const ReplayEngine::Stats &stats)
+{
+    const auto us = [](double ns) { return QString::number(ns / 1000, 'f', 1); };
+    return QString("%1/%2 条 %3 误差 平均 %4 p99 %5 最大 %6 微秒")
+        .arg(stats.records).arg(stats.totalRecords)
+        .arg(formatRate(stats.elapsed > 0 ? stats.bytes * 1e9 / stats.elapsed : 0.0))
+        .arg(us(stats.meanError()), us(stats.errorPercentile(0.99)), us(stats.errorMax));
+}
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
-    , serial(new QSerialPort(this))
-    , autoSendTimer(new QTimer(this))
-    , sendBytes(0)
-    , receiveBytes(0)
+    , renderScheduler(new RenderScheduler(this))
+    , portWatcher(new PortWatcher(this))
+    , portsScanned(false)
+    , codecListLoaded(false)
+    , mergedSource(new MergedSource)
+    , receiveMemoryBudget(256 * 1024 * 1024)
+    , captureWriter(new CaptureWriter)
+    , captureSource(nullptr)
+    , captureIndexTimer(new QTimer(this))
+    , autoSendStatsTimer(new QTimer(this))
+    , fileSendTimer(new QTimer(this))
+    , replayTimer(new QTimer(this))
+    , statsTimer(new QTimer(this))
+    , plotSession(nullptr)
+    , plotRecord(0)
+    , triggerTimer(new QTimer(this))
 {
     setWindowTitle("Qt6 串口工具");
     setGeometry(0, 0, 800, 600);
@@ -16,42 +113,104 @@ MainWindow::MainWindow(QWidget *parent)
     // 初始化UI组件，但不连接保存设置的信号槽
     initUI();
     
-    // 连接信号槽
-    connect(serial, &QSerialPort::readyRead, this, &MainWindow::readData);
-    connect(autoSendTimer, &QTimer::timeout, this, &MainWindow::autoSendData);
+    // 连接信号槽；各会话的串口I/O在各自的线程中进行，界面只按帧率统一刷新
+    connect(renderScheduler, &RenderScheduler::frame, this, &MainWindow::renderFrame);
+    connect(captureIndexTimer, &QTimer::timeout, this, &MainWindow::updateCaptureIndexProgress);
+    connect(autoSendStatsTimer, &QTimer::timeout, this, &MainWindow::updateAutoSendStats);
+    connect(fileSendTimer, &QTimer::timeout, this, &MainWindow::updateFileSendProgress);
+    connect(replayTimer, &QTimer::timeout, this, &MainWindow::updateReplayProgress);
+    connect(statsTimer, &QTimer::timeout, this, &MainWindow::updateStatsPanel);
+    connect(triggerTimer, &QTimer::timeout, this, &MainWindow::updateTriggerStats);
     
-    // 初始化配置
-    updateSerialPorts();
-    updateCodecList();
+    // 串口列表在后台线程中枚举，窗口先显示，结果和之后的插拔变化通过 portsChanged 送回
+    connect(portWatcher, &PortWatcher::portsChanged, this, &MainWindow::updateSerialPorts);
+    portWatcher->start();
     
     // 加载设置，使用INI文件替代注册表，并指定为应用程序目录
     QString configPath = QCoreApplication::applicationDirPath() + "/config.ini";
     QSettings settings(configPath, QSettings::IniFormat);
     
-    // 设置初始状态
-    pushButton_open->setText("打开串口");
-    label_status->setText("串口未打开");
-    label_status->setStyleSheet("color: red;");
-    label_sendCount->setText("发送: 0 字节");
-    label_receiveCount->setText("接收: 0 字节");
-    
     // 应用设置（默认显示时间戳和日志模式）
     checkBox_timestamp->setChecked(settings.value("timestamp", true).toBool());
     checkBox_logMode->setChecked(settings.value("logMode", true).toBool());
     checkBox_hexReceive->setChecked(settings.value("hexReceive", false).toBool());
     checkBox_hexSend->setChecked(settings.value("hexSend", false).toBool());
+    comboBox_timestampPrecision->setCurrentIndex(qBound(0, settings.value("timestampPrecision", 1).toInt(), 2));
+    checkBox_timestampDelta->setChecked(settings.value("timestampDelta", false).toBool());
+    spinBox_renderFps->setValue(settings.value("renderFps", renderScheduler->frameRate()).toInt());
+    renderScheduler->setFrameRate(spinBox_renderFps->value());
+    
+    // 每个会话接收区的内存预算（MB），超出部分写入临时文件
+    receiveMemoryBudget = settings.value("receiveMemoryMB", 256).toLongLong() * 1024 * 1024;
+    
+    // 十六进制显示格式：每组字节数、组间分隔符（取第一个字符，为空时不分隔，空格需写作 " "）、
+    // 每行字节数（0为不换行）、经典 偏移|十六进制|ASCII 布局
+    hexFormat.groupSize = settings.value("hexGroupSize", 1).toInt();
+    const QString hexSeparator = settings.value("hexSeparator", QString(hexFormat.separator)).toString();
+    hexFormat.separator = hexSeparator.isEmpty() ? QChar() : hexSeparator.at(0);
+    hexFormat.bytesPerLine = settings.value("hexBytesPerLine", 0).toInt();
+    hexFormat.dumpLayout = settings.value("hexDumpLayout", false).toBool();
+    hexFormat.upperCase = settings.value("hexUpperCase", true).toBool();
+    updateRenderOptions();
+    
+    // 分帧方式和参数，参数无效时使用该方式的默认值
+    FramingConfig framing;
+    framing.mode = static_cast<FramingConfig::Mode>(qBound(0, settings.value("framingMode", 0).toInt(), comboBox_framing->count() - 1));
+    framing.setParameter(settings.value("framingParameter", framing.parameter()).toString());
+    comboBox_framing->setCurrentIndex(framing.mode);
+    lineEdit_framingParameter->setText(framing.parameter());
+    lineEdit_framingParameter->setEnabled(!framing.parameter().isEmpty());
+    // 校验方式，字节序和是否追加到发送数据
+    const int checksum = qBound(0, settings.value("checksumType", 0).toInt(), Checksum::TYPE_COUNT - 1);
+    framing.checksum = Checksum(static_cast<Checksum::Type>(checksum),
+                                settings.value("checksumBigEndian", Checksum::defaultBigEndian(static_cast<Checksum::Type>(checksum))).toBool());
+    comboBox_checksum->setCurrentIndex(checksum);
+    checkBox_checksumBigEndian->setChecked(framing.checksum.bigEndian());
+    checkBox_checksumBigEndian->setEnabled(framing.checksum.size() > 1);
+    checkBox_appendChecksum->setChecked(settings.value("appendChecksum", false).toBool());
+    framingConfig = framing;
+    lineEdit_bridge->setText(settings.value("bridgeAddress", lineEdit_bridge->text()).toString());
+    // 触发规则只恢复文本，启用需要手动勾选，避免一启动就自动应答
+    plainTextEdit_triggers->setPlainText(settings.value("triggerRules").toString());
+    
+    // 启动时打开一个空会话，更多串口通过"新建会话"添加
+    addSession();
     
     // 在应用初始设置后，连接保存设置的信号槽，避免初始设置被覆盖
+    connect(checkBox_timestamp, &QCheckBox::stateChanged, this, &MainWindow::updateRenderOptions);
+    connect(checkBox_logMode, &QCheckBox::stateChanged, this, &MainWindow::updateRenderOptions);
+    connect(comboBox_timestampPrecision, &QComboBox::currentIndexChanged, this, &MainWindow::updateRenderOptions);
+    connect(checkBox_timestampDelta, &QCheckBox::stateChanged, this, &MainWindow::updateRenderOptions);
     connect(checkBox_timestamp, &QCheckBox::stateChanged, this, &MainWindow::saveSettings);
     connect(checkBox_logMode, &QCheckBox::stateChanged, this, &MainWindow::saveSettings);
+    connect(comboBox_timestampPrecision, &QComboBox::currentIndexChanged, this, &MainWindow::saveSettings);
+    connect(checkBox_timestampDelta, &QCheckBox::stateChanged, this, &MainWindow::saveSettings);
     connect(checkBox_hexReceive, &QCheckBox::stateChanged, this, &MainWindow::saveSettings);
     connect(checkBox_hexSend, &QCheckBox::stateChanged, this, &MainWindow::saveSettings);
+    connect(spinBox_renderFps, &QSpinBox::valueChanged, renderScheduler, &RenderScheduler::setFrameRate);
+    connect(spinBox_renderFps, &QSpinBox::valueChanged, this, &MainWindow::saveSettings);
+    connect(comboBox_framing, &QComboBox::currentIndexChanged, this, &MainWindow::on_comboBox_framing_currentIndexChanged);
+    connect(lineEdit_framingParameter, &QLineEdit::editingFinished, this, &MainWindow::on_lineEdit_framingParameter_editingFinished);
+    connect(comboBox_checksum, &QComboBox::currentIndexChanged, this, &MainWindow::on_comboBox_checksum_currentIndexChanged);
+    connect(checkBox_checksumBigEndian, &QCheckBox::toggled, this, &MainWindow::on_checkBox_checksumBigEndian_toggled);
+    connect(checkBox_appendChecksum, &QCheckBox::toggled, this, &MainWindow::updateAutoSendPayload);
+    connect(checkBox_appendChecksum, &QCheckBox::toggled, this, &MainWindow::saveSettings);
+    connect(lineEdit_bridge, &QLineEdit::editingFinished, this, &MainWindow::saveSettings);
 }
 
 MainWindow::~MainWindow()
 {
-    delete serial;
-    delete autoSendTimer;
+    // 先关闭全部串口并停止各会话的I/O线程，显示控件随窗口销毁
+    for (const SessionPage &page : sessionPages) {
+        page.view->setStore(nullptr);
+        delete page.session;
+    }
+    mergedView->setStore(nullptr);
+    captureView->setStore(nullptr);
+    delete mergedSource;
+    // 写出剩余的录制数据和索引
+    delete captureWriter;
+    delete captureSource;
 }
 
 void MainWindow::initUI()
@@ -67,8 +226,11 @@ void MainWindow::initUI()
     
     label_portName = new QLabel("端口:", groupBox_serialConfig);
     comboBox_portName = new QComboBox(groupBox_serialConfig);
-    pushButton_refresh = new QPushButton("刷新", groupBox_serialConfig);
+    comboBox_portName->setPlaceholderText("正在查找串口…");
+    comboBox_portName->setToolTip("插入或拔出串口设备后列表自动更新");
     pushButton_open = new QPushButton("打开", groupBox_serialConfig);
+    pushButton_newSession = new QPushButton("新建会话", groupBox_serialConfig);
+    pushButton_newSession->setToolTip("添加一个串口会话，每个会话在独立的线程中收发");
     label_status = new QLabel("串口未打开", groupBox_serialConfig);
     
     label_baudRate = new QLabel("波特率:", groupBox_serialConfig);
@@ -96,12 +258,20 @@ void MainWindow::initUI()
     comboBox_flowControl->addItems({"无", "硬件流控", "软件流控"});
     comboBox_flowControl->setCurrentText("无");
     
+    label_bridge = new QLabel("桥接:", groupBox_serialConfig);
+    lineEdit_bridge = new QLineEdit("tcp:5555", groupBox_serialConfig);
+    lineEdit_bridge->setToolTip("把当前串口桥接到本机套接字，供其他程序同时使用：\n"
+                                "tcp:端口 或 tcp:地址:端口，不写地址时只监听本机；unix:路径 为本地套接字\n"
+                                "第一个连接的客户端可以发送，其余客户端只接收");
+    checkBox_bridge = new QCheckBox("启用", groupBox_serialConfig);
+    label_bridgeStatus = new QLabel(groupBox_serialConfig);
+    
     // 布局串口配置区域
     gridLayout_serialConfig->addWidget(label_portName, 0, 0);
-    gridLayout_serialConfig->addWidget(comboBox_portName, 0, 1);
-    gridLayout_serialConfig->addWidget(pushButton_refresh, 0, 2);
+    gridLayout_serialConfig->addWidget(comboBox_portName, 0, 1, 1, 2);
     gridLayout_serialConfig->addWidget(pushButton_open, 0, 3);
-    gridLayout_serialConfig->addWidget(label_status, 0, 4);
+    gridLayout_serialConfig->addWidget(pushButton_newSession, 0, 4);
+    gridLayout_serialConfig->addWidget(label_status, 0, 5);
     
     gridLayout_serialConfig->addWidget(label_baudRate, 1, 0);
     gridLayout_serialConfig->addWidget(comboBox_baudRate, 1, 1);
@@ -115,6 +285,11 @@ void MainWindow::initUI()
     gridLayout_serialConfig->addWidget(label_flowControl, 2, 2);
     gridLayout_serialConfig->addWidget(comboBox_flowControl, 2, 3);
     
+    gridLayout_serialConfig->addWidget(label_bridge, 3, 0);
+    gridLayout_serialConfig->addWidget(lineEdit_bridge, 3, 1, 1, 3);
+    gridLayout_serialConfig->addWidget(checkBox_bridge, 3, 4);
+    gridLayout_serialConfig->addWidget(label_bridgeStatus, 3, 5);
+    
     mainLayout->addWidget(groupBox_serialConfig);
     
     // 编码配置区域
@@ -122,14 +297,41 @@ void MainWindow::initUI()
     horizontalLayout_codec = new QHBoxLayout(groupBox_codecConfig);
     
     label_sendCodec = new QLabel("发送编码:", groupBox_codecConfig);
-    comboBox_sendCodec = new QComboBox(groupBox_codecConfig);
+    // 启动时只放默认编码，完整列表在第一次使用时由 loadCodecList 填充
+    comboBox_sendCodec = new PopupComboBox(groupBox_codecConfig);
+    comboBox_sendCodec->addItem("UTF-8");
     label_receiveCodec = new QLabel("接收编码:", groupBox_codecConfig);
-    comboBox_receiveCodec = new QComboBox(groupBox_codecConfig);
+    comboBox_receiveCodec = new PopupComboBox(groupBox_codecConfig);
+    comboBox_receiveCodec->addItem("UTF-8");
+    label_framing = new QLabel("分帧:", groupBox_codecConfig);
+    comboBox_framing = new QComboBox(groupBox_codecConfig);
+    // 顺序与 FramingConfig::Mode 一致
+    comboBox_framing->addItems({"不分帧", "分隔符", "固定长度", "长度字段", "空闲时间", "SLIP", "COBS"});
+    lineEdit_framingParameter = new QLineEdit(groupBox_codecConfig);
+    lineEdit_framingParameter->setToolTip("分隔符：如 \\r\\n、; 或 \\x7E\n"
+                                          "固定长度：每帧字节数\n"
+                                          "长度字段：偏移,字节数[,BE|LE[,修正值]]，帧长 = 偏移 + 字节数 + 字段值 + 修正值\n"
+                                          "空闲时间：毫秒");
+    label_checksum = new QLabel("校验:", groupBox_codecConfig);
+    comboBox_checksum = new QComboBox(groupBox_codecConfig);
+    // 顺序与 Checksum::Type 一致
+    comboBox_checksum->addItems(Checksum::names());
+    comboBox_checksum->setToolTip("分帧时逐帧核对帧末尾（分隔符之前）的校验值，不符的帧标记为 [CHK]");
+    checkBox_checksumBigEndian = new QCheckBox("高字节在前", groupBox_codecConfig);
+    checkBox_appendChecksum = new QCheckBox("发送追加", groupBox_codecConfig);
+    checkBox_appendChecksum->setToolTip("发送和自动发送时在数据末尾追加校验值");
     
     horizontalLayout_codec->addWidget(label_sendCodec);
     horizontalLayout_codec->addWidget(comboBox_sendCodec);
     horizontalLayout_codec->addWidget(label_receiveCodec);
     horizontalLayout_codec->addWidget(comboBox_receiveCodec);
+    horizontalLayout_codec->addWidget(label_framing);
+    horizontalLayout_codec->addWidget(comboBox_framing);
+    horizontalLayout_codec->addWidget(lineEdit_framingParameter);
+    horizontalLayout_codec->addWidget(label_checksum);
+    horizontalLayout_codec->addWidget(comboBox_checksum);
+    horizontalLayout_codec->addWidget(checkBox_checksumBigEndian);
+    horizontalLayout_codec->addWidget(checkBox_appendChecksum);
     
     mainLayout->addWidget(groupBox_codecConfig);
     
@@ -143,21 +345,62 @@ void MainWindow::initUI()
     horizontalLayout_receiveOptions = new QHBoxLayout;
     checkBox_hexReceive = new QCheckBox("十六进制显示", groupBox_receive);
     checkBox_timestamp = new QCheckBox("显示时间戳", groupBox_receive);
+    comboBox_timestampPrecision = new QComboBox(groupBox_receive);
+    comboBox_timestampPrecision->addItems({"秒", "毫秒", "微秒"});
+    comboBox_timestampPrecision->setToolTip("时间戳精度");
+    checkBox_timestampDelta = new QCheckBox("时间差", groupBox_receive);
+    checkBox_timestampDelta->setToolTip("显示与上一条记录的时间差");
     checkBox_logMode = new QCheckBox("日志模式", groupBox_receive);
+    spinBox_renderFps = new QSpinBox(groupBox_receive);
+    spinBox_renderFps->setRange(RenderScheduler::MIN_FRAME_RATE, RenderScheduler::MAX_FRAME_RATE);
+    spinBox_renderFps->setValue(30);
+    spinBox_renderFps->setToolTip("接收区每秒最多刷新的次数");
+    label_fps = new QLabel("帧/秒", groupBox_receive);
     pushButton_clearReceive = new QPushButton("清空", groupBox_receive);
     pushButton_save = new QPushButton("保存", groupBox_receive);
+    pushButton_record = new QPushButton("录制", groupBox_receive);
+    pushButton_record->setCheckable(true);
+    pushButton_record->setToolTip("把收发的原始数据连同时间、方向、端口写入录制文件");
+    pushButton_pauseDisplay = new QPushButton("暂停显示", groupBox_receive);
+    pushButton_pauseDisplay->setCheckable(true);
+    pushButton_pauseDisplay->setToolTip("接收区停止滚动，数据照常接收、保存和录制");
     
     horizontalLayout_receiveOptions->addWidget(checkBox_hexReceive);
     horizontalLayout_receiveOptions->addWidget(checkBox_timestamp);
+    horizontalLayout_receiveOptions->addWidget(comboBox_timestampPrecision);
+    horizontalLayout_receiveOptions->addWidget(checkBox_timestampDelta);
     horizontalLayout_receiveOptions->addWidget(checkBox_logMode);
+    horizontalLayout_receiveOptions->addWidget(spinBox_renderFps);
+    horizontalLayout_receiveOptions->addWidget(label_fps);
     horizontalLayout_receiveOptions->addWidget(pushButton_clearReceive);
     horizontalLayout_receiveOptions->addWidget(pushButton_save);
+    horizontalLayout_receiveOptions->addWidget(pushButton_record);
+    horizontalLayout_receiveOptions->addWidget(pushButton_pauseDisplay);
+    
+    // 浏览录制文件
+    horizontalLayout_capture = new QHBoxLayout;
+    pushButton_openCapture = new QPushButton("打开录制", groupBox_receive);
+    pushButton_openCapture->setToolTip("在单独的标签页中以只读方式浏览录制文件");
+    lineEdit_jumpTime = new QLineEdit(groupBox_receive);
+    lineEdit_jumpTime->setPlaceholderText("跳转到时间，如 12:34:56.789 或 2024-01-02 12:34:56");
+    horizontalLayout_capture->addWidget(pushButton_openCapture);
+    horizontalLayout_capture->addWidget(lineEdit_jumpTime);
     
-    plainTextEdit_receive = new QPlainTextEdit(groupBox_receive);
-    plainTextEdit_receive->setReadOnly(true);
+    // 虚拟化显示控件，只绘制可见行；合并视图固定为第一页且不能关闭
+    tabWidget_receive = new QTabWidget(groupBox_receive);
+    tabWidget_receive->setTabsClosable(true);
+    mergedView = new ReceiveView(tabWidget_receive);
+    mergedView->setStore(mergedSource);
+    tabWidget_receive->addTab(mergedView, "全部");
+    tabWidget_receive->tabBar()->setTabButton(0, QTabBar::RightSide, nullptr);
+    tabWidget_receive->tabBar()->setTabButton(0, QTabBar::LeftSide, nullptr);
+    captureView = new ReceiveView(tabWidget_receive);
+    captureView->setFollowTail(false);
+    captureView->hide();
     
     verticalLayout_receive->addLayout(horizontalLayout_receiveOptions);
-    verticalLayout_receive->addWidget(plainTextEdit_receive);
+    verticalLayout_receive->addLayout(horizontalLayout_capture);
+    verticalLayout_receive->addWidget(tabWidget_receive);
     
     gridLayout_main->addWidget(groupBox_receive, 0, 0);
     
@@ -169,15 +412,27 @@ void MainWindow::initUI()
     checkBox_hexSend = new QCheckBox("十六进制发送", groupBox_send);
     checkBox_autoSend = new QCheckBox("自动发送", groupBox_send);
     spinBox_autoSendInterval = new QSpinBox(groupBox_send);
-    spinBox_autoSendInterval->setMinimum(100);
+    spinBox_autoSendInterval->setMinimum(0);
     spinBox_autoSendInterval->setMaximum(10000);
     spinBox_autoSendInterval->setValue(1000);
+    spinBox_autoSendInterval->setSpecialValueText("连续");
+    spinBox_autoSendInterval->setToolTip("发送周期，0 为串口一空闲就接着发送");
     label_ms = new QLabel("毫秒", groupBox_send);
+    spinBox_autoSendBurst = new QSpinBox(groupBox_send);
+    spinBox_autoSendBurst->setMinimum(1);
+    spinBox_autoSendBurst->setMaximum(1000);
+    spinBox_autoSendBurst->setValue(1);
+    spinBox_autoSendBurst->setPrefix("×");
+    spinBox_autoSendBurst->setToolTip("每个周期连续发送的次数");
+    label_autoSendStats = new QLabel(groupBox_send);
+    label_autoSendStats->setToolTip("实际发送速率和错过的发送时刻");
     
     horizontalLayout_sendOptions->addWidget(checkBox_hexSend);
     horizontalLayout_sendOptions->addWidget(checkBox_autoSend);
     horizontalLayout_sendOptions->addWidget(spinBox_autoSendInterval);
     horizontalLayout_sendOptions->addWidget(label_ms);
+    horizontalLayout_sendOptions->addWidget(spinBox_autoSendBurst);
+    horizontalLayout_sendOptions->addWidget(label_autoSendStats);
     
     plainTextEdit_send = new QPlainTextEdit(groupBox_send);
     plainTextEdit_send->setMaximumBlockCount(1000);
@@ -186,9 +441,26 @@ void MainWindow::initUI()
     pushButton_send = new QPushButton("发送", groupBox_send);
     pushButton_send->setDefault(true);
     pushButton_clearSend = new QPushButton("清空", groupBox_send);
+    pushButton_sendFile = new QPushButton("发送文件", groupBox_send);
+    pushButton_sendFile->setToolTip("按块发送文件，写入速度跟随串口实际发送速度和流控状态");
+    progressBar_sendFile = new QProgressBar(groupBox_send);
+    progressBar_sendFile->setRange(0, 1000);
+    progressBar_sendFile->hide();
+    pushButton_replay = new QPushButton("回放", groupBox_send);
+    pushButton_replay->setToolTip("按录制时的时间间隔把录制文件中收到的数据从当前串口发出");
+    comboBox_replaySpeed = new QComboBox(groupBox_send);
+    comboBox_replaySpeed->addItems({"1x", "2x", "10x", "最快"});
+    comboBox_replaySpeed->setToolTip("回放速度；最快时不按时间间隔，以串口实际发送速度连续发送");
+    label_replayStats = new QLabel(groupBox_send);
+    label_replayStats->setToolTip("已回放/已索引的记录数、发送速率和实际发送时刻相对计划时刻的误差");
     
     horizontalLayout_sendButtons->addWidget(pushButton_send);
     horizontalLayout_sendButtons->addWidget(pushButton_clearSend);
+    horizontalLayout_sendButtons->addWidget(pushButton_sendFile);
+    horizontalLayout_sendButtons->addWidget(progressBar_sendFile);
+    horizontalLayout_sendButtons->addWidget(pushButton_replay);
+    horizontalLayout_sendButtons->addWidget(comboBox_replaySpeed);
+    horizontalLayout_sendButtons->addWidget(label_replayStats);
     
     verticalLayout_send->addLayout(horizontalLayout_sendOptions);
     verticalLayout_send->addWidget(plainTextEdit_send);
@@ -198,269 +470,620 @@ void MainWindow::initUI()
     
     mainLayout->addLayout(gridLayout_main);
     
+    // 链路统计面板，勾选"统计"后显示并定时刷新
+    groupBox_stats = new QGroupBox("链路统计", centralWidget);
+    QVBoxLayout *verticalLayout_stats = new QVBoxLayout(groupBox_stats);
+    label_stats = new QLabel(groupBox_stats);
+    label_stats->setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+    label_stats->setTextInteractionFlags(Qt::TextSelectableByMouse);
+    verticalLayout_stats->addWidget(label_stats);
+    groupBox_stats->hide();
+    mainLayout->addWidget(groupBox_stats);
+    
+    // 波形面板，勾选"波形"后显示，数据来自当前会话的接收记录
+    groupBox_plot = new QGroupBox("波形", centralWidget);
+    QVBoxLayout *verticalLayout_plot = new QVBoxLayout(groupBox_plot);
+    QHBoxLayout *horizontalLayout_plotOptions = new QHBoxLayout;
+    QLabel *label_plotWindow = new QLabel("显示行数:", groupBox_plot);
+    comboBox_plotWindow = new QComboBox(groupBox_plot);
+    // 超过每个通道保存的采样数时窗口大部分是空的，不提供
+    for (qint64 lines : {1000, 10000, 100000, 1000000, 10000000}) {
+        if (lines <= PlotView::SERIES_CAPACITY) {
+            comboBox_plotWindow->addItem(QString::number(lines), lines);
+        }
+    }
+    comboBox_plotWindow->setCurrentIndex(1);
+    pushButton_clearPlot = new QPushButton("清除波形", groupBox_plot);
+    label_plotInfo = new QLabel(groupBox_plot);
+    label_plotInfo->setToolTip("每行接收数据是一组采样：逗号、分号或空格分隔的数值按列编号，\n"
+                               "名字=数值 或 名字:数值 按名字编号；不是数值的内容跳过");
+    plotView = new PlotView(groupBox_plot);
+    horizontalLayout_plotOptions->addWidget(label_plotWindow);
+    horizontalLayout_plotOptions->addWidget(comboBox_plotWindow);
+    horizontalLayout_plotOptions->addWidget(pushButton_clearPlot);
+    horizontalLayout_plotOptions->addWidget(label_plotInfo);
+    horizontalLayout_plotOptions->addStretch();
+    verticalLayout_plot->addLayout(horizontalLayout_plotOptions);
+    verticalLayout_plot->addWidget(plotView);
+    groupBox_plot->hide();
+    mainLayout->addWidget(groupBox_plot);
+    
+    // 触发面板，勾选"触发"后显示；规则在各会话的I/O线程中匹配，点"应用"后生效
+    groupBox_trigger = new QGroupBox("触发", centralWidget);
+    QVBoxLayout *verticalLayout_trigger = new QVBoxLayout(groupBox_trigger);
+    plainTextEdit_triggers = new QPlainTextEdit(groupBox_trigger);
+    plainTextEdit_triggers->setPlaceholderText("每行一条：匹配内容 => 动作[:参数]，例如\n"
+                                               "login: => send:root\\r\n"
+                                               "PANIC => stop");
+    plainTextEdit_triggers->setToolTip("接收数据中出现匹配内容时执行动作：\n"
+                                       "send:数据  立即发送数据\n"
+                                       "mark[:文字]  在接收区和录制文件中插入标记\n"
+                                       "record  开始录制（自动命名，保存在程序目录）\n"
+                                       "stop  停止录制\n"
+                                       "pause  暂停接收区显示\n"
+                                       "支持 \\r \\n \\t \\0 \\\\ \\xHH 转义；以 # 开头的行为注释");
+    plainTextEdit_triggers->setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+    plainTextEdit_triggers->setMaximumHeight(100);
+    QHBoxLayout *horizontalLayout_triggerOptions = new QHBoxLayout;
+    checkBox_triggerEnabled = new QCheckBox("启用", groupBox_trigger);
+    pushButton_applyTriggers = new QPushButton("应用", groupBox_trigger);
+    label_triggerStats = new QLabel(groupBox_trigger);
+    label_triggerStats->setToolTip("响应延迟为从I/O线程读到数据到执行完动作（发送数据已写入串口）的时间");
+    horizontalLayout_triggerOptions->addWidget(checkBox_triggerEnabled);
+    horizontalLayout_triggerOptions->addWidget(pushButton_applyTriggers);
+    horizontalLayout_triggerOptions->addWidget(label_triggerStats);
+    horizontalLayout_triggerOptions->addStretch();
+    verticalLayout_trigger->addWidget(plainTextEdit_triggers);
+    verticalLayout_trigger->addLayout(horizontalLayout_triggerOptions);
+    groupBox_trigger->hide();
+    mainLayout->addWidget(groupBox_trigger);
+    
     // 状态统计区域
     horizontalLayout_status = new QHBoxLayout;
     label_sendCount = new QLabel("发送: 0 字节", centralWidget);
+    checkBox_stats = new QCheckBox("统计", centralWidget);
+    checkBox_stats->setToolTip("显示速率、峰值、链路利用率、读取间隔分布和串口错误");
+    checkBox_plot = new QCheckBox("波形", centralWidget);
+    checkBox_plot->setToolTip("把当前会话接收到的 CSV 或 名字=数值 数据按通道画成波形");
+    checkBox_trigger = new QCheckBox("触发", centralWidget);
+    checkBox_trigger->setToolTip("接收数据匹配到指定内容时自动发送、插入标记、开始或停止录制");
     QSpacerItem *spacer = new QSpacerItem(40, 20, QSizePolicy::Expanding, QSizePolicy::Minimum);
     label_receiveCount = new QLabel("接收: 0 字节", centralWidget);
     
     horizontalLayout_status->addWidget(label_sendCount);
+    horizontalLayout_status->addWidget(checkBox_stats);
+    horizontalLayout_status->addWidget(checkBox_plot);
+    horizontalLayout_status->addWidget(checkBox_trigger);
     horizontalLayout_status->addItem(spacer);
     horizontalLayout_status->addWidget(label_receiveCount);
     
     mainLayout->addLayout(horizontalLayout_status);
     
     // 连接UI信号槽
-    connect(pushButton_refresh, &QPushButton::clicked, this, &MainWindow::on_pushButton_refresh_clicked);
     connect(pushButton_open, &QPushButton::clicked, this, &MainWindow::on_pushButton_open_clicked);
+    connect(pushButton_newSession, &QPushButton::clicked, this, &MainWindow::on_pushButton_newSession_clicked);
+    connect(tabWidget_receive, &QTabWidget::currentChanged, this, &MainWindow::on_tabWidget_receive_currentChanged);
+    connect(tabWidget_receive, &QTabWidget::tabCloseRequested, this, &MainWindow::on_tabWidget_receive_tabCloseRequested);
     connect(pushButton_send, &QPushButton::clicked, this, &MainWindow::on_pushButton_send_clicked);
     connect(pushButton_clearReceive, &QPushButton::clicked, this, &MainWindow::on_pushButton_clearReceive_clicked);
     connect(pushButton_clearSend, &QPushButton::clicked, this, &MainWindow::on_pushButton_clearSend_clicked);
+    connect(pushButton_sendFile, &QPushButton::clicked, this, &MainWindow::on_pushButton_sendFile_clicked);
+    connect(pushButton_replay, &QPushButton::clicked, this, &MainWindow::on_pushButton_replay_clicked);
+    connect(checkBox_stats, &QCheckBox::toggled, this, &MainWindow::on_checkBox_stats_toggled);
+    connect(checkBox_plot, &QCheckBox::toggled, this, &MainWindow::on_checkBox_plot_toggled);
+    connect(comboBox_plotWindow, &QComboBox::currentIndexChanged, this, &MainWindow::on_comboBox_plotWindow_currentIndexChanged);
+    connect(pushButton_clearPlot, &QPushButton::clicked, this, &MainWindow::on_pushButton_clearPlot_clicked);
+    connect(checkBox_trigger, &QCheckBox::toggled, this, &MainWindow::on_checkBox_trigger_toggled);
+    connect(checkBox_triggerEnabled, &QCheckBox::toggled, this, &MainWindow::on_pushButton_applyTriggers_clicked);
+    connect(pushButton_applyTriggers, &QPushButton::clicked, this, &MainWindow::on_pushButton_applyTriggers_clicked);
+    connect(checkBox_bridge, &QCheckBox::toggled, this, &MainWindow::on_checkBox_bridge_toggled);
     connect(pushButton_save, &QPushButton::clicked, this, &MainWindow::on_pushButton_save_clicked);
+    connect(pushButton_record, &QPushButton::toggled, this, &MainWindow::on_pushButton_record_toggled);
+    connect(pushButton_pauseDisplay, &QPushButton::toggled, this, &MainWindow::on_pushButton_pauseDisplay_toggled);
+    connect(pushButton_openCapture, &QPushButton::clicked, this, &MainWindow::on_pushButton_openCapture_clicked);
+    connect(lineEdit_jumpTime, &QLineEdit::returnPressed, this, &MainWindow::on_lineEdit_jumpTime_returnPressed);
     connect(checkBox_hexSend, &QCheckBox::stateChanged, this, &MainWindow::on_checkBox_hexSend_stateChanged);
     connect(checkBox_hexReceive, &QCheckBox::stateChanged, this, &MainWindow::on_checkBox_hexReceive_stateChanged);
     connect(checkBox_autoSend, &QCheckBox::stateChanged, this, &MainWindow::on_checkBox_autoSend_stateChanged);
+    connect(spinBox_autoSendInterval, &QSpinBox::valueChanged, this, &MainWindow::updateAutoSendSchedule);
+    connect(spinBox_autoSendBurst, &QSpinBox::valueChanged, this, &MainWindow::updateAutoSendSchedule);
+    connect(plainTextEdit_send, &QPlainTextEdit::textChanged, this, &MainWindow::updateAutoSendPayload);
     connect(comboBox_baudRate, &QComboBox::currentIndexChanged, this, &MainWindow::on_comboBox_baudRate_currentIndexChanged);
     connect(comboBox_dataBits, &QComboBox::currentIndexChanged, this, &MainWindow::on_comboBox_dataBits_currentIndexChanged);
     connect(comboBox_stopBits, &QComboBox::currentIndexChanged, this, &MainWindow::on_comboBox_stopBits_currentIndexChanged);
     connect(comboBox_parity, &QComboBox::currentIndexChanged, this, &MainWindow::on_comboBox_parity_currentIndexChanged);
     connect(comboBox_flowControl, &QComboBox::currentIndexChanged, this, &MainWindow::on_comboBox_flowControl_currentIndexChanged);
+    connect(comboBox_sendCodec, &PopupComboBox::itemsRequested, this, &MainWindow::loadCodecList);
+    connect(comboBox_receiveCodec, &PopupComboBox::itemsRequested, this, &MainWindow::loadCodecList);
     connect(comboBox_sendCodec, &QComboBox::currentIndexChanged, this, &MainWindow::on_comboBox_sendCodec_currentIndexChanged);
     connect(comboBox_receiveCodec, &QComboBox::currentIndexChanged, this, &MainWindow::on_comboBox_receiveCodec_currentIndexChanged);
     // 保存设置的信号槽连接已移至构造函数中，在应用初始设置后连接
 }
 
-void MainWindow::updateSerialPorts()
+void MainWindow::updateSerialPorts(const QStringList &names, const QStringList &descriptions)
 {
-    comboBox_portName->clear();
-    foreach (const QSerialPortInfo &info, QSerialPortInfo::availablePorts()) {
-        comboBox_portName->addItem(info.portName());
+    // 保留当前选择；当前选择的串口已拔出时自动选中新插入的串口
+    const QString current = comboBox_portName->currentText();
+    QStringList added;
+    for (const QString &name : names) {
+        if (!knownPorts.contains(name)) {
+            added.append(name);
+        }
     }
-}
-
-void MainWindow::updateCodecList()
-{
-    // 常用编码列表，将这些编码排在前面
-    QStringList commonCodecs = {"UTF-8", "GBK", "GB2312", "GB18030", "ASCII", "Latin-1", "UTF-16", "UTF-16BE", "UTF-16LE"};
-    
-    // 获取所有可用编码
-    QList<QByteArray> allCodecBytes = QTextCodec::availableCodecs();
-    QStringList allCodecs;
-    for (const QByteArray &codecByte : allCodecBytes) {
-        allCodecs.append(QString(codecByte));
+    QStringList removed;
+    for (const QString &name : knownPorts) {
+        if (!names.contains(name)) {
+            removed.append(name);
+        }
     }
     
-    // 创建最终编码列表，先添加常用编码
-    QStringList finalCodecs;
+    comboBox_portName->clear();
+    for (int i = 0; i < names.size(); ++i) {
+        comboBox_portName->addItem(names.at(i));
+        comboBox_portName->setItemData(i, descriptions.value(i), Qt::ToolTipRole);
+    }
+    if (names.contains(current)) {
+        comboBox_portName->setCurrentText(current);
+    } else if (!added.isEmpty()) {
+        comboBox_portName->setCurrentText(added.first());
+    }
+    comboBox_portName->setPlaceholderText(names.isEmpty() ? "未找到串口" : QString());
     
-    // 添加常用编码
-    for (const QString &commonCodec : commonCodecs) {
-        if (allCodecs.contains(commonCodec)) {
-            finalCodecs.append(commonCodec);
-            allCodecs.removeAll(commonCodec);
+    // 第一次枚举不提示，之后的变化都是热插拔
+    if (portsScanned && (!added.isEmpty() || !removed.isEmpty())) {
+        QStringList changes;
+        if (!added.isEmpty()) {
+            changes.append("已插入 " + added.join(", "));
         }
+        if (!removed.isEmpty()) {
+            changes.append("已拔出 " + removed.join(", "));
+        }
+        statusBar()->showMessage("串口" + changes.join("，"), 5000);
     }
-    
-    // 添加剩余编码（排序后）
-    allCodecs.sort();
-    finalCodecs.append(allCodecs);
-    
-    comboBox_sendCodec->addItems(finalCodecs);
-    comboBox_receiveCodec->addItems(finalCodecs);
-    
-    // 设置默认编码
-    comboBox_sendCodec->setCurrentText("UTF-8");
-    comboBox_receiveCodec->setCurrentText("UTF-8");
+    knownPorts = names;
+    portsScanned = true;
 }
 
-QString MainWindow::byteArrayToHexString(const QByteArray &data)
+void MainWindow::loadCodecList()
 {
-    QString hexString;
-    for (const char &byte : data) {
-        hexString += QString("%1 ").arg(static_cast<unsigned char>(byte), 2, 16, QLatin1Char('0')).toUpper();
+    // 完整的编码列表有几百项，第一次使用任一编码下拉框（展开、获得焦点或滚轮）时才构建，两个下拉框一起填充
+    if (codecListLoaded) {
+        return;
     }
-    return hexString.trimmed();
-}
-
-QByteArray MainWindow::hexStringToByteArray(const QString &hex)
-{
-    QByteArray byteArray;
-    QStringList hexList = hex.split(' ', Qt::SkipEmptyParts);
-    for (const QString &hexItem : hexList) {
-        bool ok;
-        uchar byte = hexItem.toUInt(&ok, 16);
-        if (ok) {
-            byteArray.append(static_cast<char>(byte));
+    codecListLoaded = true;
+    
+    // 常用编码排在前面，其余编码排序后接在后面
+    static const char *const commonCodecs[] = {"UTF-8", "GBK", "GB2312", "GB18030", "ASCII", "Latin-1", "UTF-16", "UTF-16BE", "UTF-16LE"};
+    const QList<QByteArray> available = QTextCodec::availableCodecs();
+    QSet<QByteArray> remaining(available.begin(), available.end());
+    QStringList codecs;
+    for (const char *name : commonCodecs) {
+        if (remaining.remove(name)) {
+            codecs.append(QString::fromLatin1(name));
         }
     }
-    return byteArray;
-}
-
-QByteArray MainWindow::encodeData(const QString &text, const QString &codecName)
-{
-    // 使用QTextCodec实现真正的编码转换
-    QTextCodec *codec = QTextCodec::codecForName(codecName.toUtf8());
-    if (codec) {
-        return codec->fromUnicode(text);
+    QStringList others;
+    others.reserve(remaining.size());
+    for (const QByteArray &name : remaining) {
+        others.append(QString::fromLatin1(name));
     }
-    return text.toUtf8(); // 默认UTF-8
-}
-
-QString MainWindow::decodeData(const QByteArray &data, const QString &codecName)
-{
-    // 使用QTextCodec实现真正的解码转换
-    QTextCodec *codec = QTextCodec::codecForName(codecName.toUtf8());
-    if (codec) {
-        return codec->toUnicode(data);
+    others.sort();
+    codecs.append(others);
+    
+    for (PopupComboBox *combo : {comboBox_sendCodec, comboBox_receiveCodec}) {
+        // 当前编码不变，不触发重建编解码器和重新显示
+        const QSignalBlocker blocker(combo);
+        const QString current = combo->currentText();
+        combo->clear();
+        combo->addItems(codecs);
+        combo->setCurrentIndex(qMax(0, combo->findText(current)));
     }
-    return QString::fromUtf8(data); // 默认UTF-8
 }
 
-void MainWindow::on_pushButton_refresh_clicked()
+void MainWindow::updateRenderOptions()
 {
-    updateSerialPorts();
+    // 接收区保存的是原始字节，显示方式改变后历史数据按新方式重新渲染
+    ReceiveView::RenderOptions options;
+    options.hexReceive = checkBox_hexReceive->isChecked();
+    options.hexSend = checkBox_hexSend->isChecked();
+    options.timestamp = checkBox_timestamp->isChecked();
+    options.logMode = checkBox_logMode->isChecked();
+    options.timestampPrecision = static_cast<TimestampFormatter::Precision>(comboBox_timestampPrecision->currentIndex());
+    options.timestampDelta = checkBox_timestampDelta->isChecked();
+    options.hex = hexFormat;
+    options.receiveCodec = &receiveCodec;
+    options.sendCodec = &sendCodec;
+    for (const SessionPage &page : sessionPages) {
+        page.view->setRenderOptions(options);
+    }
+    mergedView->setRenderOptions(options);
+    captureView->setRenderOptions(options);
 }
 
 void MainWindow::on_pushButton_open_clicked()
 {
-    if (serial->isOpen()) {
-        // 关闭串口
-        serial->close();
-        pushButton_open->setText("打开");
-        label_status->setText("串口未打开");
-        label_status->setStyleSheet("color: red;");
+    // 合并视图页上打开串口时新建一个会话
+    Session *session = currentSession();
+    if (!session) {
+        session = addSession();
+    }
+    
+    if (session->isOpen()) {
+        // 关闭串口，界面状态在会话的 closed 信号中更新
+        session->close();
     } else {
         // 打开串口
-        serial->setPortName(comboBox_portName->currentText());
-        serial->setBaudRate(comboBox_baudRate->currentText().toInt());
+        SerialConfig config;
+        config.portName = comboBox_portName->currentText();
+        config.baudRate = comboBox_baudRate->currentText().toInt();
         
         // 设置数据位
         switch (comboBox_dataBits->currentText().toInt()) {
-        case 5: serial->setDataBits(QSerialPort::Data5); break;
-        case 6: serial->setDataBits(QSerialPort::Data6); break;
-        case 7: serial->setDataBits(QSerialPort::Data7); break;
-        case 8: serial->setDataBits(QSerialPort::Data8); break;
-        default: serial->setDataBits(QSerialPort::Data8); break;
+        case 5: config.dataBits = QSerialPort::Data5; break;
+        case 6: config.dataBits = QSerialPort::Data6; break;
+        case 7: config.dataBits = QSerialPort::Data7; break;
+        case 8: config.dataBits = QSerialPort::Data8; break;
+        default: config.dataBits = QSerialPort::Data8; break;
         }
         
         // 设置停止位
         switch (comboBox_stopBits->currentIndex()) {
-        case 0: serial->setStopBits(QSerialPort::OneStop); break;
-        case 1: serial->setStopBits(QSerialPort::OneAndHalfStop); break;
-        case 2: serial->setStopBits(QSerialPort::TwoStop); break;
-        default: serial->setStopBits(QSerialPort::OneStop); break;
+        case 0: config.stopBits = QSerialPort::OneStop; break;
+        case 1: config.stopBits = QSerialPort::OneAndHalfStop; break;
+        case 2: config.stopBits = QSerialPort::TwoStop; break;
+        default: config.stopBits = QSerialPort::OneStop; break;
         }
         
         // 设置校验位
         switch (comboBox_parity->currentIndex()) {
-        case 0: serial->setParity(QSerialPort::NoParity); break;
-        case 1: serial->setParity(QSerialPort::OddParity); break;
-        case 2: serial->setParity(QSerialPort::EvenParity); break;
-        case 3: serial->setParity(QSerialPort::MarkParity); break;
-        case 4: serial->setParity(QSerialPort::SpaceParity); break;
-        default: serial->setParity(QSerialPort::NoParity); break;
+        case 0: config.parity = QSerialPort::NoParity; break;
+        case 1: config.parity = QSerialPort::OddParity; break;
+        case 2: config.parity = QSerialPort::EvenParity; break;
+        case 3: config.parity = QSerialPort::MarkParity; break;
+        case 4: config.parity = QSerialPort::SpaceParity; break;
+        default: config.parity = QSerialPort::NoParity; break;
         }
         
         // 设置流控制
         switch (comboBox_flowControl->currentIndex()) {
-        case 0: serial->setFlowControl(QSerialPort::NoFlowControl); break;
-        case 1: serial->setFlowControl(QSerialPort::HardwareControl); break;
-        case 2: serial->setFlowControl(QSerialPort::SoftwareControl); break;
-        default: serial->setFlowControl(QSerialPort::NoFlowControl); break;
+        case 0: config.flowControl = QSerialPort::NoFlowControl; break;
+        case 1: config.flowControl = QSerialPort::HardwareControl; break;
+        case 2: config.flowControl = QSerialPort::SoftwareControl; break;
+        default: config.flowControl = QSerialPort::NoFlowControl; break;
         }
         
-        if (serial->open(QIODevice::ReadWrite)) {
-            pushButton_open->setText("关闭");
-            label_status->setText("串口已打开");
-            label_status->setStyleSheet("color: green;");
+        // 在会话的I/O线程中打开串口，结果通过 opened/openFailed 返回
+        session->open(config);
+    }
+    updateSessionControls();
+}
+
+void MainWindow::on_pushButton_newSession_clicked()
+{
+    addSession();
+}
+
+void MainWindow::on_tabWidget_receive_currentChanged(int index)
+{
+    Q_UNUSED(index);
+    // 串口按钮、状态、计数、自动发送和波形都跟随当前标签页的会话
+    updateSessionControls();
+    if (groupBox_plot->isVisible()) {
+        updatePlot();
+    }
+}
+
+void MainWindow::on_tabWidget_receive_tabCloseRequested(int index)
+{
+    QWidget *page = tabWidget_receive->widget(index);
+    if (page == captureView) {
+        // 关闭录制文件，映射和索引随之释放
+        captureIndexTimer->stop();
+        tabWidget_receive->removeTab(index);
+        captureView->setStore(nullptr);
+        delete captureSource;
+        captureSource = nullptr;
+        statusBar()->clearMessage();
+        return;
+    }
+    for (int i = 0; i < sessionPages.size(); ++i) {
+        if (sessionPages.at(i).view == page) {
+            removeSession(i);
+            return;
+        }
+    }
+}
+
+Session *MainWindow::addSession()
+{
+    Session *session = new Session(this);
+    ChunkStore *store = session->store();
+    store->setMemoryBudget(receiveMemoryBudget);
+    session->setName(QString("会话%1").arg(sessionPages.size() + 1));
+    session->setReceiveCodec(&receiveCodec);
+    session->setFramingConfig(framingConfig);
+    if (captureWriter->isOpen()) {
+        session->setCaptureWriter(captureWriter);
+    }
+    if (!triggerRules.isEmpty()) {
+        session->setTriggerRules(triggerRules);
+    }
+    
+    ReceiveView *view = new ReceiveView(tabWidget_receive);
+    view->setRenderOptions(mergedView->renderOptions());
+    view->setStore(store);
+    sessionPages.append({session, view});
+    mergedSource->addSource(store, session->name());
+    
+    // 会话有新数据时只请求一帧，所有会话在同一帧中刷新
+    connect(session, &Session::updateRequested, renderScheduler, &RenderScheduler::requestFrame);
+    connect(session, &Session::opened, this, [this, session]() {
+        // 标签页和合并视图中的标签都改为端口名
+        const int page = pageOf(session);
+        tabWidget_receive->setTabText(page, session->name());
+        mergedSource->setLabel(session->store(), session->name());
+        mergedView->reset();
+        updateSessionControls();
+    });
+    connect(session, &Session::openFailed, this, &MainWindow::updateSessionControls);
+    connect(session, &Session::fileSendFinished, this, [this, session](bool ok, const QString &errorString) {
+        if (ok) {
+            statusBar()->showMessage(QString("%1：文件发送完成").arg(session->name()), 5000);
+        } else {
+            statusBar()->showMessage(QString("%1：文件发送中止，%2").arg(session->name(), errorString), 5000);
+        }
+        updateSessionControls();
+    });
+    connect(session, &Session::replayFinished, this, [this, session](bool ok, const QString &errorString) {
+        const QString summary = formatReplayStats(session->replayStats());
+        if (ok) {
+            statusBar()->showMessage(QString("%1：回放完成，%2").arg(session->name(), summary), 10000);
         } else {
-            label_status->setText("打开失败");
-            label_status->setStyleSheet("color: red;");
+            statusBar()->showMessage(QString("%1：回放中止，%2，%3").arg(session->name(), errorString, summary), 10000);
         }
+        updateSessionControls();
+    });
+    connect(session, &Session::closed, this, &MainWindow::updateSessionControls);
+    connect(session, &Session::triggerFired, this, &MainWindow::onTriggerFired);
+    connect(session, &Session::bridgeChanged, this, &MainWindow::updateSessionControls);
+    connect(session, &Session::bridgeFailed, this, [this, session](const QString &errorString) {
+        statusBar()->showMessage(QString("%1：桥接失败，%2").arg(session->name(), errorString), 5000);
+        updateSessionControls();
+    });
+    
+    tabWidget_receive->setCurrentIndex(tabWidget_receive->insertTab(sessionPages.size(), view, session->name()));
+    return session;
+}
+
+void MainWindow::removeSession(int page)
+{
+    const SessionPage removed = sessionPages.takeAt(page);
+    tabWidget_receive->removeTab(tabWidget_receive->indexOf(removed.view));
+    
+    // 先从合并视图中移除，再关闭串口、停止I/O线程
+    mergedSource->removeSource(removed.session->store());
+    mergedView->reset();
+    if (plotSession == removed.session) {
+        plotSession = nullptr;
     }
+    removed.view->setStore(nullptr);
+    delete removed.view;
+    delete removed.session;
+    updateSessionControls();
 }
 
-void MainWindow::on_pushButton_send_clicked()
+Session *MainWindow::currentSession() const
 {
-    if (!serial->isOpen()) {
-        return;
+    QWidget *page = tabWidget_receive->currentWidget();
+    for (const SessionPage &item : sessionPages) {
+        if (item.view == page) {
+            return item.session;
+        }
+    }
+    return nullptr;
+}
+
+ReceiveView *MainWindow::currentView() const
+{
+    return qobject_cast<ReceiveView *>(tabWidget_receive->currentWidget());
+}
+
+int MainWindow::pageOf(const Session *session) const
+{
+    for (const SessionPage &item : sessionPages) {
+        if (item.session == session) {
+            return tabWidget_receive->indexOf(item.view);
+        }
+    }
+    return -1;
+}
+
+void MainWindow::updateSessionControls()
+{
+    Session *session = currentSession();
+    if (!session) {
+        // 合并视图：显示已打开的串口数
+        int open = 0;
+        for (const SessionPage &page : sessionPages) {
+            open += page.session->isOpen() ? 1 : 0;
+        }
+        pushButton_open->setEnabled(true);
+        pushButton_open->setText("打开");
+        label_status->setText(QString("%1/%2 个串口已打开").arg(open).arg(sessionPages.size()));
+        label_status->setStyleSheet(open > 0 ? "color: green;" : "color: red;");
+        label_status->setToolTip(QString());
+    } else if (session->isOpen()) {
+        pushButton_open->setEnabled(true);
+        pushButton_open->setText("关闭");
+        label_status->setText("串口已打开");
+        label_status->setStyleSheet("color: green;");
+        label_status->setToolTip(QString());
+    } else {
+        pushButton_open->setEnabled(!session->isOpening());
+        pushButton_open->setText("打开");
+        label_status->setText(session->errorString().isEmpty() ? "串口未打开" : "打开失败");
+        label_status->setStyleSheet("color: red;");
+        label_status->setToolTip(session->errorString());
     }
     
-    QString text = plainTextEdit_send->toPlainText();
-    QByteArray sendData;
+    // 发送和自动发送只作用于当前会话
+    pushButton_send->setEnabled(session != nullptr);
+    pushButton_sendFile->setEnabled(session != nullptr);
+    pushButton_sendFile->setText(session && session->isSendingFile() ? "停止发送" : "发送文件");
+    pushButton_replay->setEnabled(session != nullptr);
+    pushButton_replay->setText(session && session->isReplaying() ? "停止回放" : "回放");
+    comboBox_replaySpeed->setEnabled(!(session && session->isReplaying()));
+    checkBox_autoSend->setEnabled(session != nullptr);
+    const QSignalBlocker blocker(checkBox_autoSend);
+    checkBox_autoSend->setChecked(session && session->isAutoSending());
+    if (session && session->isAutoSending()) {
+        const QSignalBlocker intervalBlocker(spinBox_autoSendInterval);
+        const QSignalBlocker burstBlocker(spinBox_autoSendBurst);
+        spinBox_autoSendInterval->setValue(session->autoSendInterval());
+        spinBox_autoSendBurst->setValue(session->autoSendBurst());
+    }
     
-    if (checkBox_hexSend->isChecked()) {
-        sendData = hexStringToByteArray(text);
+    // 桥接同样只作用于当前会话，串口打开后才能启用
+    const bool bridging = session && session->isBridging();
+    checkBox_bridge->setEnabled(session && session->isOpen());
+    lineEdit_bridge->setEnabled(!bridging);
+    const QSignalBlocker bridgeBlocker(checkBox_bridge);
+    checkBox_bridge->setChecked(bridging);
+    if (bridging) {
+        const PortBridge::Status status = session->bridgeStatus();
+        label_bridgeStatus->setText(QString("%1 个客户端").arg(status.clients));
+        label_bridgeStatus->setToolTip(QString("监听 %1\n控制端：%2\n转发 %3 字节，写入串口 %4 字节，丢弃 %5 字节")
+                                       .arg(session->bridgeAddress(), status.controller ? "已连接" : "无")
+                                       .arg(status.forwarded).arg(status.written).arg(status.dropped));
     } else {
-        sendData = encodeData(text, comboBox_sendCodec->currentText());
+        label_bridgeStatus->clear();
+        label_bridgeStatus->setToolTip(QString());
     }
     
-    qint64 bytesWritten = serial->write(sendData);
-    if (bytesWritten > 0) {
-        sendBytes += bytesWritten;
-        label_sendCount->setText(QString("发送: %1 字节").arg(sendBytes));
-        
-        // 添加日志模式处理，显示发送数据
-        if (checkBox_logMode->isChecked()) {
-            QString logText;
-            if (checkBox_hexSend->isChecked()) {
-                logText = byteArrayToHexString(sendData);
-            } else {
-                logText = text;
-            }
-            
-            // 添加日志前缀
-            logText = "[TX] " + logText;
-            
-            // 添加时间戳
-            if (checkBox_timestamp->isChecked()) {
-                QDateTime currentTime = QDateTime::currentDateTime();
-                QString timestamp = currentTime.toString("[yyyy-MM-dd HH:mm:ss] ");
-                logText = timestamp + logText;
-            }
-            
-            plainTextEdit_receive->insertPlainText(logText + "\n");
-            plainTextEdit_receive->moveCursor(QTextCursor::End);
+    updateAutoSendStats();
+    updateFileSendProgress();
+    updateReplayProgress();
+    if (groupBox_stats->isVisible()) {
+        updateStatsPanel();
+    }
+    if (groupBox_trigger->isVisible()) {
+        updateTriggerStats();
+    }
+}
+
+void MainWindow::updateCounters()
+{
+    // 会话页显示该会话的计数，合并视图显示所有会话的合计
+    qint64 sent = 0;
+    qint64 received = 0;
+    Session *session = currentSession();
+    for (const SessionPage &page : sessionPages) {
+        if (!session || page.session == session) {
+            sent += page.session->sentBytes();
+            received += page.session->receivedBytes();
         }
     }
+    label_sendCount->setText(QString("发送: %1 字节").arg(sent));
+    label_receiveCount->setText(QString("接收: %1 字节").arg(received));
+}
+
+void MainWindow::on_pushButton_send_clicked()
+{
+    sendTo(currentSession());
 }
 
-void MainWindow::readData()
+void MainWindow::sendTo(Session *session)
 {
-    if (!serial->isOpen()) {
+    if (!session || !session->isOpen()) {
         return;
     }
     
-    QByteArray data = serial->readAll();
-    receiveBytes += data.size();
-    label_receiveCount->setText(QString("接收: %1 字节").arg(receiveBytes));
+    QByteArray sendData;
+    if (!encodeSendData(&sendData, true)) {
+        return;
+    }
     
-    QString displayText;
-    if (checkBox_hexReceive->isChecked()) {
-        displayText = byteArrayToHexString(data);
+    // 写操作交给会话的I/O线程完成，发送记录是否显示由日志模式决定
+    session->send(sendData);
+}
+
+bool MainWindow::encodeSendData(QByteArray *data, bool showError)
+{
+    QString text = plainTextEdit_send->toPlainText();
+    if (checkBox_hexSend->isChecked()) {
+        // 一次遍历解析，格式错误时提示第一个无效字符的位置，不发送
+        qsizetype errorOffset = 0;
+        if (!HexParser::parse(text, data, &errorOffset)) {
+            if (showError) {
+                statusBar()->showMessage(QString("十六进制数据格式错误：第 %1 个字符无效").arg(errorOffset + 1), 5000);
+            }
+            return false;
+        }
     } else {
-        displayText = decodeData(data, comboBox_receiveCodec->currentText());
+        *data = sendCodec.encode(text);
     }
-    
-    // 添加日志模式处理
-    if (checkBox_logMode->isChecked()) {
-        displayText = "[RX] " + displayText;
+    if (checkBox_appendChecksum->isChecked() && !data->isEmpty()) {
+        framingConfig.checksum.append(data);
     }
-    
-    // 添加时间戳
-    if (checkBox_timestamp->isChecked()) {
-        QDateTime currentTime = QDateTime::currentDateTime();
-        QString timestamp = currentTime.toString("[yyyy-MM-dd HH:mm:ss] ");
-        displayText = timestamp + displayText;
+    return true;
+}
+
+void MainWindow::applyFramingConfig(const FramingConfig &config)
+{
+    framingConfig = config;
+    for (const SessionPage &page : sessionPages) {
+        page.session->setFramingConfig(config);
+    }
+}
+
+void MainWindow::renderFrame()
+{
+    // 取走本帧之前各会话积累的全部接收数据，再按时间合并
+    for (const SessionPage &page : sessionPages) {
+        page.session->readData();
+    }
+    // 暂停显示时数据照常取走和保存，只是不更新接收区，恢复后一次补上
+    if (!pushButton_pauseDisplay->isChecked()) {
+        if (mergedSource->update() < 0) {
+            mergedView->reset();
+        }
+        // 等待其他会话追上的记录留到下一帧合并
+        if (mergedSource->hasPending()) {
+            renderScheduler->requestFrame();
+        }
+        
+        // 一帧只更新一次各显示控件的行索引和滚动条，并只重绘可见行
+        for (const SessionPage &page : sessionPages) {
+            page.view->recordsAppended();
+        }
+        mergedView->recordsAppended();
+    }
+    if (groupBox_plot->isVisible()) {
+        updatePlot();
     }
     
-    plainTextEdit_receive->insertPlainText(displayText + "\n");
-    plainTextEdit_receive->moveCursor(QTextCursor::End);
+    // 计数与数据在同一帧刷新
+    updateCounters();
 }
 
 void MainWindow::on_pushButton_clearReceive_clicked()
 {
-    plainTextEdit_receive->clear();
+    // 会话页只清空该会话，合并视图清空所有会话
+    Session *session = currentSession();
+    for (const SessionPage &page : sessionPages) {
+        if (!session || page.session == session) {
+            page.session->clear();
+            page.view->reset();
+        }
+    }
+    // 只删除被清空会话的记录项，其他会话已合并的部分不变
+    mergedSource->update();
+    mergedView->reset();
+    // 接收存储清空后波形从头开始
+    if (!session || plotSession == session) {
+        plotSession = nullptr;
+    }
+    updateCounters();
 }
 
 void MainWindow::on_pushButton_clearSend_clicked()
@@ -468,44 +1091,339 @@ void MainWindow::on_pushButton_clearSend_clicked()
     plainTextEdit_send->clear();
 }
 
+void MainWindow::on_pushButton_sendFile_clicked()
+{
+    Session *session = currentSession();
+    if (!session || !session->isOpen()) {
+        return;
+    }
+    if (session->isSendingFile()) {
+        // 结果在 fileSendFinished 中提示
+        session->cancelFileSend();
+        return;
+    }
+    
+    QString fileName = QFileDialog::getOpenFileName(this, "发送文件", ".", "所有文件 (*)");
+    if (fileName.isEmpty()) {
+        return;
+    }
+    session->sendFile(fileName);
+    fileSendTimer->start(200);
+    updateSessionControls();
+}
+
+void MainWindow::updateFileSendProgress()
+{
+    // 进度、吞吐量和剩余时间由I/O线程统计，这里只定时读取
+    Session *session = currentSession();
+    if (session && session->isSendingFile()) {
+        const FileSender::Progress progress = session->fileSendProgress();
+        const qint64 seconds = progress.remainingSeconds();
+        const QString eta = seconds >= 0
+            ? QTime(0, 0).addSecs(static_cast<int>(qMin<qint64>(seconds, 86399))).toString("HH:mm:ss")
+            : QString("--:--:--");
+        progressBar_sendFile->setValue(progress.total > 0 ? static_cast<int>(progress.sent * 1000 / progress.total) : 0);
+        progressBar_sendFile->setFormat(QString("%1% %2 KB/s 剩余 %3")
+                                        .arg(progress.total > 0 ? progress.sent * 100 / progress.total : 0)
+                                        .arg(progress.throughput() / 1024, 0, 'f', 1)
+                                        .arg(eta));
+        progressBar_sendFile->show();
+    } else {
+        progressBar_sendFile->hide();
+    }
+    
+    bool active = false;
+    for (const SessionPage &page : sessionPages) {
+        active = active || page.session->isSendingFile();
+    }
+    if (!active) {
+        fileSendTimer->stop();
+    }
+    updateCounters();
+}
+
+void MainWindow::on_pushButton_replay_clicked()
+{
+    Session *session = currentSession();
+    if (!session || !session->isOpen()) {
+        return;
+    }
+    if (session->isReplaying()) {
+        // 结果在 replayFinished 中提示
+        session->stopReplay();
+        return;
+    }
+    
+    QString fileName = QFileDialog::getOpenFileName(this, "回放录制文件", ".", "录制文件 (*.scap);;所有文件 (*)");
+    if (fileName.isEmpty()) {
+        return;
+    }
+    // 顺序与下拉框一致，0 为最快
+    static const double speeds[] = {1.0, 2.0, 10.0, 0.0};
+    ReplayOptions options;
+    options.fileName = fileName;
+    options.speed = speeds[qBound(0, comboBox_replaySpeed->currentIndex(), 3)];
+    session->startReplay(options);
+    replayTimer->start(200);
+    updateSessionControls();
+}
+
+void MainWindow::updateReplayProgress()
+{
+    // 回放统计由I/O线程无锁累计，这里只定时读取
+    Session *session = currentSession();
+    if (session && session->isReplaying()) {
+        label_replayStats->setText(formatReplayStats(session->replayStats()));
+    } else {
+        label_replayStats->clear();
+    }
+    
+    bool active = false;
+    for (const SessionPage &page : sessionPages) {
+        active = active || page.session->isReplaying();
+    }
+    if (!active) {
+        replayTimer->stop();
+    }
+    updateCounters();
+}
+
 void MainWindow::on_pushButton_save_clicked()
 {
     QString fileName = QFileDialog::getSaveFileName(this, "保存接收数据", "./serial_data.txt", "文本文件 (*.txt);;所有文件 (*)");
     if (!fileName.isEmpty()) {
         QFile file(fileName);
         if (file.open(QIODevice::WriteOnly | QIODevice::Text)) {
-            QTextStream out(&file);
-            out << plainTextEdit_receive->toPlainText();
+            // 按当前显示方式逐条记录写出，不在内存中拼接整个接收区
+            // 保存当前标签页：单个会话、合并视图或录制文件
+            const ReceiveView *view = currentView();
+            const RecordSource *source = view ? view->source() : nullptr;
+            const qint64 count = source ? source->recordCount() : 0;
+            for (qint64 i = 0; i < count; ++i) {
+                const QStringList lines = view->recordLines(i);
+                for (const QString &line : lines) {
+                    file.write(line.toUtf8());
+                    file.write("\n");
+                }
+            }
             file.close();
         }
     }
 }
 
+void MainWindow::on_pushButton_record_toggled(bool checked)
+{
+    if (checked) {
+        QString fileName = QFileDialog::getSaveFileName(this, "录制收发数据", "./capture.scap", "录制文件 (*.scap);;所有文件 (*)");
+        if (fileName.isEmpty() || !startRecording(fileName)) {
+            const QSignalBlocker blocker(pushButton_record);
+            pushButton_record->setChecked(false);
+        }
+    } else {
+        stopRecording();
+    }
+}
+
+bool MainWindow::startRecording(const QString &fileName)
+{
+    if (!captureWriter->open(fileName)) {
+        statusBar()->showMessage("无法创建录制文件：" + captureWriter->errorString(), 5000);
+        return false;
+    }
+    // 录制在各会话的I/O线程中进行，数据读到时即写入，不经过界面
+    for (const SessionPage &page : sessionPages) {
+        page.session->setCaptureWriter(captureWriter);
+    }
+    pushButton_record->setText("停止录制");
+    statusBar()->showMessage("正在录制：" + fileName);
+    return true;
+}
+
+void MainWindow::stopRecording()
+{
+    // 先让所有I/O线程停止写入，再写出剩余数据和索引
+    for (const SessionPage &page : sessionPages) {
+        page.session->setCaptureWriter(nullptr);
+    }
+    const qint64 bytes = captureWriter->bytesWritten();
+    const qint64 dropped = captureWriter->droppedBytes();
+    captureWriter->close();
+    pushButton_record->setText("录制");
+    
+    QString message = QString("录制已保存：%1 字节").arg(bytes);
+    if (dropped > 0) {
+        message += QString("，写盘不及丢弃 %1 字节").arg(dropped);
+    }
+    if (!captureWriter->errorString().isEmpty()) {
+        message = "录制文件写入失败：" + captureWriter->errorString();
+    }
+    statusBar()->showMessage(message, 10000);
+}
+
+void MainWindow::on_pushButton_openCapture_clicked()
+{
+    QString fileName = QFileDialog::getOpenFileName(this, "打开录制文件", ".", "录制文件 (*.scap);;所有文件 (*)");
+    if (fileName.isEmpty()) {
+        return;
+    }
+    CaptureSource *source = new CaptureSource;
+    if (!source->open(fileName)) {
+        statusBar()->showMessage("无法打开录制文件：" + source->errorString(), 5000);
+        delete source;
+        return;
+    }
+    
+    // 文件映射后立即显示，索引在后台建立，已建好的部分随时可以浏览；已打开的录制文件被替换
+    captureView->setStore(source);
+    delete captureSource;
+    captureSource = source;
+    const QString title = QFileInfo(fileName).fileName();
+    int page = tabWidget_receive->indexOf(captureView);
+    if (page < 0) {
+        page = tabWidget_receive->addTab(captureView, title);
+    }
+    tabWidget_receive->setTabText(page, title);
+    tabWidget_receive->setCurrentIndex(page);
+    captureIndexTimer->start(100);
+    updateCaptureIndexProgress();
+}
+
+void MainWindow::updateCaptureIndexProgress()
+{
+    if (!captureSource) {
+        captureIndexTimer->stop();
+        return;
+    }
+    
+    captureView->recordsAppended();
+    if (captureSource->isIndexing()) {
+        const qint64 total = qMax<qint64>(1, captureSource->dataBytes());
+        statusBar()->showMessage(QString("正在建立索引 %1%，已索引 %2 条记录")
+                                 .arg(captureSource->indexedBytes() * 100 / total)
+                                 .arg(captureSource->recordCount()));
+    } else {
+        captureIndexTimer->stop();
+        statusBar()->showMessage(QString("%1：共 %2 条记录")
+                                 .arg(QFileInfo(captureSource->fileName()).fileName())
+                                 .arg(captureSource->recordCount()));
+    }
+}
+
+void MainWindow::on_lineEdit_jumpTime_returnPressed()
+{
+    ReceiveView *view = currentView();
+    RecordSource *source = view ? view->source() : nullptr;
+    if (!source || source->recordCount() == 0) {
+        return;
+    }
+    
+    // 完整日期时间，或只有时间（日期取第一条记录的日期）
+    const QString text = lineEdit_jumpTime->text().trimmed();
+    QDateTime time = QDateTime::fromString(text, "yyyy-MM-dd HH:mm:ss.zzz");
+    if (!time.isValid()) {
+        time = QDateTime::fromString(text, "yyyy-MM-dd HH:mm:ss");
+    }
+    if (!time.isValid()) {
+        QTime clock = QTime::fromString(text, "HH:mm:ss.zzz");
+        if (!clock.isValid()) {
+            clock = QTime::fromString(text, "HH:mm:ss");
+        }
+        if (clock.isValid()) {
+            const QDate date = QDateTime::fromMSecsSinceEpoch(source->timestamp(0) / 1000000).date();
+            time = QDateTime(date, clock);
+        }
+    }
+    if (!time.isValid()) {
+        statusBar()->showMessage("时间格式无效", 5000);
+        return;
+    }
+    
+    const qint64 record = source->findRecord(time.toMSecsSinceEpoch() * 1000000);
+    view->scrollToRecord(record);
+}
+
 void MainWindow::on_checkBox_hexSend_stateChanged(int arg1)
 {
     Q_UNUSED(arg1);
-    // 可以添加一些逻辑来处理十六进制发送状态变化
+    // 日志中的发送记录按新方式重新显示，自动发送的内容按新方式重新编码
+    updateRenderOptions();
+    updateAutoSendPayload();
 }
 
 void MainWindow::on_checkBox_hexReceive_stateChanged(int arg1)
 {
     Q_UNUSED(arg1);
-    // 可以添加一些逻辑来处理十六进制接收状态变化
+    // 历史数据按新方式重新显示
+    updateRenderOptions();
 }
 
 void MainWindow::on_checkBox_autoSend_stateChanged(int arg1)
 {
-    if (arg1 == Qt::Checked) {
-        int interval = spinBox_autoSendInterval->value();
-        autoSendTimer->start(interval);
-    } else {
-        autoSendTimer->stop();
+    // 每个会话有自己的自动发送调度器；发送内容在这里编码一次，之后每个周期直接发送编码好的数据
+    Session *session = currentSession();
+    if (!session) {
+        return;
+    }
+    if (arg1 != Qt::Checked) {
+        session->stopAutoSend();
+        updateAutoSendStats();
+        return;
+    }
+    
+    QByteArray payload;
+    if (!session->isOpen() || !encodeSendData(&payload, true) || payload.isEmpty()) {
+        const QSignalBlocker blocker(checkBox_autoSend);
+        checkBox_autoSend->setChecked(false);
+        return;
     }
+    session->startAutoSend(payload, spinBox_autoSendInterval->value(), spinBox_autoSendBurst->value());
+    autoSendStatsTimer->start(500);
 }
 
-void MainWindow::autoSendData()
+void MainWindow::updateAutoSendSchedule()
 {
-    on_pushButton_send_clicked();
+    // 周期或突发次数改变时，当前会话的自动发送按新参数重新开始
+    Session *session = currentSession();
+    if (session && session->isAutoSending()) {
+        on_checkBox_autoSend_stateChanged(Qt::Checked);
+    }
+}
+
+void MainWindow::updateAutoSendPayload()
+{
+    // 发送框内容或编码方式改变时重新编码一次，交给所有正在自动发送的会话；内容无效时继续发送原来的数据
+    bool active = false;
+    for (const SessionPage &page : sessionPages) {
+        active = active || page.session->isAutoSending();
+    }
+    QByteArray payload;
+    if (!active || !encodeSendData(&payload, false) || payload.isEmpty()) {
+        return;
+    }
+    for (const SessionPage &page : sessionPages) {
+        page.session->setAutoSendPayload(payload);
+    }
+}
+
+void MainWindow::updateAutoSendStats()
+{
+    // 自动发送不经过界面，计数和速率定时从调度器读取
+    Session *session = currentSession();
+    if (session && session->isAutoSending()) {
+        const SendScheduler::Stats stats = session->autoSendStats();
+        label_autoSendStats->setText(QString("%1 次/秒 错过 %2").arg(stats.rate(), 0, 'f', 1).arg(stats.missed));
+    } else {
+        label_autoSendStats->clear();
+    }
+    
+    bool active = false;
+    for (const SessionPage &page : sessionPages) {
+        active = active || page.session->isAutoSending();
+    }
+    if (!active) {
+        autoSendStatsTimer->stop();
+    }
+    updateCounters();
 }
 
 void MainWindow::on_comboBox_baudRate_currentIndexChanged(int index)
@@ -541,13 +1459,68 @@ void MainWindow::on_comboBox_flowControl_currentIndexChanged(int index)
 void MainWindow::on_comboBox_sendCodec_currentIndexChanged(int index)
 {
     Q_UNUSED(index);
-    // 发送编码变化
+    // 发送编码变化：只在这里重建编码器，日志中的发送记录按新编码重新显示
+    sendCodec.setName(comboBox_sendCodec->currentText());
+    updateRenderOptions();
+    updateAutoSendPayload();
 }
 
 void MainWindow::on_comboBox_receiveCodec_currentIndexChanged(int index)
 {
     Q_UNUSED(index);
-    // 接收编码变化
+    // 接收编码变化：只在这里重建解码器，历史数据按新编码重新显示
+    receiveCodec.setName(comboBox_receiveCodec->currentText());
+    updateRenderOptions();
+}
+
+void MainWindow::on_comboBox_framing_currentIndexChanged(int index)
+{
+    // 切换分帧方式时参数框显示该方式当前的参数
+    FramingConfig config = framingConfig;
+    config.mode = static_cast<FramingConfig::Mode>(index);
+    lineEdit_framingParameter->setText(config.parameter());
+    lineEdit_framingParameter->setEnabled(!config.parameter().isEmpty());
+    applyFramingConfig(config);
+    saveSettings();
+}
+
+void MainWindow::on_lineEdit_framingParameter_editingFinished()
+{
+    FramingConfig config = framingConfig;
+    QString errorString;
+    if (!config.setParameter(lineEdit_framingParameter->text(), &errorString)) {
+        statusBar()->showMessage("分帧参数错误：" + errorString, 5000);
+        lineEdit_framingParameter->setText(config.parameter());
+        return;
+    }
+    if (config.parameter() != framingConfig.parameter()) {
+        applyFramingConfig(config);
+        saveSettings();
+    }
+    lineEdit_framingParameter->setText(config.parameter());
+}
+
+void MainWindow::on_comboBox_checksum_currentIndexChanged(int index)
+{
+    // 换校验方式时字节序先改为该方式的惯用字节序，单字节校验不区分字节序
+    const Checksum::Type type = static_cast<Checksum::Type>(index);
+    const QSignalBlocker blocker(checkBox_checksumBigEndian);
+    checkBox_checksumBigEndian->setChecked(Checksum::defaultBigEndian(type));
+    checkBox_checksumBigEndian->setEnabled(Checksum::size(type) > 1);
+    FramingConfig config = framingConfig;
+    config.checksum = Checksum(type, checkBox_checksumBigEndian->isChecked());
+    applyFramingConfig(config);
+    updateAutoSendPayload();
+    saveSettings();
+}
+
+void MainWindow::on_checkBox_checksumBigEndian_toggled(bool checked)
+{
+    FramingConfig config = framingConfig;
+    config.checksum = Checksum(config.checksum.type(), checked);
+    applyFramingConfig(config);
+    updateAutoSendPayload();
+    saveSettings();
 }
 
 void MainWindow::saveSettings()
@@ -557,7 +1530,258 @@ void MainWindow::saveSettings()
     QSettings settings(configPath, QSettings::IniFormat);
     settings.setValue("timestamp", checkBox_timestamp->isChecked());
     settings.setValue("logMode", checkBox_logMode->isChecked());
+    settings.setValue("timestampPrecision", comboBox_timestampPrecision->currentIndex());
+    settings.setValue("timestampDelta", checkBox_timestampDelta->isChecked());
     settings.setValue("hexReceive", checkBox_hexReceive->isChecked());
     settings.setValue("hexSend", checkBox_hexSend->isChecked());
+    settings.setValue("renderFps", spinBox_renderFps->value());
+    settings.setValue("framingMode", comboBox_framing->currentIndex());
+    settings.setValue("framingParameter", lineEdit_framingParameter->text());
+    settings.setValue("checksumType", comboBox_checksum->currentIndex());
+    settings.setValue("checksumBigEndian", checkBox_checksumBigEndian->isChecked());
+    settings.setValue("appendChecksum", checkBox_appendChecksum->isChecked());
+    settings.setValue("bridgeAddress", lineEdit_bridge->text());
+    settings.setValue("triggerRules", plainTextEdit_triggers->toPlainText());
     settings.sync(); // 强制写入文件，确保设置立即保存
+}
+
+void MainWindow::on_checkBox_stats_toggled(bool checked)
+{
+    groupBox_stats->setVisible(checked);
+    if (checked) {
+        statsTimer->start(500);
+        updateStatsPanel();
+    } else {
+        statsTimer->stop();
+    }
+}
+
+void MainWindow::on_checkBox_plot_toggled(bool checked)
+{
+    groupBox_plot->setVisible(checked);
+    if (checked) {
+        updatePlot();
+    }
+}
+
+void MainWindow::on_checkBox_trigger_toggled(bool checked)
+{
+    groupBox_trigger->setVisible(checked);
+    if (checked) {
+        triggerTimer->start(500);
+        updateTriggerStats();
+    } else {
+        triggerTimer->stop();
+    }
+}
+
+void MainWindow::on_pushButton_applyTriggers_clicked()
+{
+    // 规则文本在应用时保存；有错时保持原来的规则不变
+    saveSettings();
+    QVector<TriggerRule> rules;
+    QString errorString;
+    if (checkBox_triggerEnabled->isChecked()
+        && !TriggerRule::parseList(plainTextEdit_triggers->toPlainText(), &rules, &errorString)) {
+        statusBar()->showMessage("触发规则错误：" + errorString, 5000);
+        return;
+    }
+    triggerRules = rules;
+    for (const SessionPage &page : sessionPages) {
+        page.session->setTriggerRules(rules);
+    }
+    statusBar()->showMessage(rules.isEmpty() ? QString("触发已停用") : QString("已应用 %1 条触发规则").arg(rules.size()), 5000);
+    updateTriggerStats();
+}
+
+void MainWindow::updateTriggerStats()
+{
+    // 会话页显示该会话的触发统计，合并视图显示所有会话的合计
+    Session *session = currentSession();
+    qint64 matches = 0;
+    qint64 latencySum = 0;
+    qint64 maxLatency = 0;
+    qint64 lastLatency = 0;
+    for (const SessionPage &page : sessionPages) {
+        if (!session || page.session == session) {
+            const TriggerEngine::Stats stats = page.session->triggerStats();
+            matches += stats.matches;
+            latencySum += stats.latencySum;
+            maxLatency = qMax(maxLatency, stats.maxLatency);
+            if (stats.matches > 0) {
+                lastLatency = stats.lastLatency;
+            }
+        }
+    }
+    if (triggerRules.isEmpty()) {
+        label_triggerStats->setText("未启用");
+    } else if (matches == 0) {
+        label_triggerStats->setText(QString("%1 条规则，尚未触发").arg(triggerRules.size()));
+    } else {
+        label_triggerStats->setText(QString("触发 %1 次  响应延迟 最近 %2  平均 %3  最大 %4 微秒")
+                                    .arg(matches)
+                                    .arg(lastLatency / 1000.0, 0, 'f', 1)
+                                    .arg(static_cast<double>(latencySum) / matches / 1000.0, 0, 'f', 1)
+                                    .arg(maxLatency / 1000.0, 0, 'f', 1));
+    }
+}
+
+void MainWindow::onTriggerFired(TriggerRule::Action action)
+{
+    switch (action) {
+    case TriggerRule::StartRecord:
+        // 由触发开始时不弹出对话框，按时间命名保存在程序目录
+        if (!captureWriter->isOpen()) {
+            const QString fileName = QCoreApplication::applicationDirPath()
+                + QDateTime::currentDateTime().toString("/'capture-'yyyyMMdd-HHmmss'.scap'");
+            const QSignalBlocker blocker(pushButton_record);
+            pushButton_record->setChecked(startRecording(fileName));
+        }
+        break;
+    case TriggerRule::StopRecord:
+        // 触发的会话已在I/O线程中停止写入，这里关闭文件
+        if (captureWriter->isOpen()) {
+            const QSignalBlocker blocker(pushButton_record);
+            pushButton_record->setChecked(false);
+            stopRecording();
+        }
+        break;
+    case TriggerRule::PauseDisplay:
+        pushButton_pauseDisplay->setChecked(true);
+        break;
+    default:
+        break;
+    }
+}
+
+void MainWindow::on_pushButton_pauseDisplay_toggled(bool checked)
+{
+    if (!checked) {
+        // 恢复后在下一帧补上暂停期间的数据
+        renderScheduler->requestFrame();
+    }
+}
+
+void MainWindow::on_comboBox_plotWindow_currentIndexChanged(int index)
+{
+    plotView->setWindow(comboBox_plotWindow->itemData(index).toLongLong());
+}
+
+void MainWindow::on_pushButton_clearPlot_clicked()
+{
+    // 只清除已画出的采样，之后收到的数据继续画
+    plotView->clear();
+    updatePlot();
+}
+
+void MainWindow::updatePlot()
+{
+    // 波形跟随当前会话页；合并视图和录制文件页上继续显示原来的会话
+    Session *session = currentSession();
+    if (!session) {
+        session = plotSession;
+    }
+    if (!session && !sessionPages.isEmpty()) {
+        session = sessionPages.first().session;
+    }
+    ChunkStore *store = session ? session->store() : nullptr;
+    const qint64 count = store ? store->recordCount() : 0;
+    if (session != plotSession || plotRecord > count) {
+        // 换了会话或接收区被清空：从最近的一部分记录开始重新解析，不回溯全部历史
+        plotSession = session;
+        plotRecord = qMax<qint64>(0, count - PLOT_BACKFILL_RECORDS);
+        plotView->clear();
+    }
+    
+    // 在界面线程中解析接收存储里的记录，不占用I/O线程；一帧解析不完的留到下一帧
+    const qint64 end = qMin(count, plotRecord + PLOT_RECORDS_PER_FRAME);
+    for (; plotRecord < end; ++plotRecord) {
+        if (store->direction(plotRecord) != RecordDirection::Rx) {
+            continue;
+        }
+        const Record record = store->record(plotRecord);
+        if (record.flags & RecordMarker) {
+            continue;
+        }
+        plotView->feed(record.data.constData(), record.data.size());
+    }
+    if (end < count) {
+        renderScheduler->requestFrame();
+    }
+    
+    label_plotInfo->setText(QString("%1 个通道，%2 行").arg(plotView->channelCount()).arg(plotView->lineCount()));
+    plotView->update();
+}
+
+void MainWindow::updateStatsPanel()
+{
+    // 统计由各会话的I/O线程无锁累计，这里只定时读取一次快照；合并视图显示所有会话的合计
+    Session *session = currentSession();
+    const qint64 now = TimestampClock::now();
+    LinkStats::Snapshot stats;
+    for (const SessionPage &page : sessionPages) {
+        if (!session || page.session == session) {
+            stats.merge(page.session->stats()->snapshot(now));
+        }
+    }
+    
+    // 利用率 = 实际位速率 / 波特率，收发方向分别计算；多个会话合计时不计算
+    auto utilization = [session](double bytesPerSecond) {
+        if (!session || !session->isOpen() || session->config().baudRate <= 0) {
+            return QString("-");
+        }
+        const SerialConfig config = session->config();
+        return QString("%1%").arg(bytesPerSecond * bitsPerCharacter(config) * 100 / config.baudRate, 0, 'f', 1);
+    };
+    auto rateLine = [](const QString &name, const LinkStats::Rate &rate, const QString &unit, const QString &extra) {
+        return QString("%1  1秒 %2  10秒 %3  峰值 %4  累计 %5%6\n")
+            .arg(name)
+            .arg(unit.isEmpty() ? formatRate(rate.current) : QString("%1 %2").arg(rate.current, 0, 'f', 1).arg(unit), -12)
+            .arg(unit.isEmpty() ? formatRate(rate.average) : QString("%1 %2").arg(rate.average, 0, 'f', 1).arg(unit), -12)
+            .arg(unit.isEmpty() ? formatRate(rate.peak) : QString("%1 %2").arg(rate.peak, 0, 'f', 1).arg(unit), -12)
+            .arg(rate.total)
+            .arg(extra);
+    };
+    
+    QString text;
+    text += rateLine("接收", stats.rxBytes, QString(), "  利用率 " + utilization(stats.rxBytes.current));
+    text += rateLine("发送", stats.txBytes, QString(), "  利用率 " + utilization(stats.txBytes.current));
+    text += rateLine("帧  ", stats.frames, "帧/秒", QString("  分帧错误 %1  校验错误 %2").arg(stats.frameErrors).arg(stats.checksumErrors));
+    text += rateLine("读取", stats.reads, "次/秒", QString());
+    
+    // 读取间隔分布，只列出有计数的区间
+    qint64 maxGap = 0;
+    for (int i = 0; i < LinkStats::HISTOGRAM_BUCKETS; ++i) {
+        maxGap = qMax(maxGap, stats.gaps[i]);
+    }
+    text += "\n读取间隔分布\n";
+    for (int i = 0; i < LinkStats::HISTOGRAM_BUCKETS; ++i) {
+        if (stats.gaps[i] > 0) {
+            const int bar = static_cast<int>(stats.gaps[i] * 40 / maxGap);
+            text += QString("  %1 %2 %3\n").arg(gapBucketName(i), -12).arg(QString(qMax(1, bar), QChar(0x2588)), -40).arg(stats.gaps[i]);
+        }
+    }
+    
+    QStringList errors;
+    for (int i = 0; i < LinkStats::ERROR_KINDS; ++i) {
+        if (stats.errors[i] > 0) {
+            errors.append(QString("%1 %2").arg(serialErrorName(i)).arg(stats.errors[i]));
+        }
+    }
+    text += "\n串口错误  " + (errors.isEmpty() ? QString("无") : errors.join("，"));
+    label_stats->setText(text);
+}
+
+void MainWindow::on_checkBox_bridge_toggled(bool checked)
+{
+    // 监听结果通过 bridgeChanged/bridgeFailed 返回后再刷新复选框
+    Session *session = currentSession();
+    if (!session) {
+        return;
+    }
+    if (checked) {
+        session->startBridge(lineEdit_bridge->text().trimmed());
+    } else {
+        session->stopBridge();
+    }
 }
\ No newline at end of file
@@ -2,8 +2,9 @@
 #define MAINWINDOW_H
 
 #include <QMainWindow>
-#include <QSerialPort>
 #include <QSerialPortInfo>
+#include <QThread>
+#include <QElapsedTimer>
 #include <QtCore5Compat/QTextCodec>
 #include <QTimer>
 #include <QVBoxLayout>
@@ -16,7 +17,24 @@
 #include <QCheckBox>
 #include <QSpinBox>
 #include <QPlainTextEdit>
+#include <QProgressBar>
+#include <QLineEdit>
 #include <QStatusBar>
+#include <QTabWidget>
+
+#include "serialworker.h"
+#include "renderscheduler.h"
+#include "capturefile.h"
+#include "capturesource.h"
+#include "framer.h"
+#include "mergedsource.h"
+#include "plotview.h"
+#include "popupcombobox.h"
+#include "portwatcher.h"
+#include "receiveview.h"
+#include "session.h"
+#include "sessioncodec.h"
+#include "timestamp.h"
 
 class MainWindow : public QMainWindow
 {
@@ -27,11 +45,16 @@ public:
     ~MainWindow();
 
 private slots:
-    void on_pushButton_refresh_clicked();
+    void updateSerialPorts(const QStringList &names, const QStringList &descriptions);
+    void loadCodecList();
     void on_pushButton_open_clicked();
+    void on_pushButton_newSession_clicked();
+    void on_tabWidget_receive_currentChanged(int index);
+    void on_tabWidget_receive_tabCloseRequested(int index);
     void on_pushButton_send_clicked();
     void on_pushButton_clearReceive_clicked();
     void on_pushButton_clearSend_clicked();
+    void on_pushButton_sendFile_clicked();
     void on_pushButton_save_clicked();
     void on_checkBox_hexSend_stateChanged(int arg1);
     void on_checkBox_hexReceive_stateChanged(int arg1);
@@ -43,24 +66,73 @@ private slots:
     void on_comboBox_flowControl_currentIndexChanged(int index);
     void on_comboBox_sendCodec_currentIndexChanged(int index);
     void on_comboBox_receiveCodec_currentIndexChanged(int index);
+    void on_comboBox_framing_currentIndexChanged(int index);
+    void on_lineEdit_framingParameter_editingFinished();
+    void on_comboBox_checksum_currentIndexChanged(int index);
+    void on_checkBox_checksumBigEndian_toggled(bool checked);
+    void on_pushButton_record_toggled(bool checked);
+    void on_pushButton_openCapture_clicked();
+    void on_lineEdit_jumpTime_returnPressed();
+    void updateCaptureIndexProgress();
+    void updateAutoSendSchedule();
+    void updateAutoSendPayload();
+    void updateAutoSendStats();
+    void updateFileSendProgress();
+    void on_pushButton_replay_clicked();
+    void updateReplayProgress();
+    void on_checkBox_stats_toggled(bool checked);
+    void updateStatsPanel();
+    void on_checkBox_bridge_toggled(bool checked);
+    void on_checkBox_plot_toggled(bool checked);
+    void on_comboBox_plotWindow_currentIndexChanged(int index);
+    void on_pushButton_clearPlot_clicked();
+    void on_checkBox_trigger_toggled(bool checked);
+    void on_pushButton_applyTriggers_clicked();
+    void updateTriggerStats();
+    void on_pushButton_pauseDisplay_toggled(bool checked);
     
-    void readData();
-    void autoSendData();
+    void renderFrame();
     void saveSettings();
     
 private:
-    QSerialPort *serial;
-    QTimer *autoSendTimer;
-    qint64 sendBytes;
-    qint64 receiveBytes;
+    // 一个会话标签页：会话和显示它的接收区
+    struct SessionPage
+    {
+        Session *session;
+        ReceiveView *view;
+    };
+    
+    RenderScheduler *renderScheduler;
+    PortWatcher *portWatcher;       // 后台线程枚举串口并监视热插拔
+    QStringList knownPorts;         // 上次枚举到的串口，用于提示插入和拔出
+    bool portsScanned;
+    bool codecListLoaded;           // 编码下拉框第一次展开时才填充完整列表
+    QVector<SessionPage> sessionPages;
+    MergedSource *mergedSource;     // 所有会话按时间合并的记录
+    qint64 receiveMemoryBudget;     // 每个会话接收区的内存预算，超出部分写入临时文件
+    HexFormatOptions hexFormat;     // 十六进制显示格式，来自配置文件
+    SessionCodec sendCodec;         // 编码只在下拉框改变时重建，所有会话共用
+    SessionCodec receiveCodec;
+    FramingConfig framingConfig;    // 所有会话共用的分帧方式
+    CaptureWriter *captureWriter;   // 录制文件，由各会话的I/O线程直接写入
+    CaptureSource *captureSource;   // 正在浏览的录制文件，未打开时为空
+    QTimer *captureIndexTimer;      // 录制文件建立索引期间定时刷新显示
+    QTimer *autoSendStatsTimer;     // 自动发送期间定时刷新发送计数和速率
+    QTimer *fileSendTimer;          // 发送文件期间定时刷新进度
+    QTimer *replayTimer;            // 回放期间定时刷新进度和定时误差
+    QTimer *statsTimer;             // 统计面板显示期间定时刷新
+    Session *plotSession;           // 波形显示的数据来源，跟随当前会话页
+    qint64 plotRecord;              // 下一条要送入波形解析的接收记录
+    QVector<TriggerRule> triggerRules;  // 生效中的触发规则，所有会话共用，停用时为空
+    QTimer *triggerTimer;           // 触发面板显示期间定时刷新触发次数和响应延迟
     
     // UI组件
     QGroupBox *groupBox_serialConfig;
     QGridLayout *gridLayout_serialConfig;
     QLabel *label_portName;
     QComboBox *comboBox_portName;
-    QPushButton *pushButton_refresh;
     QPushButton *pushButton_open;
+    QPushButton *pushButton_newSession;
     QLabel *label_status;
     QLabel *label_baudRate;
     QComboBox *comboBox_baudRate;
@@ -72,23 +144,46 @@ private:
     QComboBox *comboBox_parity;
     QLabel *label_flowControl;
     QComboBox *comboBox_flowControl;
+    QLabel *label_bridge;
+    QLineEdit *lineEdit_bridge;
+    QCheckBox *checkBox_bridge;
+    QLabel *label_bridgeStatus;
     
     QGroupBox *groupBox_codecConfig;
     QHBoxLayout *horizontalLayout_codec;
     QLabel *label_sendCodec;
-    QComboBox *comboBox_sendCodec;
+    PopupComboBox *comboBox_sendCodec;
     QLabel *label_receiveCodec;
-    QComboBox *comboBox_receiveCodec;
+    PopupComboBox *comboBox_receiveCodec;
+    QLabel *label_framing;
+    QComboBox *comboBox_framing;
+    QLineEdit *lineEdit_framingParameter;
+    QLabel *label_checksum;
+    QComboBox *comboBox_checksum;
+    QCheckBox *checkBox_checksumBigEndian;
+    QCheckBox *checkBox_appendChecksum;
     
     QGroupBox *groupBox_receive;
     QVBoxLayout *verticalLayout_receive;
     QHBoxLayout *horizontalLayout_receiveOptions;
     QCheckBox *checkBox_hexReceive;
     QCheckBox *checkBox_timestamp;
+    QComboBox *comboBox_timestampPrecision;
+    QCheckBox *checkBox_timestampDelta;
     QCheckBox *checkBox_logMode;
+    QSpinBox *spinBox_renderFps;
+    QLabel *label_fps;
     QPushButton *pushButton_clearReceive;
     QPushButton *pushButton_save;
-    QPlainTextEdit *plainTextEdit_receive;
+    QPushButton *pushButton_record;
+    QPushButton *pushButton_pauseDisplay;
+    QHBoxLayout *horizontalLayout_capture;
+    QPushButton *pushButton_openCapture;
+    QLineEdit *lineEdit_jumpTime;
+    // 第一页为合并视图，其后每个会话一页，打开的录制文件单独一页
+    QTabWidget *tabWidget_receive;
+    ReceiveView *mergedView;
+    ReceiveView *captureView;
     
     QGroupBox *groupBox_send;
     QVBoxLayout *verticalLayout_send;
@@ -97,21 +192,58 @@ private:
     QCheckBox *checkBox_autoSend;
     QSpinBox *spinBox_autoSendInterval;
     QLabel *label_ms;
+    QSpinBox *spinBox_autoSendBurst;
+    QLabel *label_autoSendStats;
     QPlainTextEdit *plainTextEdit_send;
     QHBoxLayout *horizontalLayout_sendButtons;
     QPushButton *pushButton_send;
     QPushButton *pushButton_clearSend;
+    QPushButton *pushButton_sendFile;
+    QProgressBar *progressBar_sendFile;
+    QPushButton *pushButton_replay;
+    QComboBox *comboBox_replaySpeed;
+    QLabel *label_replayStats;
+    
+    QGroupBox *groupBox_stats;
+    QLabel *label_stats;
+    
+    QGroupBox *groupBox_plot;
+    QComboBox *comboBox_plotWindow;
+    QPushButton *pushButton_clearPlot;
+    QLabel *label_plotInfo;
+    PlotView *plotView;
+    
+    QGroupBox *groupBox_trigger;
+    QPlainTextEdit *plainTextEdit_triggers;
+    QCheckBox *checkBox_triggerEnabled;
+    QPushButton *pushButton_applyTriggers;
+    QLabel *label_triggerStats;
     
     QHBoxLayout *horizontalLayout_status;
     QLabel *label_sendCount;
+    QCheckBox *checkBox_stats;
+    QCheckBox *checkBox_plot;
+    QCheckBox *checkBox_trigger;
     QLabel *label_receiveCount;
     
     void initUI();
-    void updateSerialPorts();
-    void updateCodecList();
-    QString byteArrayToHexString(const QByteArray &data);
-    QByteArray hexStringToByteArray(const QString &hex);
-    QByteArray encodeData(const QString &text, const QString &codecName);
-    QString decodeData(const QByteArray &data, const QString &codecName);
+    void updateRenderOptions();
+    void updateSessionControls();
+    void updateCounters();
+    void updatePlot();
+    Session *addSession();
+    void removeSession(int page);
+    // 当前标签页对应的会话，合并视图和录制文件页返回空
+    Session *currentSession() const;
+    ReceiveView *currentView() const;
+    int pageOf(const Session *session) const;
+    void sendTo(Session *session);
+    // 按十六进制或发送编码把发送框内容编码为字节
+    bool encodeSendData(QByteArray *data, bool showError);
+    void applyFramingConfig(const FramingConfig &config);
+    bool startRecording(const QString &fileName);
+    void stopRecording();
+    // 执行需要界面参与的触发动作
+    void onTriggerFired(TriggerRule::Action action);
 };
 #endif // MAINWINDOW_H
\ No newline at end of file
@@ -0,0 +1,188 @@
+#include "mergedsource.h"
+#include "timestamp.h"
+
+#include <algorithm>
+#include <limits>
+
+// 记录项中来源序号的位置
+static const int SOURCE_SHIFT = 48;
+static const quint64 RECORD_MASK = (Q_UINT64_C(1) << SOURCE_SHIFT) - 1;
+// 记录从I/O线程到达存储的最长延迟（纳秒），早于 当前时刻-HOLD_BACK 的记录不再等待其他来源
+static const qint64 HOLD_BACK = 200 * 1000 * 1000;
+
+MergedSource::MergedSource()
+    : pending(false)
+{
+}
+
+void MergedSource::addSource(const RecordSource *source, const QString &label)
+{
+    if (!source || findSource(source) >= 0) {
+        return;
+    }
+    inputs.push_back({source, label, 0});
+}
+
+void MergedSource::removeSource(const RecordSource *source)
+{
+    const int index = findSource(source);
+    if (index < 0) {
+        return;
+    }
+    // 删除该来源的记录项，之后的来源序号减一，其余记录项保持原有顺序
+    removeEntries(static_cast<size_t>(index));
+    const quint64 source = static_cast<quint64>(index);
+    for (quint64 &entry : entries) {
+        if ((entry >> SOURCE_SHIFT) > source) {
+            entry -= Q_UINT64_C(1) << SOURCE_SHIFT;
+        }
+    }
+    inputs.erase(inputs.begin() + index);
+}
+
+void MergedSource::setLabel(const RecordSource *source, const QString &label)
+{
+    const int index = findSource(source);
+    if (index >= 0) {
+        inputs[static_cast<size_t>(index)].label = label;
+    }
+}
+
+qint64 MergedSource::update()
+{
+    // 各来源内部已按时间有序，之后到达的记录不会早于它当前的最新记录（也不会早于 当前时刻-HOLD_BACK），
+    // 所以只有不晚于各来源下界中最小值的记录可以合并，其余留到下一帧
+    bool cleared = false;
+    std::vector<qint64> ends(inputs.size());
+    qint64 watermark = std::numeric_limits<qint64>::max();
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        ends[i] = inputs[i].source->recordCount();
+        if (ends[i] < inputs[i].merged) {
+            removeEntries(i);
+            inputs[i].merged = 0;
+            cleared = true;
+        }
+        const qint64 newest = ends[i] > 0 ? inputs[i].source->timestamp(ends[i] - 1) : std::numeric_limits<qint64>::min();
+        watermark = std::min(watermark, newest);
+    }
+    watermark = std::max(watermark, TimestampClock::now() - HOLD_BACK);
+    
+    // 只对新增部分做多路归并；会话数很少，每次线性选出最早的一条即可
+    std::vector<qint64> heads(inputs.size());
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        if (inputs[i].merged < ends[i]) {
+            heads[i] = inputs[i].source->timestamp(inputs[i].merged);
+        }
+    }
+    const size_t before = entries.size();
+    for (;;) {
+        int earliest = -1;
+        for (size_t i = 0; i < inputs.size(); ++i) {
+            if (inputs[i].merged < ends[i] && heads[i] <= watermark
+                && (earliest < 0 || heads[i] < heads[static_cast<size_t>(earliest)])) {
+                earliest = static_cast<int>(i);
+            }
+        }
+        if (earliest < 0) {
+            break;
+        }
+        Input &input = inputs[static_cast<size_t>(earliest)];
+        entries.push_back((static_cast<quint64>(earliest) << SOURCE_SHIFT) | static_cast<quint64>(input.merged));
+        ++input.merged;
+        if (input.merged < ends[static_cast<size_t>(earliest)]) {
+            heads[static_cast<size_t>(earliest)] = input.source->timestamp(input.merged);
+        }
+    }
+    
+    pending = false;
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        pending = pending || inputs[i].merged < ends[i];
+    }
+    return cleared ? -1 : static_cast<qint64>(entries.size() - before);
+}
+
+bool MergedSource::hasPending() const
+{
+    return pending;
+}
+
+qint64 MergedSource::recordCount() const
+{
+    return static_cast<qint64>(entries.size());
+}
+
+qint64 MergedSource::recordLength(qint64 index) const
+{
+    if (index < 0 || index >= recordCount()) {
+        return 0;
+    }
+    return inputOf(index).source->recordLength(recordOf(index));
+}
+
+int MergedSource::lineBreaks(qint64 index) const
+{
+    if (index < 0 || index >= recordCount()) {
+        return 0;
+    }
+    return inputOf(index).source->lineBreaks(recordOf(index));
+}
+
+RecordDirection MergedSource::direction(qint64 index) const
+{
+    if (index < 0 || index >= recordCount()) {
+        return RecordDirection::Rx;
+    }
+    return inputOf(index).source->direction(recordOf(index));
+}
+
+qint64 MergedSource::timestamp(qint64 index) const
+{
+    if (index < 0 || index >= recordCount()) {
+        return 0;
+    }
+    return inputOf(index).source->timestamp(recordOf(index));
+}
+
+Record MergedSource::record(qint64 index) const
+{
+    if (index < 0 || index >= recordCount()) {
+        return Record();
+    }
+    return inputOf(index).source->record(recordOf(index));
+}
+
+QString MergedSource::recordLabel(qint64 index) const
+{
+    if (index < 0 || index >= recordCount()) {
+        return QString();
+    }
+    return inputOf(index).label;
+}
+
+int MergedSource::findSource(const RecordSource *source) const
+{
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        if (inputs[i].source == source) {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+void MergedSource::removeEntries(size_t input)
+{
+    const quint64 source = static_cast<quint64>(input);
+    entries.erase(std::remove_if(entries.begin(), entries.end(), [source](quint64 entry) {
+        return (entry >> SOURCE_SHIFT) == source;
+    }), entries.end());
+}
+
+const MergedSource::Input &MergedSource::inputOf(qint64 index) const
+{
+    return inputs[static_cast<size_t>(entries[static_cast<size_t>(index)] >> SOURCE_SHIFT)];
+}
+
+qint64 MergedSource::recordOf(qint64 index) const
+{
+    return static_cast<qint64>(entries[static_cast<size_t>(index)] & RECORD_MASK);
+}
\ No newline at end of file
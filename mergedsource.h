@@ -0,0 +1,59 @@
+#ifndef MERGEDSOURCE_H
+#define MERGEDSOURCE_H
+
+#include <QString>
+#include <vector>
+
+#include "recordsource.h"
+
+// 多个串口会话的合并视图
+// 不复制数据，只保存 (来源, 记录序号) 对；每个显示帧从各来源上次合并到的位置继续多路归并，追加到末尾。
+// 某个来源之后可能到达更早的记录时（它的最新记录还早于其他来源），晚于该时刻的记录暂缓合并，
+// 直到各来源都追上或超过 HOLD_BACK 的等待时间，因此不同帧之间的记录也按时间排序。
+// 来源被清空或移除时只删除它的记录项，不会重新遍历其他来源（已写入磁盘的数据块不会被读回）。
+// 记录标签为来源的名称（端口名），显示在每条记录前。
+class MergedSource : public RecordSource
+{
+public:
+    MergedSource();
+    
+    MergedSource(const MergedSource &) = delete;
+    MergedSource &operator=(const MergedSource &) = delete;
+    
+    void addSource(const RecordSource *source, const QString &label);
+    // 删除该来源的记录项，调用者应随后重置显示控件
+    void removeSource(const RecordSource *source);
+    void setLabel(const RecordSource *source, const QString &label);
+    
+    // 合并各来源新增的记录，返回新增的记录数；发现来源被清空时删除它的记录项并返回 -1
+    qint64 update();
+    // 是否有暂缓合并的记录，调用者应在稍后再次 update
+    bool hasPending() const;
+    
+    qint64 recordCount() const override;
+    qint64 recordLength(qint64 index) const override;
+    int lineBreaks(qint64 index) const override;
+    RecordDirection direction(qint64 index) const override;
+    qint64 timestamp(qint64 index) const override;
+    Record record(qint64 index) const override;
+    QString recordLabel(qint64 index) const override;
+
+private:
+    struct Input
+    {
+        const RecordSource *source;
+        QString label;
+        qint64 merged;          // 已合并的记录数
+    };
+    
+    int findSource(const RecordSource *source) const;
+    void removeEntries(size_t input);
+    const Input &inputOf(qint64 index) const;
+    qint64 recordOf(qint64 index) const;
+    
+    std::vector<Input> inputs;
+    std::vector<quint64> entries;   // 高16位为来源序号，低48位为来源中的记录序号
+    bool pending;
+};
+
+#endif // MERGEDSOURCE_H
\ No newline at end of file
@@ -0,0 +1,12 @@
+#ifndef OUTPUTBACKLOG_H
+#define OUTPUTBACKLOG_H
+
+#include <QtGlobal>
+
+// 定时发送和回放向串口输出缓冲区写入时共用的积压限制
+// 按时刻写入时，输出缓冲区中尚未写出的数据超过该值就等写出后再继续，避免波特率跟不上时缓冲区无限增长
+static const qint64 OUTPUT_MAX_PENDING_BYTES = 64 * 1024;
+// 不限速连续写入时，输出缓冲区低于该值就补一批，由串口写出速度决定节奏
+static const qint64 OUTPUT_LOW_WATER = 4096;
+
+#endif // OUTPUTBACKLOG_H
\ No newline at end of file
@@ -0,0 +1,119 @@
+#include "plotseries.h"
+#include <algorithm>
+
+PlotSeries::PlotSeries(qint64 capacityHint)
+    : mask(0)
+    , count(0)
+{
+    qint64 size = BLOCK;
+    while (size < capacityHint) {
+        size <<= 1;
+    }
+    mask = size - 1;
+}
+
+void PlotSeries::append(qint64 x, float value)
+{
+    const qint64 index = count++;
+    const qint64 block = index / BLOCK;
+    const qint64 blockSlot = block & (mask / BLOCK);
+    if (index <= mask) {
+        // 还没有写满容量，缓冲区随数据增长
+        xs.push_back(x);
+        values.push_back(value);
+        if (index % BLOCK == 0) {
+            blockMin.push_back(value);
+            blockMax.push_back(value);
+            return;
+        }
+    } else {
+        xs[slot(index)] = x;
+        values[slot(index)] = value;
+        if (index % BLOCK == 0) {
+            blockMin[blockSlot] = value;
+            blockMax[blockSlot] = value;
+            return;
+        }
+    }
+    blockMin[blockSlot] = std::min(blockMin[blockSlot], value);
+    blockMax[blockSlot] = std::max(blockMax[blockSlot], value);
+}
+
+void PlotSeries::clear()
+{
+    // 保留已分配的缓冲区
+    xs.clear();
+    values.clear();
+    blockMin.clear();
+    blockMax.clear();
+    count = 0;
+}
+
+qint64 PlotSeries::capacity() const
+{
+    return mask + 1;
+}
+
+qint64 PlotSeries::firstIndex() const
+{
+    return qMax<qint64>(0, count - (mask + 1));
+}
+
+qint64 PlotSeries::endIndex() const
+{
+    return count;
+}
+
+qint64 PlotSeries::x(qint64 index) const
+{
+    return xs[slot(index)];
+}
+
+float PlotSeries::value(qint64 index) const
+{
+    return values[slot(index)];
+}
+
+qint64 PlotSeries::lowerBound(qint64 value) const
+{
+    qint64 low = firstIndex();
+    qint64 high = count;
+    while (low < high) {
+        const qint64 middle = low + (high - low) / 2;
+        if (xs[slot(middle)] < value) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+void PlotSeries::range(qint64 begin, qint64 end, float *min, float *max) const
+{
+    float low = values[slot(begin)];
+    float high = low;
+    qint64 index = begin;
+    // 第一个块边界之前、最后一个块边界之后的采样逐个比较，中间的完整块用块的最值。
+    // 起点所在的块可能已被部分覆盖（块的最值已属于新数据），所以只用完全落在区间内的块
+    const qint64 firstBlock = (begin + BLOCK - 1) / BLOCK;
+    const qint64 lastBlock = end / BLOCK;
+    if (firstBlock < lastBlock) {
+        for (; index < firstBlock * BLOCK; ++index) {
+            low = std::min(low, values[slot(index)]);
+            high = std::max(high, values[slot(index)]);
+        }
+        const qint64 blockMask = mask / BLOCK;
+        for (qint64 block = firstBlock; block < lastBlock; ++block) {
+            low = std::min(low, blockMin[block & blockMask]);
+            high = std::max(high, blockMax[block & blockMask]);
+        }
+        index = lastBlock * BLOCK;
+    }
+    for (; index < end; ++index) {
+        low = std::min(low, values[slot(index)]);
+        high = std::max(high, values[slot(index)]);
+    }
+    *min = low;
+    *max = high;
+}
\ No newline at end of file
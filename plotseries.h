@@ -0,0 +1,50 @@
+#ifndef PLOTSERIES_H
+#define PLOTSERIES_H
+
+#include <QtGlobal>
+#include <vector>
+
+// 一个通道的采样序列
+// 按追加顺序保存最近 capacity 个采样（横坐标单调不减），超出后覆盖最早的采样；
+// 另外每 BLOCK 个采样保存一次最小/最大值。按像素列抽取时，一列覆盖的采样区间中
+// 完整的块直接用块的最值，只有两端不足一块的采样逐个比较，
+// 因此窗口内有几百万个采样时，每帧的计算量也只与像素列数和 BLOCK 有关。
+// 采样的序号从0开始一直累加，不随覆盖回绕；缓冲区随数据增长，不预先分配全部容量。
+class PlotSeries
+{
+public:
+    static const qint64 BLOCK = 64;
+    
+    // capacity 向上取为 BLOCK 的倍数并且是2的幂
+    explicit PlotSeries(qint64 capacity = 1 << 20);
+    
+    void append(qint64 x, float value);
+    void clear();
+    
+    qint64 capacity() const;
+    // 仍保存着的采样序号范围 [firstIndex, endIndex)
+    qint64 firstIndex() const;
+    qint64 endIndex() const;
+    qint64 x(qint64 index) const;
+    float value(qint64 index) const;
+    
+    // 第一个横坐标不小于 x 的采样序号，没有时返回 endIndex()
+    qint64 lowerBound(qint64 x) const;
+    // 采样 [begin, end) 的最小值和最大值，区间必须非空且在保存范围内
+    void range(qint64 begin, qint64 end, float *min, float *max) const;
+
+private:
+    qint64 slot(qint64 index) const
+    {
+        return index & mask;
+    }
+    
+    std::vector<qint64> xs;
+    std::vector<float> values;
+    std::vector<float> blockMin;
+    std::vector<float> blockMax;
+    qint64 mask;
+    qint64 count;               // 累计追加的采样数
+};
+
+#endif // PLOTSERIES_H
\ No newline at end of file
@@ -0,0 +1,176 @@
+#include "plotview.h"
+#include <QPainter>
+#include <algorithm>
+#include <limits>
+
+// 绘图区边距：左侧留给纵轴刻度，下方留给横轴行号
+static const int MARGIN_LEFT = 64;
+static const int MARGIN_RIGHT = 8;
+static const int MARGIN_TOP = 8;
+static const int MARGIN_BOTTOM = 20;
+// 纵轴刻度数
+static const int Y_TICKS = 4;
+
+static const Qt::GlobalColor CHANNEL_COLORS[] = {
+    Qt::blue, Qt::red, Qt::darkGreen, Qt::magenta, Qt::darkCyan, Qt::darkYellow, Qt::black, Qt::darkRed
+};
+
+PlotView::PlotView(QWidget *parent)
+    : QWidget(parent)
+    , windowLines(10000)
+{
+    setAttribute(Qt::WA_OpaquePaintEvent);
+    setBackgroundRole(QPalette::Base);
+    setMinimumHeight(160);
+    
+    series.reserve(TelemetryParser::MAX_CHANNELS);
+    parser.setSampleHandler([this](int channel, qint64 line, double value) {
+        while (static_cast<int>(series.size()) <= channel) {
+            series.emplace_back(SERIES_CAPACITY);
+        }
+        series[channel].append(line, static_cast<float>(value));
+    });
+}
+
+void PlotView::feed(const char *data, qint64 length)
+{
+    parser.feed(data, length);
+}
+
+void PlotView::clear()
+{
+    parser.reset();
+    series.clear();
+    update();
+}
+
+void PlotView::setWindow(qint64 lines)
+{
+    windowLines = qBound<qint64>(2, lines, SERIES_CAPACITY);
+    update();
+}
+
+qint64 PlotView::window() const
+{
+    return windowLines;
+}
+
+int PlotView::channelCount() const
+{
+    return static_cast<int>(series.size());
+}
+
+qint64 PlotView::lineCount() const
+{
+    return parser.lineCount();
+}
+
+void PlotView::paintEvent(QPaintEvent *event)
+{
+    Q_UNUSED(event);
+    QPainter painter(this);
+    const QPalette &pal = palette();
+    painter.fillRect(rect(), pal.base());
+    
+    const QRect area = rect().adjusted(MARGIN_LEFT, MARGIN_TOP, -MARGIN_RIGHT, -MARGIN_BOTTOM);
+    if (series.empty() || area.width() <= 0 || area.height() <= 0) {
+        painter.setPen(pal.color(QPalette::PlaceholderText));
+        painter.drawText(rect(), Qt::AlignCenter, "等待数值数据：每行一组，如 1.2,3.4 或 T=25.3 H=40");
+        return;
+    }
+    
+    // 横轴为最近 windowLines 行，数据不足一屏时从左边开始画
+    const qint64 lastLine = parser.lineCount();
+    const qint64 firstLine = qMax<qint64>(0, lastLine - windowLines);
+    const int columns = area.width();
+    const int channels = static_cast<int>(series.size());
+    columnMin.resize(static_cast<size_t>(channels) * columns);
+    columnMax.resize(columnMin.size());
+    columnValid.assign(columnMin.size(), 0);
+    
+    // 先抽取所有通道，同时得到纵轴范围
+    float low = std::numeric_limits<float>::max();
+    float high = std::numeric_limits<float>::lowest();
+    for (int c = 0; c < channels; ++c) {
+        const PlotSeries &s = series[c];
+        qint64 index = s.lowerBound(firstLine);
+        for (int column = 0; column < columns && index < s.endIndex(); ++column) {
+            const qint64 columnEnd = firstLine + (column + 1) * windowLines / columns;
+            const qint64 next = s.lowerBound(columnEnd);
+            if (next > index) {
+                const size_t slot = static_cast<size_t>(c) * columns + column;
+                s.range(index, next, &columnMin[slot], &columnMax[slot]);
+                columnValid[slot] = 1;
+                low = std::min(low, columnMin[slot]);
+                high = std::max(high, columnMax[slot]);
+                index = next;
+            }
+        }
+    }
+    if (low > high) {
+        low = high = 0;
+    }
+    if (low == high) {
+        low -= 1;
+        high += 1;
+    }
+    const float padding = (high - low) * 0.05f;
+    low -= padding;
+    high += padding;
+    const double scale = area.height() / static_cast<double>(high - low);
+    const auto toY = [&](float value) {
+        return area.bottom() - (value - low) * scale;
+    };
+    
+    // 网格和刻度
+    const QFontMetrics fm(font());
+    painter.setPen(pal.color(QPalette::Mid));
+    painter.drawRect(area.adjusted(0, 0, -1, -1));
+    for (int i = 0; i <= Y_TICKS; ++i) {
+        const double value = low + (high - low) * i / Y_TICKS;
+        const int y = qRound(toY(static_cast<float>(value)));
+        painter.setPen(pal.color(QPalette::Midlight));
+        painter.drawLine(area.left(), y, area.right(), y);
+        painter.setPen(pal.color(QPalette::Text));
+        painter.drawText(QRect(0, y - fm.height() / 2, MARGIN_LEFT - 4, fm.height()),
+                         Qt::AlignRight | Qt::AlignVCenter, QString::number(value, 'g', 5));
+    }
+    painter.drawText(QRect(area.left(), area.bottom() + 2, area.width(), MARGIN_BOTTOM - 2),
+                     Qt::AlignLeft | Qt::AlignTop, QString::number(firstLine));
+    painter.drawText(QRect(area.left(), area.bottom() + 2, area.width(), MARGIN_BOTTOM - 2),
+                     Qt::AlignRight | Qt::AlignTop, QString::number(firstLine + windowLines));
+    
+    // 每列先画最大值再画最小值，折线在相邻列之间首尾相连，覆盖整个包络
+    painter.setClipRect(area);
+    int legendX = area.left() + 6;
+    for (int c = 0; c < channels; ++c) {
+        const QColor color(CHANNEL_COLORS[c % (sizeof(CHANNEL_COLORS) / sizeof(CHANNEL_COLORS[0]))]);
+        points.resize(0);
+        for (int column = 0; column < columns; ++column) {
+            const size_t slot = static_cast<size_t>(c) * columns + column;
+            if (!columnValid[slot]) {
+                continue;
+            }
+            const double x = area.left() + column + 0.5;
+            points.append(QPointF(x, toY(columnMax[slot])));
+            if (columnMin[slot] != columnMax[slot]) {
+                points.append(QPointF(x, toY(columnMin[slot])));
+            }
+        }
+        painter.setPen(color);
+        if (points.size() == 1) {
+            painter.drawPoint(points.first());
+        } else if (points.size() > 1) {
+            painter.drawPolyline(points.constData(), points.size());
+        }
+        
+        // 图例：通道名和最新值
+        const PlotSeries &s = series[c];
+        QString legend = parser.channelName(c);
+        if (s.endIndex() > 0) {
+            legend += QString(" = %1").arg(static_cast<double>(s.value(s.endIndex() - 1)), 0, 'g', 6);
+        }
+        painter.drawText(legendX, area.top() + fm.ascent() + 2, legend);
+        legendX += fm.horizontalAdvance(legend) + 12;
+    }
+}
\ No newline at end of file
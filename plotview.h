@@ -0,0 +1,52 @@
+#ifndef PLOTVIEW_H
+#define PLOTVIEW_H
+
+#include <QPointF>
+#include <QVector>
+#include <QWidget>
+#include <vector>
+
+#include "plotseries.h"
+#include "telemetryparser.h"
+
+// 实时波形显示控件
+// 接收数据由 TelemetryParser 按行解析成各通道的采样，每个通道一个 PlotSeries 环形缓冲区，横坐标为行号。
+// 绘制时按像素列抽取：每列取该列覆盖的采样的最小值和最大值画成一段竖线，相邻列首尾相连，
+// 尖峰不会因为抽取而丢失；窗口内有几百万个采样时每帧的绘制量也只与控件宽度有关。
+// 数据由界面线程在每个显示帧从接收存储中取出后调用 feed，不经过I/O线程，不影响接收和录制。
+class PlotView : public QWidget
+{
+    Q_OBJECT
+
+public:
+    // 每个通道保存的采样数，显示的行数不应超过它
+    static constexpr qint64 SERIES_CAPACITY = 1 << 20;
+    
+    explicit PlotView(QWidget *parent = nullptr);
+    
+    // 输入一段接收数据，可以在任意位置切开；新采样在下次绘制时显示
+    void feed(const char *data, qint64 length);
+    void clear();
+    
+    // 横轴显示最近多少行采样，不超过 SERIES_CAPACITY
+    void setWindow(qint64 lines);
+    qint64 window() const;
+    
+    int channelCount() const;
+    qint64 lineCount() const;
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+
+private:
+    TelemetryParser parser;
+    std::vector<PlotSeries> series;     // 与解析器的通道一一对应
+    qint64 windowLines;
+    // 每次绘制复用的抽取结果：通道 c 第 i 列的最值在 c * 列数 + i
+    std::vector<float> columnMin;
+    std::vector<float> columnMax;
+    std::vector<char> columnValid;
+    QVector<QPointF> points;
+};
+
+#endif // PLOTVIEW_H
\ No newline at end of file
@@ -0,0 +1,24 @@
+#include "popupcombobox.h"
+
+PopupComboBox::PopupComboBox(QWidget *parent)
+    : QComboBox(parent)
+{
+}
+
+void PopupComboBox::showPopup()
+{
+    emit itemsRequested();
+    QComboBox::showPopup();
+}
+
+void PopupComboBox::focusInEvent(QFocusEvent *event)
+{
+    emit itemsRequested();
+    QComboBox::focusInEvent(event);
+}
+
+void PopupComboBox::wheelEvent(QWheelEvent *event)
+{
+    emit itemsRequested();
+    QComboBox::wheelEvent(event);
+}
\ No newline at end of file
@@ -0,0 +1,27 @@
+#ifndef POPUPCOMBOBOX_H
+#define POPUPCOMBOBOX_H
+
+#include <QComboBox>
+
+// 需要选项时才发出 itemsRequested 的下拉框
+// 用于选项很多、构建代价较高的列表：启动时只放当前项，第一次使用时再填充全部选项。
+// 除了展开列表，收起状态下也可以用键盘（需先获得焦点）或滚轮切换选项，因此这几种情况都会先发出信号。
+class PopupComboBox : public QComboBox
+{
+    Q_OBJECT
+
+public:
+    explicit PopupComboBox(QWidget *parent = nullptr);
+    
+    void showPopup() override;
+
+signals:
+    // 在列表弹出、获得焦点或滚轮切换之前同步发出，接收方可以在此时补充选项；可能发出多次
+    void itemsRequested();
+
+protected:
+    void focusInEvent(QFocusEvent *event) override;
+    void wheelEvent(QWheelEvent *event) override;
+};
+
+#endif // POPUPCOMBOBOX_H
\ No newline at end of file
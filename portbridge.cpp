@@ -0,0 +1,257 @@
+#include "portbridge.h"
+#include "timestamp.h"
+#include <QDir>
+#include <QFile>
+#include <QHostAddress>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QSerialPort>
+#include <QTcpServer>
+#include <QTcpSocket>
+
+#ifdef Q_OS_UNIX
+#include <sys/stat.h>
+#endif
+
+// 每个客户端最多积压的未发出数据，超出后丢弃新数据
+static const qint64 CLIENT_BACKLOG_LIMIT = 1024 * 1024;
+// 串口输出缓冲区积压超过该值时暂停读取控制端
+static const qint64 PORT_BACKLOG_LIMIT = 16 * 1024;
+// 每次从控制端读取的最大字节数
+static const int READ_CHUNK_SIZE = 4096;
+
+// 删除上次异常退出留下的套接字文件，否则监听失败；该路径是其他类型的文件时不删除并返回 false
+static bool removeStaleSocket(const QString &name)
+{
+#ifdef Q_OS_UNIX
+    // 与 QLocalServer 相同：相对名称位于临时目录下
+    const QString path = name.startsWith('/') ? name : QDir::cleanPath(QDir::tempPath()) + '/' + name;
+    struct stat info;
+    if (::lstat(QFile::encodeName(path).constData(), &info) == 0 && !S_ISSOCK(info.st_mode)) {
+        return false;
+    }
+#endif
+    QLocalServer::removeServer(name);
+    return true;
+}
+
+PortBridge::PortBridge(QSerialPort *port, QObject *parent)
+    : QObject(parent)
+    , port(port)
+    , tcpServer(nullptr)
+    , localServer(nullptr)
+    , controller(nullptr)
+    , readBuffer(READ_CHUNK_SIZE, Qt::Uninitialized)
+    , active(false)
+    , clientCount(0)
+    , hasController(false)
+    , forwardedBytes(0)
+    , writtenBytes(0)
+    , droppedBytes(0)
+{
+    // 串口输出缓冲区腾出空间后继续读取控制端
+    connect(port, &QSerialPort::bytesWritten, this, &PortBridge::readController);
+}
+
+PortBridge::~PortBridge()
+{
+    close();
+}
+
+void PortBridge::setWriteHook(const std::function<void(const char *, qint64)> &hook)
+{
+    writeHook = hook;
+}
+
+void PortBridge::forward(const char *data, qint64 length)
+{
+    for (QIODevice *client : std::as_const(clients)) {
+        // 直接从环形缓冲区写入套接字，不产生中间 QByteArray
+        if (client->bytesToWrite() > CLIENT_BACKLOG_LIMIT) {
+            droppedBytes.fetch_add(length, std::memory_order_relaxed);
+            continue;
+        }
+        client->write(data, length);
+        forwardedBytes.fetch_add(length, std::memory_order_relaxed);
+    }
+}
+
+PortBridge::Status PortBridge::status() const
+{
+    Status status;
+    status.listening = active.load(std::memory_order_relaxed);
+    status.clients = clientCount.load(std::memory_order_relaxed);
+    status.controller = hasController.load(std::memory_order_relaxed);
+    status.forwarded = forwardedBytes.load(std::memory_order_relaxed);
+    status.written = writtenBytes.load(std::memory_order_relaxed);
+    status.dropped = droppedBytes.load(std::memory_order_relaxed);
+    return status;
+}
+
+void PortBridge::listen(const QString &address)
+{
+    close();
+    forwardedBytes.store(0, std::memory_order_relaxed);
+    writtenBytes.store(0, std::memory_order_relaxed);
+    droppedBytes.store(0, std::memory_order_relaxed);
+    
+    QString description;
+    if (address.startsWith("unix:")) {
+        const QString name = address.mid(5);
+        if (name.isEmpty()) {
+            emit listenFailed("缺少套接字路径");
+            return;
+        }
+        if (!removeStaleSocket(name)) {
+            emit listenFailed(QString("%1 已存在且不是套接字").arg(name));
+            return;
+        }
+        localServer = new QLocalServer(this);
+        connect(localServer, &QLocalServer::newConnection, this, &PortBridge::onNewConnection);
+        if (!localServer->listen(name)) {
+            const QString error = localServer->errorString();
+            delete localServer;
+            localServer = nullptr;
+            emit listenFailed(error);
+            return;
+        }
+        description = "unix:" + localServer->fullServerName();
+    } else {
+        QString text = address.startsWith("tcp:") ? address.mid(4) : address;
+        QHostAddress host(QHostAddress::LocalHost);
+        const int colon = text.lastIndexOf(':');
+        if (colon >= 0) {
+            if (!host.setAddress(text.left(colon))) {
+                emit listenFailed(QString("无效的地址：%1").arg(text.left(colon)));
+                return;
+            }
+            text = text.mid(colon + 1);
+        }
+        bool ok = false;
+        const quint16 portNumber = text.toUShort(&ok);
+        if (!ok) {
+            emit listenFailed(QString("无效的端口：%1").arg(text));
+            return;
+        }
+        tcpServer = new QTcpServer(this);
+        connect(tcpServer, &QTcpServer::newConnection, this, &PortBridge::onNewConnection);
+        if (!tcpServer->listen(host, portNumber)) {
+            const QString error = tcpServer->errorString();
+            delete tcpServer;
+            tcpServer = nullptr;
+            emit listenFailed(error);
+            return;
+        }
+        // 端口为0时由系统分配，返回实际端口
+        description = QString("tcp:%1:%2").arg(tcpServer->serverAddress().toString()).arg(tcpServer->serverPort());
+    }
+    active.store(true, std::memory_order_relaxed);
+    emit listening(description);
+}
+
+void PortBridge::close()
+{
+    const bool wasActive = active.exchange(false, std::memory_order_relaxed);
+    delete tcpServer;
+    tcpServer = nullptr;
+    delete localServer;
+    localServer = nullptr;
+    
+    const QVector<QIODevice *> remaining = clients;
+    clients.clear();
+    controller = nullptr;
+    for (QIODevice *client : remaining) {
+        client->disconnect(this);
+        client->close();
+        client->deleteLater();
+    }
+    clientCount.store(0, std::memory_order_relaxed);
+    hasController.store(false, std::memory_order_relaxed);
+    
+    if (wasActive) {
+        emit closed();
+    }
+}
+
+void PortBridge::onNewConnection()
+{
+    if (tcpServer) {
+        while (QTcpSocket *socket = tcpServer->nextPendingConnection()) {
+            // 小包立即发出，不等待合并
+            socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+            connect(socket, &QTcpSocket::disconnected, this, [this, socket]() {
+                removeClient(socket);
+            });
+            addClient(socket);
+        }
+    }
+    if (localServer) {
+        while (QLocalSocket *socket = localServer->nextPendingConnection()) {
+            connect(socket, &QLocalSocket::disconnected, this, [this, socket]() {
+                removeClient(socket);
+            });
+            addClient(socket);
+        }
+    }
+}
+
+void PortBridge::addClient(QIODevice *client)
+{
+    clients.append(client);
+    if (!controller) {
+        controller = client;
+        connect(client, &QIODevice::readyRead, this, &PortBridge::readController);
+        hasController.store(true, std::memory_order_relaxed);
+    } else {
+        // 只监听的客户端：发来的数据直接丢弃
+        connect(client, &QIODevice::readyRead, client, [client]() {
+            client->skip(client->bytesAvailable());
+        });
+    }
+    clientCount.store(static_cast<int>(clients.size()), std::memory_order_relaxed);
+    emit clientsChanged(static_cast<int>(clients.size()));
+}
+
+void PortBridge::removeClient(QIODevice *client)
+{
+    if (!clients.removeOne(client)) {
+        return;
+    }
+    // 控制端断开后不提升其他客户端，下一个新连接成为控制端
+    if (client == controller) {
+        controller = nullptr;
+        hasController.store(false, std::memory_order_relaxed);
+    }
+    client->disconnect(this);
+    client->deleteLater();
+    clientCount.store(static_cast<int>(clients.size()), std::memory_order_relaxed);
+    emit clientsChanged(static_cast<int>(clients.size()));
+}
+
+void PortBridge::readController()
+{
+    if (!controller) {
+        return;
+    }
+    if (!port->isOpen()) {
+        controller->skip(controller->bytesAvailable());
+        return;
+    }
+    
+    // 串口输出缓冲区积压时留在套接字中，等 bytesWritten 后再读
+    while (controller->bytesAvailable() > 0 && port->bytesToWrite() < PORT_BACKLOG_LIMIT) {
+        const qint64 length = controller->read(readBuffer.data(), readBuffer.size());
+        if (length <= 0) {
+            break;
+        }
+        const qint64 written = port->write(readBuffer.constData(), length);
+        if (written <= 0) {
+            break;
+        }
+        writtenBytes.fetch_add(written, std::memory_order_relaxed);
+        if (writeHook) {
+            writeHook(readBuffer.constData(), written);
+        }
+        emit dataWritten(TimestampClock::now(), QByteArray(readBuffer.constData(), written));
+    }
+}
\ No newline at end of file
@@ -0,0 +1,85 @@
+#ifndef PORTBRIDGE_H
+#define PORTBRIDGE_H
+
+#include <QByteArray>
+#include <QObject>
+#include <QString>
+#include <QVector>
+#include <atomic>
+#include <functional>
+
+class QIODevice;
+class QLocalServer;
+class QSerialPort;
+class QTcpServer;
+
+// 串口桥接，运行在会话的I/O线程中
+// 把打开的串口暴露为本机的 TCP 端口或本地套接字（Unix 域套接字/Windows 命名管道），供测试脚本、协议解析器等外部进程
+// 与界面同时使用同一个串口。第一个连接的客户端为控制端，它发来的数据直接写入串口；其余客户端只监听，发来的数据被丢弃。
+// 串口数据在I/O线程读入环形缓冲区的同时直接写给各客户端，不经过界面线程和显示路径。
+// 客户端积压超过上限时丢弃新数据并计数，慢客户端不会拖慢串口读取；串口输出缓冲区积压时暂停读取控制端，由套接字流控反压对方。
+class PortBridge : public QObject
+{
+    Q_OBJECT
+
+public:
+    // 桥接状态，任意线程都可以读取
+    struct Status
+    {
+        bool listening = false;
+        int clients = 0;
+        bool controller = false;    // 是否有控制端连接
+        qint64 forwarded = 0;       // 转发给客户端的串口数据字节数（每个客户端分别计）
+        qint64 written = 0;         // 控制端写入串口的字节数
+        qint64 dropped = 0;         // 客户端积压过多而丢弃的字节数
+    };
+    
+    explicit PortBridge(QSerialPort *port, QObject *parent = nullptr);
+    ~PortBridge();
+    
+    // 控制端数据写入串口后在I/O线程中调用，用于统计和录制
+    void setWriteHook(const std::function<void(const char *, qint64)> &hook);
+    
+    // I/O线程读到串口数据后调用，直接写给所有客户端
+    void forward(const char *data, qint64 length);
+    
+    Status status() const;
+
+public slots:
+    // 以下槽函数都应通过排队连接在I/O线程中调用
+    // address 为 "tcp:[主机:]端口"、"unix:路径" 或单独的端口号；不写主机时只监听本机回环地址
+    void listen(const QString &address);
+    void close();
+
+signals:
+    void listening(const QString &address);
+    void listenFailed(const QString &errorString);
+    void closed();
+    void clientsChanged(int clients);
+    // 控制端写入串口的数据，timestamp 为写入时刻
+    void dataWritten(qint64 timestamp, const QByteArray &data);
+
+private slots:
+    void onNewConnection();
+    void readController();
+
+private:
+    void addClient(QIODevice *client);
+    void removeClient(QIODevice *client);
+    
+    QSerialPort *port;
+    QTcpServer *tcpServer;
+    QLocalServer *localServer;
+    QVector<QIODevice *> clients;
+    QIODevice *controller;
+    std::function<void(const char *, qint64)> writeHook;
+    QByteArray readBuffer;      // 控制端数据的读取缓冲区，只分配一次
+    std::atomic<bool> active;
+    std::atomic<int> clientCount;
+    std::atomic<bool> hasController;
+    std::atomic<qint64> forwardedBytes;
+    std::atomic<qint64> writtenBytes;
+    std::atomic<qint64> droppedBytes;
+};
+
+#endif // PORTBRIDGE_H
\ No newline at end of file
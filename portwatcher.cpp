@@ -0,0 +1,108 @@
+#include "portwatcher.h"
+#include <QDir>
+#include <QFileSystemWatcher>
+#include <QSerialPortInfo>
+#include <QTimer>
+#include <algorithm>
+
+// 设备节点变化后等待驱动和 udev 完成初始化的时间（毫秒），期间的多次变化合并为一次枚举
+static const int SETTLE_MS = 300;
+// 定时枚举间隔（毫秒）：能监视设备目录时只作兜底
+static const int POLL_MS = 1000;
+static const int WATCHED_POLL_MS = 5000;
+
+PortWatcher::PortWatcher(QObject *parent)
+    : QObject(parent)
+    , scanThread(new QThread(this))
+    , context(new QObject)
+    , scanned(false)
+{
+    context->moveToThread(scanThread);
+}
+
+PortWatcher::~PortWatcher()
+{
+    if (scanThread->isRunning()) {
+        // 定时器和目录监视在后台线程中创建，也在该线程中销毁
+        QMetaObject::invokeMethod(context, [this]() {
+            qDeleteAll(context->children());
+        }, Qt::BlockingQueuedConnection);
+        scanThread->quit();
+        scanThread->wait();
+    }
+    delete context;
+}
+
+void PortWatcher::start()
+{
+    if (scanThread->isRunning()) {
+        return;
+    }
+    scanThread->start(QThread::LowPriority);
+    QMetaObject::invokeMethod(context, [this]() { setup(); }, Qt::QueuedConnection);
+}
+
+void PortWatcher::rescan()
+{
+    QMetaObject::invokeMethod(context, [this]() { scan(); }, Qt::QueuedConnection);
+}
+
+void PortWatcher::setup()
+{
+    QTimer *settleTimer = new QTimer(context);
+    settleTimer->setSingleShot(true);
+    settleTimer->setInterval(SETTLE_MS);
+    connect(settleTimer, &QTimer::timeout, context, [this]() { scan(); });
+    
+    int pollInterval = POLL_MS;
+#if defined(Q_OS_LINUX) || defined(Q_OS_MACOS)
+    // 串口设备节点都在 /dev 下，USB 转串口插拔时目录内容随之变化
+    QFileSystemWatcher *deviceWatcher = new QFileSystemWatcher(context);
+    QStringList paths = {"/dev"};
+    if (QDir("/dev/serial").exists()) {
+        paths.append("/dev/serial");
+    }
+    if (!deviceWatcher->addPaths(paths).contains("/dev")) {
+        connect(deviceWatcher, &QFileSystemWatcher::directoryChanged, settleTimer, [settleTimer]() {
+            settleTimer->start();
+        });
+        pollInterval = WATCHED_POLL_MS;
+    }
+#endif
+
+    QTimer *pollTimer = new QTimer(context);
+    pollTimer->setInterval(pollInterval);
+    connect(pollTimer, &QTimer::timeout, context, [this]() { scan(); });
+    pollTimer->start();
+    
+    scan();
+}
+
+void PortWatcher::scan()
+{
+    QStringList names;
+    QStringList descriptions;
+    // 按名称排序，枚举顺序变化不算列表变化
+    QList<QSerialPortInfo> ports = QSerialPortInfo::availablePorts();
+    std::sort(ports.begin(), ports.end(), [](const QSerialPortInfo &a, const QSerialPortInfo &b) {
+        return a.portName() < b.portName();
+    });
+    for (const QSerialPortInfo &info : ports) {
+        names.append(info.portName());
+        QStringList details;
+        for (const QString &detail : {info.description(), info.manufacturer(), info.systemLocation()}) {
+            if (!detail.isEmpty()) {
+                details.append(detail);
+            }
+        }
+        descriptions.append(details.join('\n'));
+    }
+    
+    if (scanned && names == lastNames && descriptions == lastDescriptions) {
+        return;
+    }
+    scanned = true;
+    lastNames = names;
+    lastDescriptions = descriptions;
+    emit portsChanged(names, descriptions);
+}
\ No newline at end of file
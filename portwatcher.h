@@ -0,0 +1,44 @@
+#ifndef PORTWATCHER_H
+#define PORTWATCHER_H
+
+#include <QObject>
+#include <QStringList>
+#include <QThread>
+
+// 串口热插拔监视
+// QSerialPortInfo::availablePorts() 要逐个查询驱动和USB描述符，适配器多时一次要几百毫秒甚至几秒，
+// 因此枚举放在独立的后台线程中进行，界面启动和刷新都不等待。
+// Linux 和 macOS 上监视 /dev 目录，设备节点增删后稍等片刻立即重新枚举，另以较长间隔定时枚举兜底；
+// 其他平台只定时枚举。端口列表有变化时才发出 portsChanged。
+class PortWatcher : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit PortWatcher(QObject *parent = nullptr);
+    ~PortWatcher();
+    
+    // 启动后台线程并立即枚举一次
+    void start();
+
+public slots:
+    // 请求立即重新枚举，可以在任意线程调用
+    void rescan();
+
+signals:
+    // 在后台线程中发出，连接到界面对象时自动排队；第一次枚举总会发出
+    // descriptions 与 names 一一对应，为端口描述、厂商和设备路径
+    void portsChanged(const QStringList &names, const QStringList &descriptions);
+
+private:
+    void setup();
+    void scan();
+    
+    QThread *scanThread;
+    QObject *context;           // 属于后台线程，定时器和目录监视都是它的子对象
+    QStringList lastNames;      // 以下只在后台线程中访问
+    QStringList lastDescriptions;
+    bool scanned;
+};
+
+#endif // PORTWATCHER_H
\ No newline at end of file
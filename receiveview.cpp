@@ -0,0 +1,526 @@
+#include "receiveview.h"
+#include "recordsource.h"
+#include "sessioncodec.h"
+#include <QAction>
+#include <QApplication>
+#include <QClipboard>
+#include <QFontDatabase>
+#include <QMouseEvent>
+#include <QPainter>
+#include <QScrollBar>
+#include <algorithm>
+#include <climits>
+
+// 行索引的采样间隔（记录数）
+static const int INDEX_STRIDE = 256;
+// 缓存最近绘制过的记录数
+static const int LINE_CACHE_RECORDS = 2048;
+// 超过该长度的行只绘制可见部分
+static const int LONG_LINE_CHARS = 1024;
+// 文本左边距
+static const int MARGIN = 4;
+
+// 影响行数的编码名称：换行就是 0x0A 字节的编码按字节统计，行数与编码无关，返回空串
+static QString rowCodecName(const SessionCodec *codec)
+{
+    return codec && !codec->hasByteNewline() ? codec->name() : QString();
+}
+
+ReceiveView::ReceiveView(QWidget *parent)
+    : QAbstractScrollArea(parent)
+    , store(nullptr)
+    , followTail(true)
+    , indexedRecords(0)
+    , totalRows(0)
+    , lineHeight(1)
+    , charWidth(1)
+    , maxLineWidth(0)
+    , selectionAnchor(-1)
+    , selectionCursor(-1)
+    , lineCache(LINE_CACHE_RECORDS)
+{
+    setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+    viewport()->setBackgroundRole(QPalette::Base);
+    viewport()->setCursor(Qt::IBeamCursor);
+    setFocusPolicy(Qt::StrongFocus);
+    
+    QFontMetrics fm(font());
+    lineHeight = qMax(1, fm.lineSpacing());
+    charWidth = qMax(1, fm.horizontalAdvance(QLatin1Char('0')));
+    
+    // 右键菜单和快捷键：复制选中行、全选
+    QAction *copyAction = new QAction("复制", this);
+    copyAction->setShortcut(QKeySequence::Copy);
+    copyAction->setShortcutContext(Qt::WidgetShortcut);
+    connect(copyAction, &QAction::triggered, this, &ReceiveView::copySelection);
+    addAction(copyAction);
+    
+    QAction *selectAllAction = new QAction("全选", this);
+    selectAllAction->setShortcut(QKeySequence::SelectAll);
+    selectAllAction->setShortcutContext(Qt::WidgetShortcut);
+    connect(selectAllAction, &QAction::triggered, this, &ReceiveView::selectAll);
+    addAction(selectAllAction);
+    
+    setContextMenuPolicy(Qt::ActionsContextMenu);
+}
+
+void ReceiveView::setStore(RecordSource *value)
+{
+    store = value;
+    reset();
+}
+
+RecordSource *ReceiveView::source() const
+{
+    return store;
+}
+
+void ReceiveView::setFollowTail(bool follow)
+{
+    followTail = follow;
+}
+
+void ReceiveView::setRenderOptions(const RenderOptions &value)
+{
+    // 只有改变每条记录行数的选项才需要重建行索引；时间戳等其他选项只重新渲染可见行
+    const bool relayout = value.hexReceive != options.hexReceive || value.hexSend != options.hexSend
+        || value.logMode != options.logMode
+        || value.hex.bytesPerLine != options.hex.bytesPerLine || value.hex.dumpLayout != options.hex.dumpLayout
+        || rowCodecName(value.receiveCodec) != receiveRowCodec || rowCodecName(value.sendCodec) != sendRowCodec;
+    if (!relayout) {
+        options = value;
+        hexFormatter.setOptions(options.hex);
+        timestampFormatter.setPrecision(options.timestampPrecision);
+        maxLineWidth = 0;
+        lineCache.clear();
+        viewport()->update();
+        return;
+    }
+    
+    // 记住第一条可见记录，重建索引后滚动回该记录
+    qint64 anchorRecord = -1;
+    int anchorSubLine = 0;
+    locateRow(verticalScrollBar()->value(), &anchorRecord, &anchorSubLine);
+    
+    options = value;
+    hexFormatter.setOptions(options.hex);
+    timestampFormatter.setPrecision(options.timestampPrecision);
+    receiveRowCodec = rowCodecName(options.receiveCodec);
+    sendRowCodec = rowCodecName(options.sendCodec);
+    rowCheckpoints.clear();
+    indexedRecords = 0;
+    totalRows = 0;
+    maxLineWidth = 0;
+    selectionAnchor = -1;
+    selectionCursor = -1;
+    lineCache.clear();
+    
+    indexNewRecords();
+    updateScrollBars();
+    if (anchorRecord >= 0) {
+        verticalScrollBar()->setValue(static_cast<int>(qMin<qint64>(firstRowOf(anchorRecord), INT_MAX)));
+    }
+    viewport()->update();
+}
+
+ReceiveView::RenderOptions ReceiveView::renderOptions() const
+{
+    return options;
+}
+
+void ReceiveView::recordsAppended()
+{
+    QScrollBar *bar = verticalScrollBar();
+    const bool atBottom = followTail && bar->value() >= bar->maximum();
+    
+    indexNewRecords();
+    updateScrollBars();
+    
+    if (atBottom) {
+        bar->setValue(bar->maximum());
+    }
+    viewport()->update();
+}
+
+void ReceiveView::reset()
+{
+    rowCheckpoints.clear();
+    indexedRecords = 0;
+    totalRows = 0;
+    maxLineWidth = 0;
+    selectionAnchor = -1;
+    selectionCursor = -1;
+    lineCache.clear();
+    
+    indexNewRecords();
+    updateScrollBars();
+    viewport()->update();
+}
+
+void ReceiveView::scrollToRecord(qint64 record)
+{
+    indexNewRecords();
+    updateScrollBars();
+    if (indexedRecords == 0) {
+        return;
+    }
+    
+    // 不显示的记录（如非日志模式下的发送记录）落到其后第一条可见行
+    const qint64 row = qMin(firstRowOf(qBound<qint64>(0, record, indexedRecords - 1)), totalRows - 1);
+    if (row < 0) {
+        return;
+    }
+    selectionAnchor = row;
+    selectionCursor = row;
+    verticalScrollBar()->setValue(static_cast<int>(qMin<qint64>(row, INT_MAX)));
+    viewport()->update();
+}
+
+qint64 ReceiveView::rowCount() const
+{
+    return totalRows;
+}
+
+QString ReceiveView::rowText(qint64 row) const
+{
+    qint64 record = 0;
+    int subLine = 0;
+    if (!locateRow(row, &record, &subLine)) {
+        return QString();
+    }
+    return recordLines(record).value(subLine);
+}
+
+QString ReceiveView::selectedText() const
+{
+    if (selectionAnchor < 0 || totalRows == 0) {
+        return QString();
+    }
+    
+    const qint64 first = qMin(selectionAnchor, selectionCursor);
+    const qint64 last = qMin(qMax(selectionAnchor, selectionCursor), totalRows - 1);
+    qint64 record = 0;
+    int subLine = 0;
+    if (!locateRow(first, &record, &subLine)) {
+        return QString();
+    }
+    
+    // 从第一行开始顺序遍历记录，避免逐行重新定位
+    QString text;
+    QStringList lines = recordLines(record);
+    for (qint64 row = first; row <= last; ++row) {
+        // 跳过当前显示方式下不占行的记录
+        while (subLine >= lines.size() && record + 1 < indexedRecords) {
+            lines = recordLines(++record);
+            subLine = 0;
+        }
+        text += lines.value(subLine++);
+        text += QLatin1Char('\n');
+    }
+    return text;
+}
+
+void ReceiveView::paintEvent(QPaintEvent *event)
+{
+    Q_UNUSED(event);
+    if (!store) {
+        return;
+    }
+    
+    QPainter painter(viewport());
+    const QFontMetrics fm(font());
+    const QPalette &pal = palette();
+    const int width = viewport()->width();
+    const int xScroll = horizontalScrollBar()->value();
+    const qint64 firstRow = verticalScrollBar()->value();
+    const int visibleRows = viewport()->height() / lineHeight + 1;
+    const qint64 selFirst = qMin(selectionAnchor, selectionCursor);
+    const qint64 selLast = qMax(selectionAnchor, selectionCursor);
+    
+    qint64 record = 0;
+    int subLine = 0;
+    if (!locateRow(firstRow, &record, &subLine)) {
+        return;
+    }
+    
+    bool widthChanged = false;
+    QStringList lines = recordLines(record);
+    for (int i = 0; i < visibleRows && firstRow + i < totalRows; ++i) {
+        // 逐行向后推进，一条记录的行用完后再取下一条记录
+        while (subLine >= lines.size() && record + 1 < indexedRecords) {
+            lines = recordLines(++record);
+            subLine = 0;
+        }
+        if (subLine >= lines.size()) {
+            break;
+        }
+        const QString &text = lines.at(subLine++);
+        const qint64 row = firstRow + i;
+        const int y = i * lineHeight;
+        
+        if (selectionAnchor >= 0 && row >= selFirst && row <= selLast) {
+            painter.fillRect(0, y, width, lineHeight, pal.highlight());
+            painter.setPen(pal.highlightedText().color());
+        } else {
+            painter.setPen(pal.text().color());
+        }
+        
+        int lineWidth = 0;
+        if (text.size() <= LONG_LINE_CHARS) {
+            lineWidth = fm.horizontalAdvance(text);
+            painter.drawText(MARGIN - xScroll, y + fm.ascent(), text);
+        } else {
+            // 超长行（例如大块十六进制数据）只排版可见的一段，按等宽字体估算位置
+            lineWidth = text.size() * charWidth;
+            const int firstChar = qMax(0, (xScroll - MARGIN) / charWidth);
+            const int chars = width / charWidth + 2;
+            painter.drawText(MARGIN + firstChar * charWidth - xScroll, y + fm.ascent(), text.mid(firstChar, chars));
+        }
+        if (lineWidth > maxLineWidth) {
+            maxLineWidth = lineWidth;
+            widthChanged = true;
+        }
+    }
+    
+    if (widthChanged) {
+        updateScrollBars();
+    }
+}
+
+void ReceiveView::resizeEvent(QResizeEvent *event)
+{
+    QAbstractScrollArea::resizeEvent(event);
+    updateScrollBars();
+}
+
+void ReceiveView::mousePressEvent(QMouseEvent *event)
+{
+    if (event->button() != Qt::LeftButton || totalRows == 0) {
+        QAbstractScrollArea::mousePressEvent(event);
+        return;
+    }
+    
+    const qint64 row = rowAt(event->position().toPoint().y());
+    if (!(event->modifiers() & Qt::ShiftModifier) || selectionAnchor < 0) {
+        selectionAnchor = row;
+    }
+    selectionCursor = row;
+    viewport()->update();
+}
+
+void ReceiveView::mouseMoveEvent(QMouseEvent *event)
+{
+    if (!(event->buttons() & Qt::LeftButton) || selectionAnchor < 0) {
+        QAbstractScrollArea::mouseMoveEvent(event);
+        return;
+    }
+    
+    // 拖出可视区域时顺带滚动
+    const int y = event->position().toPoint().y();
+    if (y < 0) {
+        verticalScrollBar()->triggerAction(QAbstractSlider::SliderSingleStepSub);
+    } else if (y > viewport()->height()) {
+        verticalScrollBar()->triggerAction(QAbstractSlider::SliderSingleStepAdd);
+    }
+    selectionCursor = rowAt(y);
+    viewport()->update();
+}
+
+void ReceiveView::changeEvent(QEvent *event)
+{
+    QAbstractScrollArea::changeEvent(event);
+    if (event->type() == QEvent::FontChange) {
+        QFontMetrics fm(font());
+        lineHeight = qMax(1, fm.lineSpacing());
+        charWidth = qMax(1, fm.horizontalAdvance(QLatin1Char('0')));
+        maxLineWidth = 0;
+        updateScrollBars();
+        viewport()->update();
+    }
+}
+
+void ReceiveView::indexNewRecords()
+{
+    if (!store) {
+        return;
+    }
+    
+    const qint64 count = store->recordCount();
+    for (qint64 record = indexedRecords; record < count; ++record) {
+        if (record % INDEX_STRIDE == 0) {
+            rowCheckpoints.append(totalRows);
+        }
+        totalRows += recordRows(record);
+    }
+    indexedRecords = count;
+}
+
+void ReceiveView::updateScrollBars()
+{
+    const int visibleRows = qMax(1, viewport()->height() / lineHeight);
+    const qint64 maxFirstRow = qMax<qint64>(0, totalRows - visibleRows);
+    verticalScrollBar()->setRange(0, static_cast<int>(qMin<qint64>(maxFirstRow, INT_MAX)));
+    verticalScrollBar()->setPageStep(visibleRows);
+    verticalScrollBar()->setSingleStep(1);
+    
+    const int contentWidth = maxLineWidth + 2 * MARGIN;
+    horizontalScrollBar()->setRange(0, qMax(0, contentWidth - viewport()->width()));
+    horizontalScrollBar()->setPageStep(viewport()->width());
+    horizontalScrollBar()->setSingleStep(charWidth);
+}
+
+int ReceiveView::recordRows(qint64 record) const
+{
+    // 只用内存中的索引计算行数，不读取记录数据；UTF-16/32 下换行不是单个字节，只能读出数据按编码统计
+    const bool tx = store->direction(record) == RecordDirection::Tx;
+    if (tx && !options.logMode) {
+        return 0;
+    }
+    if (tx ? options.hexSend : options.hexReceive) {
+        return static_cast<int>(hexFormatter.lineCount(store->recordLength(record)));
+    }
+    const SessionCodec *codec = tx ? options.sendCodec : options.receiveCodec;
+    if (codec && !codec->hasByteNewline()) {
+        return codec->countLineBreaks(store->record(record).data) + 1;
+    }
+    return store->lineBreaks(record) + 1;
+}
+
+bool ReceiveView::locateRow(qint64 row, qint64 *record, int *subLine) const
+{
+    if (!store || row < 0 || row >= totalRows) {
+        return false;
+    }
+    
+    // 先二分查找检查点，再在不超过 INDEX_STRIDE 条记录内顺序累加
+    auto it = std::upper_bound(rowCheckpoints.cbegin(), rowCheckpoints.cend(), row);
+    const int checkpoint = static_cast<int>(it - rowCheckpoints.cbegin()) - 1;
+    qint64 current = static_cast<qint64>(checkpoint) * INDEX_STRIDE;
+    qint64 start = rowCheckpoints.at(checkpoint);
+    while (current < indexedRecords) {
+        const qint64 rows = recordRows(current);
+        if (row < start + rows) {
+            *record = current;
+            *subLine = static_cast<int>(row - start);
+            return true;
+        }
+        start += rows;
+        ++current;
+    }
+    return false;
+}
+
+qint64 ReceiveView::firstRowOf(qint64 record) const
+{
+    if (!store || record >= indexedRecords) {
+        return totalRows;
+    }
+    
+    const int checkpoint = static_cast<int>(record / INDEX_STRIDE);
+    qint64 row = rowCheckpoints.at(checkpoint);
+    for (qint64 current = static_cast<qint64>(checkpoint) * INDEX_STRIDE; current < record; ++current) {
+        row += recordRows(current);
+    }
+    return row;
+}
+
+QStringList ReceiveView::recordLines(qint64 record) const
+{
+    if (!store || record < 0 || record >= store->recordCount()) {
+        return QStringList();
+    }
+    if (QStringList *cached = lineCache.object(record)) {
+        return *cached;
+    }
+    
+    QStringList lines;
+    const Record item = store->record(record);
+    const bool tx = item.direction == RecordDirection::Tx;
+    if (!tx || options.logMode) {
+        QString prefix;
+        if (options.timestamp) {
+            prefix = timestampFormatter.format(item.timestamp);
+        }
+        if (options.timestampDelta) {
+            // 与上一条显示出来的记录相比，非日志模式下隐藏的发送记录不算；只查内存中的索引
+            qint64 previous = item.timestamp;
+            for (qint64 i = record - 1; i >= 0; --i) {
+                if (options.logMode || store->direction(i) != RecordDirection::Tx) {
+                    previous = store->timestamp(i);
+                    break;
+                }
+            }
+            prefix += timestampFormatter.formatDelta(item.timestamp - previous);
+        }
+        const QString label = store->recordLabel(record);
+        if (!label.isEmpty()) {
+            prefix += QLatin1Char('[') + label + QLatin1String("] ");
+        }
+        if (options.logMode) {
+            prefix += tx ? QLatin1String("[TX] ") : QLatin1String("[RX] ");
+        }
+        if (item.flags & RecordFrameError) {
+            prefix += QLatin1String("[ERR] ");
+        }
+        if (item.flags & RecordChecksumError) {
+            prefix += QLatin1String("[CHK] ");
+        }
+        if (item.flags & RecordMarker) {
+            prefix += QLatin1String("[MARK] ");
+        }
+        
+        if (tx ? options.hexSend : options.hexReceive) {
+            lines = hexFormatter.formatLines(item.data);
+            // 多行时后续行缩进到与第一行数据对齐
+            if (lines.size() > 1 && !prefix.isEmpty()) {
+                const QString indent(prefix.size(), QLatin1Char(' '));
+                for (int i = 1; i < lines.size(); ++i) {
+                    lines[i].prepend(indent);
+                }
+            }
+            lines.first().prepend(prefix);
+        } else {
+            // 先整条解码再拆行：UTF-16/32 中 0x0A 字节不一定是换行，按字节拆开会把字符切断；
+            // 行数与 recordRows 中按同一编码统计的换行数一致
+            const SessionCodec *codec = tx ? options.sendCodec : options.receiveCodec;
+            QString text = codec ? codec->toUnicode(item.data) : QString::fromUtf8(item.data);
+            if (text.endsWith(QLatin1Char('\n'))) {
+                text.chop(1);
+            }
+            const QStringList segments = text.split(QLatin1Char('\n'));
+            for (QString segment : segments) {
+                if (segment.endsWith(QLatin1Char('\r'))) {
+                    segment.chop(1);
+                }
+                lines.append(segment);
+            }
+            lines.first().prepend(prefix);
+        }
+    }
+    lineCache.insert(record, new QStringList(lines));
+    return lines;
+}
+
+qint64 ReceiveView::rowAt(int y) const
+{
+    const qint64 row = verticalScrollBar()->value() + qMax(0, y) / lineHeight;
+    return qBound<qint64>(0, row, qMax<qint64>(0, totalRows - 1));
+}
+
+void ReceiveView::copySelection()
+{
+    const QString text = selectedText();
+    if (!text.isEmpty()) {
+        QApplication::clipboard()->setText(text);
+    }
+}
+
+void ReceiveView::selectAll()
+{
+    if (totalRows == 0) {
+        return;
+    }
+    selectionAnchor = 0;
+    selectionCursor = totalRows - 1;
+    viewport()->update();
+}
\ No newline at end of file
@@ -0,0 +1,97 @@
+#ifndef RECEIVEVIEW_H
+#define RECEIVEVIEW_H
+
+#include <QAbstractScrollArea>
+#include <QCache>
+#include <QStringList>
+#include <QVector>
+#include "hexformatter.h"
+#include "timestamp.h"
+
+class RecordSource;
+class SessionCodec;
+
+// 虚拟化的接收显示控件
+// 数据来自 RecordSource（实时接收的 ChunkStore 或打开的录制文件），控件只为可见的几十行取数据并绘制，
+// 因此无论会话里有一百行还是一千万行，滚动和重绘的开销都一样。
+// 存储中保存的是原始字节，显示方式（十六进制、编码、时间戳）在绘制时才应用。
+class ReceiveView : public QAbstractScrollArea
+{
+    Q_OBJECT
+
+public:
+    // 显示方式
+    struct RenderOptions
+    {
+        bool hexReceive = false;
+        bool hexSend = false;
+        bool timestamp = true;
+        TimestampFormatter::Precision timestampPrecision = TimestampFormatter::Milliseconds;
+        bool timestampDelta = false;       // 显示与上一条记录的时间差
+        bool logMode = true;               // 日志模式下显示发送记录并加 [TX]/[RX] 前缀
+        const SessionCodec *receiveCodec = nullptr; // 为空时按 UTF-8 解码
+        const SessionCodec *sendCodec = nullptr;
+        HexFormatOptions hex;              // 十六进制显示的分组、每行字节数和布局
+    };
+    
+    explicit ReceiveView(QWidget *parent = nullptr);
+    
+    void setStore(RecordSource *store);
+    RecordSource *source() const;
+    // 有新记录时是否跟随滚动到底部（原来停在底部时），浏览录制文件时关闭
+    void setFollowTail(bool follow);
+    
+    // 改变显示方式；只有行数改变时才重建行索引，可见部分在下次绘制时按新方式渲染
+    void setRenderOptions(const RenderOptions &options);
+    RenderOptions renderOptions() const;
+    
+    // 存储中追加了新记录后调用；原来停在底部时自动滚动到底部
+    void recordsAppended();
+    // 存储被清空或整体改变后调用
+    void reset();
+    // 滚动到记录所在的第一行并选中该行
+    void scrollToRecord(qint64 record);
+    
+    qint64 rowCount() const;
+    QString rowText(qint64 row) const;
+    QString selectedText() const;
+    // 按当前显示方式渲染一条记录，不显示的记录返回空列表
+    QStringList recordLines(qint64 record) const;
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
+    void mousePressEvent(QMouseEvent *event) override;
+    void mouseMoveEvent(QMouseEvent *event) override;
+    void changeEvent(QEvent *event) override;
+
+private:
+    void indexNewRecords();
+    void updateScrollBars();
+    int recordRows(qint64 record) const;
+    bool locateRow(qint64 row, qint64 *record, int *subLine) const;
+    qint64 firstRowOf(qint64 record) const;
+    qint64 rowAt(int y) const;
+    void copySelection();
+    void selectAll();
+    
+    RecordSource *store;
+    bool followTail;
+    RenderOptions options;
+    QString receiveRowCodec;          // 建立行索引时影响行数的编码，见 rowCodecName
+    QString sendRowCodec;
+    HexFormatter hexFormatter;
+    mutable TimestampFormatter timestampFormatter;  // 缓存当前小时的日期前缀
+    // 行索引：每 INDEX_STRIDE 条记录保存一次该记录的起始行号
+    QVector<qint64> rowCheckpoints;
+    qint64 indexedRecords;
+    qint64 totalRows;
+    int lineHeight;
+    int charWidth;
+    int maxLineWidth;                 // 已绘制过的最长行宽度，用于水平滚动范围
+    qint64 selectionAnchor;
+    qint64 selectionCursor;
+    mutable QCache<qint64, QStringList> lineCache;  // 最近绘制的记录按行拆分后的文本
+};
+
+#endif // RECEIVEVIEW_H
\ No newline at end of file
@@ -0,0 +1,95 @@
+#ifndef RECORDSOURCE_H
+#define RECORDSOURCE_H
+
+#include <QByteArray>
+#include <QString>
+#include <cstring>
+
+// 记录的数据方向
+enum class RecordDirection : quint8
+{
+    Rx = 0,
+    Tx = 1
+};
+
+// 记录标志位
+enum RecordFlag : quint8
+{
+    RecordFrameError = 0x01,    // 分帧出错：帧被截断、长度字段或转义非法
+    RecordChecksumError = 0x02, // 帧末尾的校验值不符
+    RecordMarker = 0x04         // 触发插入的标记，数据为标记文字而不是收到的字节
+};
+
+// 记录源内存索引中每条记录的 info 字段：低位为换行数，最高位表示发送方向
+static const quint32 TX_FLAG = 0x80000000u;
+
+// 一条收发记录：原始字节以及到达/发出时刻和方向
+struct Record
+{
+    qint64 timestamp = 0;      // 自1970-01-01 UTC起的纳秒数
+    RecordDirection direction = RecordDirection::Rx;
+    quint8 flags = 0;
+    QByteArray data;
+};
+
+// 统计换行符个数，末尾的换行符不产生新的显示行
+inline quint32 countLineBreaks(const char *data, qint64 length)
+{
+    quint32 count = 0;
+    const char *p = data;
+    const char *end = data + length;
+    while (p < end) {
+        const void *hit = std::memchr(p, '\n', static_cast<size_t>(end - p));
+        if (!hit) {
+            break;
+        }
+        p = static_cast<const char *>(hit) + 1;
+        if (p < end) {
+            ++count;
+        }
+    }
+    return count;
+}
+
+// 显示控件的数据来源
+// 实时接收的 ChunkStore 和打开的录制文件都通过该接口提供记录。
+// 除 record 外的查询只应访问内存中的索引，显示控件用它们计算行数而不读取数据。
+class RecordSource
+{
+public:
+    virtual ~RecordSource() = default;
+    
+    virtual qint64 recordCount() const = 0;
+    // 记录数据长度（字节，不含记录头）
+    virtual qint64 recordLength(qint64 index) const = 0;
+    // 记录数据中的换行符个数（不计末尾的换行符），文本显示行数 = 换行数 + 1
+    virtual int lineBreaks(qint64 index) const = 0;
+    virtual RecordDirection direction(qint64 index) const = 0;
+    virtual qint64 timestamp(qint64 index) const = 0;
+    virtual Record record(qint64 index) const = 0;
+    // 记录所属端口等来源标签，显示在记录前；单一来源时为空
+    virtual QString recordLabel(qint64 index) const
+    {
+        Q_UNUSED(index);
+        return QString();
+    }
+    
+    // 第一条时间不早于 timestamp 的记录序号，没有时返回 recordCount()
+    // 默认按时间二分查找，记录时间应基本有序
+    virtual qint64 findRecord(qint64 timestamp) const
+    {
+        qint64 low = 0;
+        qint64 high = recordCount();
+        while (low < high) {
+            const qint64 middle = low + (high - low) / 2;
+            if (this->timestamp(middle) < timestamp) {
+                low = middle + 1;
+            } else {
+                high = middle;
+            }
+        }
+        return low;
+    }
+};
+
+#endif // RECORDSOURCE_H
\ No newline at end of file
@@ -0,0 +1,45 @@
+#include "renderscheduler.h"
+
+// 默认刷新帧率
+static const int DEFAULT_FRAME_RATE = 30;
+
+RenderScheduler::RenderScheduler(QObject *parent)
+    : QObject(parent)
+    , timer(new QTimer(this))
+    , fps(DEFAULT_FRAME_RATE)
+{
+    timer->setSingleShot(true);
+    timer->setTimerType(Qt::PreciseTimer);
+    connect(timer, &QTimer::timeout, this, &RenderScheduler::onTimeout);
+}
+
+int RenderScheduler::frameRate() const
+{
+    return fps;
+}
+
+void RenderScheduler::setFrameRate(int value)
+{
+    fps = qBound(MIN_FRAME_RATE, value, MAX_FRAME_RATE);
+}
+
+void RenderScheduler::requestFrame()
+{
+    if (timer->isActive()) {
+        // 已经有一帧在等待，本次请求合并到该帧中
+        return;
+    }
+    
+    // 距上一帧不足一个帧间隔时，推迟到下一个帧时刻再刷新
+    qint64 delay = 0;
+    if (lastFrame.isValid()) {
+        delay = qMax<qint64>(0, 1000 / fps - lastFrame.elapsed());
+    }
+    timer->start(static_cast<int>(delay));
+}
+
+void RenderScheduler::onTimeout()
+{
+    lastFrame.restart();
+    emit frame();
+}
\ No newline at end of file
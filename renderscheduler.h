@@ -0,0 +1,42 @@
+#ifndef RENDERSCHEDULER_H
+#define RENDERSCHEDULER_H
+
+#include <QObject>
+#include <QTimer>
+#include <QElapsedTimer>
+
+// 界面刷新调度器
+// 多次 requestFrame 请求会合并成一帧，两帧之间至少间隔 1000/帧率 毫秒，
+// 因此界面刷新次数只取决于设定的帧率，而与 readyRead 触发的频率无关。
+class RenderScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    // 帧率的取值范围，界面中的设置框使用同一范围
+    static constexpr int MIN_FRAME_RATE = 1;
+    static constexpr int MAX_FRAME_RATE = 240;
+    
+    explicit RenderScheduler(QObject *parent = nullptr);
+    
+    int frameRate() const;
+
+public slots:
+    void setFrameRate(int value);
+    // 请求刷新一帧，若已有待刷新的帧则直接合并
+    void requestFrame();
+
+signals:
+    // 到达刷新时刻，接收方应一次性把积累的数据刷新到界面
+    void frame();
+
+private slots:
+    void onTimeout();
+
+private:
+    QTimer *timer;
+    QElapsedTimer lastFrame;
+    int fps;
+};
+
+#endif // RENDERSCHEDULER_H
\ No newline at end of file
@@ -0,0 +1,238 @@
+#include "replayengine.h"
+#include "capturesource.h"
+#include "outputbacklog.h"
+#include "timestamp.h"
+#include <QIODevice>
+#include <QThread>
+
+static const qint64 NS_PER_US = 1000;
+static const qint64 NS_PER_MS = 1000 * 1000;
+// 距发送时刻不足该值时不再等定时器，忙等到点
+static const qint64 SPIN_NS = NS_PER_MS;
+// 录制文件仍在建立索引、暂无后续记录时的重试间隔（毫秒）
+static const int INDEX_POLL_MS = 10;
+
+qint64 ReplayEngine::Stats::errorPercentile(double p) const
+{
+    qint64 total = 0;
+    for (qint64 count : errors) {
+        total += count;
+    }
+    if (total == 0) {
+        return 0;
+    }
+    const qint64 target = static_cast<qint64>(p * static_cast<double>(total));
+    qint64 seen = 0;
+    for (int i = 0; i < ERROR_BUCKETS; ++i) {
+        seen += errors[i];
+        if (seen > target) {
+            return (i == 0 ? 1 : (qint64(1) << i)) * NS_PER_US;
+        }
+    }
+    return errorMax;
+}
+
+ReplayEngine::ReplayEngine(QIODevice *device, QObject *parent)
+    : QObject(parent)
+    , device(device)
+    , timer(new QTimer(this))
+    , cursor(-1)
+    , nextIndex(0)
+    , firstTime(0)
+    , startTime(0)
+    , running(false)
+    , recordCount(0)
+    , indexedCount(0)
+    , byteCount(0)
+    , startStamp(0)
+    , stopStamp(0)
+    , errorSum(0)
+    , errorMax(0)
+{
+    for (std::atomic<qint64> &count : errorCounts) {
+        count.store(0, std::memory_order_relaxed);
+    }
+    timer->setSingleShot(true);
+    timer->setTimerType(Qt::PreciseTimer);
+    connect(timer, &QTimer::timeout, this, &ReplayEngine::pump);
+    // 输出缓冲区积压或不限速回放时，由串口实际写出的进度驱动
+    connect(device, &QIODevice::bytesWritten, this, [this]() {
+        if (running.load(std::memory_order_relaxed) && !timer->isActive()) {
+            pump();
+        }
+    });
+}
+
+ReplayEngine::~ReplayEngine() = default;
+
+void ReplayEngine::setWriteHook(const std::function<void(const char *, qint64)> &hook)
+{
+    writeHook = hook;
+}
+
+ReplayEngine::Stats ReplayEngine::stats() const
+{
+    Stats result;
+    result.running = running.load(std::memory_order_acquire);
+    result.records = recordCount.load(std::memory_order_relaxed);
+    result.bytes = byteCount.load(std::memory_order_relaxed);
+    result.totalRecords = indexedCount.load(std::memory_order_relaxed);
+    const qint64 begin = startStamp.load(std::memory_order_relaxed);
+    const qint64 end = result.running ? TimestampClock::now() : stopStamp.load(std::memory_order_relaxed);
+    result.elapsed = begin > 0 ? qMax<qint64>(0, end - begin) : 0;
+    result.errorSum = errorSum.load(std::memory_order_relaxed);
+    result.errorMax = errorMax.load(std::memory_order_relaxed);
+    for (int i = 0; i < ERROR_BUCKETS; ++i) {
+        result.errors[i] = errorCounts[i].load(std::memory_order_relaxed);
+    }
+    return result;
+}
+
+void ReplayEngine::start(const ReplayOptions &options)
+{
+    stop();
+    recordCount.store(0, std::memory_order_relaxed);
+    indexedCount.store(0, std::memory_order_relaxed);
+    byteCount.store(0, std::memory_order_relaxed);
+    errorSum.store(0, std::memory_order_relaxed);
+    errorMax.store(0, std::memory_order_relaxed);
+    for (std::atomic<qint64> &count : errorCounts) {
+        count.store(0, std::memory_order_relaxed);
+    }
+    startStamp.store(TimestampClock::now(), std::memory_order_relaxed);
+    
+    if (!device->isOpen()) {
+        finish(false, "串口未打开");
+        return;
+    }
+    opts = options;
+    source.reset(new CaptureSource);
+    if (!source->open(options.fileName)) {
+        finish(false, source->errorString());
+        return;
+    }
+    
+    cursor = -1;
+    nextIndex = 0;
+    firstTime = 0;
+    startTime = 0;
+    running.store(true, std::memory_order_release);
+    pump();
+}
+
+void ReplayEngine::stop()
+{
+    if (running.load(std::memory_order_relaxed)) {
+        finish(false, "已取消");
+    }
+}
+
+bool ReplayEngine::findNext()
+{
+    // 跳过不回放的方向和端口以及触发插入的标记；已索引的记录用完时返回 false
+    indexedCount.store(source->recordCount(), std::memory_order_relaxed);
+    while (nextIndex < source->recordCount()) {
+        const qint64 index = nextIndex++;
+        const RecordDirection direction = source->direction(index);
+        const bool wanted = opts.direction == ReplayOptions::ReplayBoth
+            || (direction == RecordDirection::Rx) == (opts.direction == ReplayOptions::ReplayRx);
+        if (wanted && (opts.port < 0 || source->recordPort(index) == opts.port) && source->recordLength(index) > 0
+            && !(source->recordFlags(index) & RecordMarker)) {
+            cursor = index;
+            return true;
+        }
+    }
+    return false;
+}
+
+void ReplayEngine::pump()
+{
+    if (!running.load(std::memory_order_relaxed)) {
+        return;
+    }
+    if (!device->isOpen()) {
+        finish(false, "串口已关闭");
+        return;
+    }
+    
+    const bool timed = opts.speed > 0;
+    bool wrote = false;
+    for (;;) {
+        if (cursor < 0 && !findNext()) {
+            if (source->isIndexing()) {
+                // 后台还在建立索引，稍后再取后续记录
+                timer->start(INDEX_POLL_MS);
+            } else {
+                finish(true, QString());
+            }
+            return;
+        }
+        
+        qint64 due = 0;
+        if (timed) {
+            // 第一条记录立即发送，之后按录制时间间隔除以速度
+            if (startTime == 0) {
+                firstTime = source->timestamp(cursor);
+                startTime = TimestampClock::now();
+            }
+            due = startTime + static_cast<qint64>((source->timestamp(cursor) - firstTime) / opts.speed);
+            const qint64 remaining = due - TimestampClock::now();
+            if (remaining > SPIN_NS) {
+                // 定时器只等到发送时刻前1毫秒左右，剩下的忙等，避免定时器的毫秒级误差
+                timer->start(static_cast<int>((remaining - SPIN_NS) / NS_PER_MS));
+                return;
+            }
+            if (remaining > 0 && wrote) {
+                // 已经写过数据：先回到事件循环处理串口读取等事件，下次进来再忙等
+                timer->start(0);
+                return;
+            }
+            while (TimestampClock::now() < due) {
+                QThread::yieldCurrentThread();
+            }
+        }
+        
+        // 输出缓冲区积压时等 bytesWritten 再继续；不限速时保持少量积压，由串口写出速度决定节奏
+        if (device->bytesToWrite() > (timed ? OUTPUT_MAX_PENDING_BYTES : OUTPUT_LOW_WATER)) {
+            return;
+        }
+        
+        // 直接从映射写入串口，不拷贝也不记入接收区
+        const qint64 length = source->recordLength(cursor);
+        const char *data = source->recordData(cursor);
+        const qint64 written = device->write(data, length);
+        if (written <= 0) {
+            finish(false, device->errorString());
+            return;
+        }
+        if (writeHook) {
+            writeHook(data, written);
+        }
+        if (timed) {
+            addError(TimestampClock::now() - due);
+        }
+        recordCount.fetch_add(1, std::memory_order_relaxed);
+        byteCount.fetch_add(written, std::memory_order_relaxed);
+        cursor = -1;
+        wrote = true;
+    }
+}
+
+void ReplayEngine::addError(qint64 error)
+{
+    const qint64 magnitude = qAbs(error);
+    errorSum.fetch_add(magnitude, std::memory_order_relaxed);
+    if (magnitude > errorMax.load(std::memory_order_relaxed)) {
+        errorMax.store(magnitude, std::memory_order_relaxed);
+    }
+    errorCounts[LinkStats::histogramBucket(magnitude / NS_PER_US)].fetch_add(1, std::memory_order_relaxed);
+}
+
+void ReplayEngine::finish(bool ok, const QString &errorString)
+{
+    timer->stop();
+    running.store(false, std::memory_order_release);
+    stopStamp.store(TimestampClock::now(), std::memory_order_relaxed);
+    source.reset();
+    emit finished(ok, errorString);
+}
\ No newline at end of file
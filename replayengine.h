@@ -0,0 +1,110 @@
+#ifndef REPLAYENGINE_H
+#define REPLAYENGINE_H
+
+#include <QObject>
+#include <QString>
+#include <QTimer>
+#include <atomic>
+#include <functional>
+#include <memory>
+
+#include "linkstats.h"
+
+class CaptureSource;
+class QIODevice;
+
+// 回放参数
+struct ReplayOptions
+{
+    enum Direction
+    {
+        ReplayRx,           // 回放录制时收到的数据（默认）
+        ReplayTx,           // 回放录制时发出的数据
+        ReplayBoth
+    };
+    
+    QString fileName;
+    double speed = 1.0;         // 回放速度倍数，0 为不按时间、以串口最快速度回放
+    Direction direction = ReplayRx;
+    int port = -1;              // 只回放录制文件中该编号端口的记录，-1 为全部
+};
+
+// 录制文件回放引擎，运行在会话的I/O线程中
+// 录制文件以内存映射方式打开，记录数据直接从映射写入串口，不经过界面也不逐条记入接收区。
+// 第 i 条记录的发送时刻为 开始时刻 + (记录时间 - 第一条记录时间) / 速度，按绝对时刻计算不累积误差；
+// 定时器唤醒到发送时刻前不足1毫秒时忙等到点，实际写出时刻与计划时刻之差计入误差统计。
+// 串口输出缓冲区积压过多（速度超过波特率）时等待写出，推迟的时间同样计入误差。
+class ReplayEngine : public QObject
+{
+    Q_OBJECT
+
+public:
+    // 定时误差与读取间隔直方图同样按微秒的2的幂分桶，见 LinkStats::histogramBucket
+    static const int ERROR_BUCKETS = LinkStats::HISTOGRAM_BUCKETS;
+    
+    // 回放统计，任意线程都可以读取
+    struct Stats
+    {
+        qint64 records = 0;         // 已回放的记录数
+        qint64 totalRecords = 0;    // 录制文件中已建立索引的记录数
+        qint64 bytes = 0;
+        qint64 elapsed = 0;         // 纳秒
+        bool running = false;
+        qint64 errorSum = 0;        // 定时误差绝对值之和（纳秒）
+        qint64 errorMax = 0;
+        qint64 errors[ERROR_BUCKETS] = {};
+        
+        double meanError() const
+        {
+            return records > 0 ? static_cast<double>(errorSum) / records : 0.0;
+        }
+        // 误差分位数的上界（纳秒），由分桶估计
+        qint64 errorPercentile(double p) const;
+    };
+    
+    explicit ReplayEngine(QIODevice *device, QObject *parent = nullptr);
+    ~ReplayEngine();
+    
+    // 每次写入成功后在I/O线程中调用，用于统计和录制
+    void setWriteHook(const std::function<void(const char *, qint64)> &hook);
+    
+    Stats stats() const;
+
+public slots:
+    // 以下槽函数都应通过排队连接在I/O线程中调用
+    void start(const ReplayOptions &options);
+    void stop();
+
+signals:
+    // 回放结束：全部写出、出错或被取消
+    void finished(bool ok, const QString &errorString);
+
+private slots:
+    void pump();
+
+private:
+    bool findNext();
+    void addError(qint64 error);
+    void finish(bool ok, const QString &errorString);
+    
+    QIODevice *device;
+    QTimer *timer;
+    std::function<void(const char *, qint64)> writeHook;
+    std::unique_ptr<CaptureSource> source;
+    ReplayOptions opts;
+    qint64 cursor;              // 已找到、尚未写出的记录，-1 为没有
+    qint64 nextIndex;           // 下一条要检查的记录
+    qint64 firstTime;           // 第一条回放记录的录制时间
+    qint64 startTime;
+    std::atomic<bool> running;
+    std::atomic<qint64> recordCount;
+    std::atomic<qint64> indexedCount;
+    std::atomic<qint64> byteCount;
+    std::atomic<qint64> startStamp;
+    std::atomic<qint64> stopStamp;
+    std::atomic<qint64> errorSum;
+    std::atomic<qint64> errorMax;
+    std::atomic<qint64> errorCounts[ERROR_BUCKETS];
+};
+
+#endif // REPLAYENGINE_H
\ No newline at end of file
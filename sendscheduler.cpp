@@ -0,0 +1,169 @@
+#include "sendscheduler.h"
+#include "outputbacklog.h"
+#include "timestamp.h"
+#include <QIODevice>
+
+
+SendScheduler::SendScheduler(QIODevice *device, QObject *parent)
+    : QObject(parent)
+    , device(device)
+    , timer(new QTimer(this))
+    , burstCount(1)
+    , period(0)
+    , startTime(0)
+    , nextTick(0)
+    , running(false)
+    , sendCount(0)
+    , missedCount(0)
+    , startStamp(0)
+    , stopStamp(0)
+    , byteCount(0)
+{
+    // 每次只等到下一个发送时刻，按绝对时刻重新计算间隔，定时器误差不会累积
+    timer->setSingleShot(true);
+    timer->setTimerType(Qt::PreciseTimer);
+    connect(timer, &QTimer::timeout, this, &SendScheduler::onTimeout);
+    connect(device, &QIODevice::bytesWritten, this, &SendScheduler::onBytesWritten);
+}
+
+void SendScheduler::setWriteHook(const std::function<void(const char *, qint64)> &hook)
+{
+    writeHook = hook;
+}
+
+bool SendScheduler::isRunning() const
+{
+    return running.load(std::memory_order_acquire);
+}
+
+SendScheduler::Stats SendScheduler::stats() const
+{
+    Stats result;
+    result.sends = sendCount.load(std::memory_order_relaxed);
+    result.missed = missedCount.load(std::memory_order_relaxed);
+    result.bytes = byteCount.load(std::memory_order_relaxed);
+    const qint64 begin = startStamp.load(std::memory_order_relaxed);
+    const qint64 end = isRunning() ? TimestampClock::now() : stopStamp.load(std::memory_order_relaxed);
+    result.elapsed = begin > 0 ? qMax<qint64>(0, end - begin) : 0;
+    return result;
+}
+
+void SendScheduler::setPayload(const QByteArray &value)
+{
+    payload = value;
+    rebuildBurst();
+}
+
+void SendScheduler::start(const QByteArray &value, int interval, int burst)
+{
+    stop();
+    payload = value;
+    burstCount = qMax(1, burst);
+    period = static_cast<qint64>(qMax(0, interval)) * 1000000;
+    rebuildBurst();
+    if (burstData.isEmpty() || !device->isOpen()) {
+        return;
+    }
+    
+    sendCount.store(0, std::memory_order_relaxed);
+    missedCount.store(0, std::memory_order_relaxed);
+    startTime = TimestampClock::now();
+    startStamp.store(startTime, std::memory_order_relaxed);
+    nextTick = 0;
+    running.store(true, std::memory_order_release);
+    
+    // 第一次立即发送
+    if (period == 0) {
+        onBytesWritten();
+    } else {
+        onTimeout();
+    }
+}
+
+void SendScheduler::stop()
+{
+    timer->stop();
+    if (running.exchange(false, std::memory_order_acq_rel)) {
+        stopStamp.store(TimestampClock::now(), std::memory_order_relaxed);
+    }
+}
+
+void SendScheduler::onTimeout()
+{
+    if (!isRunning() || period == 0) {
+        return;
+    }
+    if (!device->isOpen()) {
+        stop();
+        return;
+    }
+    
+    // 定时器提前不足半毫秒视为已到时；来晚超过一个周期时跳过中间的发送时刻，不补发
+    const qint64 now = TimestampClock::now();
+    const qint64 due = (now - startTime + 500000) / period;
+    if (due < nextTick) {
+        scheduleNext();
+        return;
+    }
+    if (due > nextTick) {
+        missedCount.fetch_add(due - nextTick, std::memory_order_relaxed);
+    }
+    nextTick = due + 1;
+    
+    if (device->bytesToWrite() > OUTPUT_MAX_PENDING_BYTES) {
+        // 串口写不过来，本周期放弃
+        missedCount.fetch_add(1, std::memory_order_relaxed);
+    } else if (!writeBurst()) {
+        stop();
+        return;
+    }
+    scheduleNext();
+}
+
+void SendScheduler::onBytesWritten()
+{
+    if (!isRunning() || period != 0 || burstData.isEmpty()) {
+        return;
+    }
+    
+    // 连续发送：输出缓冲区快空时补一批，发送节奏由串口实际写出的速度决定
+    while (device->isOpen() && device->bytesToWrite() < OUTPUT_LOW_WATER) {
+        if (!writeBurst()) {
+            stop();
+            return;
+        }
+    }
+}
+
+void SendScheduler::rebuildBurst()
+{
+    burstData.clear();
+    burstData.reserve(payload.size() * burstCount);
+    for (int i = 0; i < burstCount; ++i) {
+        burstData.append(payload);
+    }
+}
+
+void SendScheduler::scheduleNext()
+{
+    // 按毫秒四舍五入，到时误差不超过半毫秒
+    const qint64 remaining = startTime + nextTick * period - TimestampClock::now();
+    timer->start(static_cast<int>(qMax<qint64>(0, (remaining + 500000) / 1000000)));
+}
+
+bool SendScheduler::writeBurst()
+{
+    if (burstData.isEmpty()) {
+        return true;
+    }
+    const qint64 written = device->write(burstData);
+    if (written <= 0) {
+        return false;
+    }
+    if (writeHook) {
+        writeHook(burstData.constData(), written);
+    }
+    sendCount.fetch_add(burstCount, std::memory_order_relaxed);
+    byteCount.fetch_add(written, std::memory_order_relaxed);
+    return true;
+}
\ No newline at end of file
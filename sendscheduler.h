@@ -0,0 +1,78 @@
+#ifndef SENDSCHEDULER_H
+#define SENDSCHEDULER_H
+
+#include <QByteArray>
+#include <QObject>
+#include <QTimer>
+#include <atomic>
+#include <functional>
+
+class QIODevice;
+
+// 自动发送调度器，运行在会话的I/O线程中
+// 发送内容由GUI线程编码好后一次性交给调度器，每个周期只是把同一块数据写入串口，不再解析或编码。
+// 发送时刻按 开始时刻 + n * 周期 计算，不随定时器误差累积漂移；周期为0时连续发送，
+// 串口输出缓冲区一空就补一批。每个周期可以连续发送多次（突发）。
+class SendScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    // 统计数据，任意线程都可以读取
+    struct Stats
+    {
+        qint64 sends = 0;           // 本次启动后发送的次数（突发中的每次都计入）
+        qint64 missed = 0;          // 错过的发送时刻：定时器来晚或输出缓冲区积压时跳过的周期
+        qint64 elapsed = 0;         // 本次启动后经过的时间（纳秒）
+        qint64 bytes = 0;           // 自创建以来自动发送的总字节数
+        
+        // 实际达到的发送速率（次/秒）
+        double rate() const
+        {
+            return elapsed > 0 ? sends * 1e9 / elapsed : 0.0;
+        }
+    };
+    
+    explicit SendScheduler(QIODevice *device, QObject *parent = nullptr);
+    
+    // 每次写入成功后在I/O线程中调用，用于录制等
+    void setWriteHook(const std::function<void(const char *, qint64)> &hook);
+    
+    bool isRunning() const;
+    Stats stats() const;
+
+public slots:
+    // 以下槽函数都应通过排队连接在I/O线程中调用
+    // 替换发送内容，不影响发送节奏
+    void setPayload(const QByteArray &payload);
+    // interval 为周期（毫秒），0 表示连续发送；burst 为每个周期连续发送的次数
+    void start(const QByteArray &payload, int interval, int burst);
+    void stop();
+
+private slots:
+    void onTimeout();
+    void onBytesWritten();
+
+private:
+    void rebuildBurst();
+    void scheduleNext();
+    bool writeBurst();
+    
+    QIODevice *device;
+    QTimer *timer;
+    std::function<void(const char *, qint64)> writeHook;
+    QByteArray payload;
+    QByteArray burstData;       // payload 重复 burst 次，一次写入
+    int burstCount;
+    qint64 period;              // 纳秒，0 为连续发送
+    qint64 startTime;
+    qint64 nextTick;            // 下一个发送时刻的序号
+    std::atomic<bool> running;
+    std::atomic<qint64> sendCount;
+    std::atomic<qint64> missedCount;
+    std::atomic<qint64> startStamp;
+    std::atomic<qint64> stopStamp;
+    std::atomic<qint64> byteCount;
+};
+
+#endif // SENDSCHEDULER_H
\ No newline at end of file
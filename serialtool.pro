@@ -1,4 +1,4 @@
-QT       += core gui serialport core5compat
+QT       += core gui serialport network core5compat
 
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
@@ -8,13 +8,52 @@ CONFIG += c++17
 # In order to do so, uncomment the following line.
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
+include(serialtoolcore.pri)
+
 SOURCES += \
     main.cpp \
+    capturesource.cpp \
+    chunkstore.cpp \
+    filesender.cpp \
+    headless.cpp \
+    linkstats.cpp \
     mainwindow.cpp \
+    mergedsource.cpp \
+    plotview.cpp \
+    popupcombobox.cpp \
+    portbridge.cpp \
+    portwatcher.cpp \
+    receiveview.cpp \
+    renderscheduler.cpp \
+    replayengine.cpp \
+    sendscheduler.cpp \
+    session.cpp \
+    serialworker.cpp \
+    triggerengine.cpp \
     win32fix.cpp
 
 HEADERS += \
-    mainwindow.h
+    capturesource.h \
+    chunkstore.h \
+    filesender.h \
+    headless.h \
+    linkstats.h \
+    mainwindow.h \
+    mergedsource.h \
+    outputbacklog.h \
+    plotview.h \
+    popupcombobox.h \
+    portbridge.h \
+    portwatcher.h \
+    receiveview.h \
+    recordsource.h \
+    renderscheduler.h \
+    replayengine.h \
+    sendscheduler.h \
+    session.h \
+    serialworker.h \
+    spscringbuffer.h \
+    triggerengine.h
 
 # Default rules for deployment.
 qnx: target.path = /tmp/$${TARGET}/bin
@@ -0,0 +1,43 @@
+# 伪终端回环基准测试，依赖 openpty，只能在 Linux 上构建
+QT       = core serialport network core5compat
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+TARGET = SerialToolBench
+
+LIBS += -lutil
+
+include(serialtoolcore.pri)
+
+SOURCES += \
+    loopbackbench.cpp \
+    allocationcounter.cpp \
+    capturesource.cpp \
+    chunkstore.cpp \
+    filesender.cpp \
+    linkstats.cpp \
+    portbridge.cpp \
+    renderscheduler.cpp \
+    replayengine.cpp \
+    sendscheduler.cpp \
+    session.cpp \
+    serialworker.cpp \
+    triggerengine.cpp
+
+HEADERS += \
+    allocationcounter.h \
+    capturesource.h \
+    chunkstore.h \
+    filesender.h \
+    linkstats.h \
+    outputbacklog.h \
+    portbridge.h \
+    recordsource.h \
+    renderscheduler.h \
+    replayengine.h \
+    sendscheduler.h \
+    session.h \
+    serialworker.h \
+    spscringbuffer.h \
+    triggerengine.h
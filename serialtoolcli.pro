@@ -0,0 +1,46 @@
+# 无界面命令行版本，只链接 Qt Core 和 SerialPort，不包含任何窗口部件
+QT       = core serialport network core5compat
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+TARGET = SerialToolCli
+
+include(serialtoolcore.pri)
+
+SOURCES += \
+    headlessmain.cpp \
+    capturesource.cpp \
+    chunkstore.cpp \
+    filesender.cpp \
+    headless.cpp \
+    linkstats.cpp \
+    portbridge.cpp \
+    renderscheduler.cpp \
+    replayengine.cpp \
+    sendscheduler.cpp \
+    session.cpp \
+    serialworker.cpp \
+    triggerengine.cpp
+
+HEADERS += \
+    capturesource.h \
+    chunkstore.h \
+    filesender.h \
+    headless.h \
+    linkstats.h \
+    outputbacklog.h \
+    portbridge.h \
+    recordsource.h \
+    renderscheduler.h \
+    replayengine.h \
+    sendscheduler.h \
+    session.h \
+    serialworker.h \
+    spscringbuffer.h \
+    triggerengine.h
+
+# Default rules for deployment.
+qnx: target.path = /tmp/$${TARGET}/bin
+else: unix:!android: target.path = /opt/$${TARGET}/bin
+!isEmpty(target.path): INSTALLS += target
@@ -0,0 +1,27 @@
+# 与界面无关的数据处理代码：十六进制格式化/解析、编解码、分帧、帧校验、时间戳、遥测解析、波形采样序列、多模式匹配和录制文件读写
+# 各个 .pro 通过 include() 引入，对应 CMakeLists.txt 中的 SerialToolCore 静态库
+INCLUDEPATH += $$PWD
+
+SOURCES += \
+    $$PWD/capturefile.cpp \
+    $$PWD/checksum.cpp \
+    $$PWD/framer.cpp \
+    $$PWD/hexformatter.cpp \
+    $$PWD/hexparser.cpp \
+    $$PWD/plotseries.cpp \
+    $$PWD/sessioncodec.cpp \
+    $$PWD/telemetryparser.cpp \
+    $$PWD/timestamp.cpp \
+    $$PWD/triggermatcher.cpp
+
+HEADERS += \
+    $$PWD/capturefile.h \
+    $$PWD/checksum.h \
+    $$PWD/framer.h \
+    $$PWD/hexformatter.h \
+    $$PWD/hexparser.h \
+    $$PWD/plotseries.h \
+    $$PWD/sessioncodec.h \
+    $$PWD/telemetryparser.h \
+    $$PWD/timestamp.h \
+    $$PWD/triggermatcher.h
@@ -0,0 +1,12 @@
+# 数据处理代码的自检和微基准测试，不依赖界面
+QT       = core core5compat
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+TARGET = SerialToolCoreBench
+
+include(serialtoolcore.pri)
+
+SOURCES += \
+    corebench.cpp
@@ -0,0 +1,217 @@
+#include "serialworker.h"
+#include "capturefile.h"
+#include "timestamp.h"
+
+// 接收环形缓冲区容量：921600波特率下约可缓冲40秒数据
+static const qint64 RX_RING_CAPACITY = 4 * 1024 * 1024;
+// 读取时刻队列容量；队列满时后续数据沿用前一个时刻
+static const qint64 RX_MARK_CAPACITY = 8192;
+
+SerialWorker::SerialWorker(QObject *parent)
+    : QObject(parent)
+    , serial(new QSerialPort(this))
+    , scheduler(new SendScheduler(serial, this))
+    , transfer(new FileSender(serial, this))
+    , bridge(new PortBridge(serial, this))
+    , replay(new ReplayEngine(serial, this))
+    , triggers(new TriggerEngine(serial, this))
+    , rxRing(RX_RING_CAPACITY)
+    , rxMarkQueue(RX_MARK_CAPACITY)
+    , rxNotifyPending(false)
+    , rxStalled(false)
+    , capture(nullptr)
+    , capturePort(0)
+{
+    connect(serial, &QSerialPort::readyRead, this, &SerialWorker::onReadyRead);
+    connect(serial, &QSerialPort::errorOccurred, this, &SerialWorker::onErrorOccurred);
+    
+    // 自动发送和文件发送的数据同样写入录制文件；发送计数由它们自己统计，不逐次通知界面
+    scheduler->setWriteHook([this](const char *data, qint64 length) {
+        recordTx(data, length);
+    });
+    transfer->setWriteHook([this](const char *data, qint64 length) {
+        recordTx(data, length);
+    });
+    bridge->setWriteHook([this](const char *data, qint64 length) {
+        recordTx(data, length);
+    });
+    replay->setWriteHook([this](const char *data, qint64 length) {
+        recordTx(data, length);
+    });
+    triggers->setWriteHook([this](const char *data, qint64 length) {
+        recordTx(data, length);
+    });
+    // 标记立即写入录制文件；停止录制时本串口立即不再写入，录制文件由界面随后关闭
+    triggers->setActionHook([this](const TriggerRule &rule, qint64 timestamp) {
+        if (!capture) {
+            return;
+        }
+        if (rule.action == TriggerRule::Marker) {
+            const QByteArray text = rule.markerText();
+            capture->write(timestamp, RecordDirection::Rx, capturePort, text.constData(), text.size(), RecordMarker);
+        } else if (rule.action == TriggerRule::StopRecord) {
+            capture = nullptr;
+        }
+    });
+}
+
+SerialWorker::~SerialWorker()
+{
+    if (serial->isOpen()) {
+        serial->close();
+    }
+}
+
+void SerialWorker::acknowledgeRx()
+{
+    rxNotifyPending.store(false, std::memory_order_release);
+}
+
+void SerialWorker::releaseRx()
+{
+    if (rxStalled.exchange(false, std::memory_order_seq_cst)) {
+        // 环形缓冲区已腾出空间，回到I/O线程继续读取滞留在QSerialPort中的数据
+        QMetaObject::invokeMethod(this, &SerialWorker::onReadyRead, Qt::QueuedConnection);
+    }
+}
+
+void SerialWorker::openPort(const SerialConfig &config)
+{
+    scheduler->stop();
+    transfer->cancel();
+    replay->stop();
+    bridge->close();
+    if (serial->isOpen()) {
+        serial->close();
+    }
+    
+    serial->setPortName(config.portName);
+    serial->setBaudRate(config.baudRate);
+    serial->setDataBits(config.dataBits);
+    serial->setStopBits(config.stopBits);
+    serial->setParity(config.parity);
+    serial->setFlowControl(config.flowControl);
+    
+    if (serial->open(QIODevice::ReadWrite)) {
+        triggers->reset();
+        if (capture) {
+            capturePort = capture->addPort(config.portName);
+        }
+        emit portOpened();
+    } else {
+        emit portOpenFailed(serial->errorString());
+    }
+}
+
+void SerialWorker::closePort()
+{
+    scheduler->stop();
+    transfer->cancel();
+    replay->stop();
+    if (serial->isOpen()) {
+        // 关闭前把已经到达的数据取走，避免丢失最后一段数据
+        onReadyRead();
+        serial->close();
+    }
+    bridge->close();
+    emit portClosed();
+}
+
+void SerialWorker::writeData(const QByteArray &data)
+{
+    if (!serial->isOpen()) {
+        return;
+    }
+    
+    qint64 bytesWritten = serial->write(data);
+    if (bytesWritten > 0) {
+        recordTx(data.constData(), bytesWritten);
+        emit dataWritten(bytesWritten);
+    }
+}
+
+void SerialWorker::setCaptureWriter(CaptureWriter *writer)
+{
+    capture = writer;
+    if (capture && serial->isOpen()) {
+        capturePort = capture->addPort(serial->portName());
+    }
+}
+
+void SerialWorker::recordTx(const char *data, qint64 length)
+{
+    const qint64 timestamp = TimestampClock::now();
+    linkStats.addWrite(timestamp, length);
+    if (capture) {
+        capture->write(timestamp, RecordDirection::Tx, capturePort, data, length);
+    }
+}
+
+void SerialWorker::onReadyRead()
+{
+    // 在读数据的当下取时间，而不是等GUI线程取走数据时
+    const qint64 timestamp = TimestampClock::now();
+    bool produced = false;
+    qint64 received = 0;
+    while (serial->bytesAvailable() > 0) {
+        qint64 length = 0;
+        char *region = rxRing.writeRegion(&length);
+        if (length == 0) {
+            // 环形缓冲区已满，剩余数据留在QSerialPort内部缓冲区中，等GUI取走数据后再读
+            rxStalled.store(true, std::memory_order_seq_cst);
+            // 再检查一次：GUI可能恰好在设置标志之前取走了数据而没有看到该标志
+            if (rxRing.freeSpace() == 0 || !rxStalled.exchange(false, std::memory_order_seq_cst)) {
+                break;
+            }
+            continue;
+        }
+        
+        // 直接读入环形缓冲区，不产生临时QByteArray
+        const quint64 position = rxRing.writePosition();
+        qint64 n = serial->read(region, length);
+        if (n <= 0) {
+            break;
+        }
+        if (!produced) {
+            RxMark mark;
+            mark.position = position;
+            mark.timestamp = timestamp;
+            rxMarkQueue.push(mark);
+        }
+        // 录制在读取的当下从环形缓冲区拷贝，与界面显示互不影响
+        if (capture) {
+            capture->write(timestamp, RecordDirection::Rx, capturePort, region, n);
+        }
+        // 桥接客户端同样直接从环形缓冲区取数据
+        bridge->forward(region, n);
+        // 触发器在数据交给GUI线程之前匹配，需要发送的响应当场写出
+        triggers->scan(region, n, position, timestamp);
+        rxRing.commitWrite(n);
+        produced = true;
+        received += n;
+    }
+    
+    if (produced) {
+        linkStats.addRead(timestamp, received);
+    }
+    if (produced && !rxNotifyPending.exchange(true, std::memory_order_acq_rel)) {
+        emit rxReady();
+    }
+}
+
+void SerialWorker::onErrorOccurred(QSerialPort::SerialPortError error)
+{
+    if (error != QSerialPort::NoError) {
+        linkStats.addError(error);
+    }
+    
+    // 设备被拔出等致命错误时主动关闭串口，通知界面更新状态
+    if (error == QSerialPort::ResourceError && serial->isOpen()) {
+        scheduler->stop();
+        transfer->cancel();
+        replay->stop();
+        bridge->close();
+        serial->close();
+        emit portClosed();
+    }
+}
\ No newline at end of file
@@ -0,0 +1,109 @@
+#ifndef SERIALWORKER_H
+#define SERIALWORKER_H
+
+#include <QObject>
+#include <QSerialPort>
+#include <atomic>
+
+#include "filesender.h"
+#include "linkstats.h"
+#include "portbridge.h"
+#include "replayengine.h"
+#include "sendscheduler.h"
+#include "spscringbuffer.h"
+#include "triggerengine.h"
+
+class CaptureWriter;
+
+// 打开串口所需的全部参数，由GUI线程从界面收集后交给I/O线程
+struct SerialConfig
+{
+    QString portName;
+    qint32 baudRate = 115200;
+    QSerialPort::DataBits dataBits = QSerialPort::Data8;
+    QSerialPort::StopBits stopBits = QSerialPort::OneStop;
+    QSerialPort::Parity parity = QSerialPort::NoParity;
+    QSerialPort::FlowControl flowControl = QSerialPort::NoFlowControl;
+};
+
+// 一次读取的起点：数据在接收流中的位置以及读到数据的时刻
+struct RxMark
+{
+    quint64 position = 0;       // 对应 SpscRingBuffer::writePosition()
+    qint64 timestamp = 0;       // TimestampClock::now()
+};
+
+// 串口I/O工作对象，运行在独立的I/O线程中
+// 接收数据直接读入无锁环形缓冲区，GUI线程按自己的节奏取走，
+// 界面卡顿不会阻塞串口读取，也就不会导致驱动缓冲区溢出丢数据。
+class SerialWorker : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit SerialWorker(QObject *parent = nullptr);
+    ~SerialWorker();
+    
+    // 接收环形缓冲区，I/O线程写入，GUI线程读取
+    SpscRingBuffer *rxBuffer() { return &rxRing; }
+    // 与接收数据对应的读取时刻，每次从串口读取时记录一个
+    SpscQueue<RxMark> *rxMarks() { return &rxMarkQueue; }
+    // 自动发送调度器，与本对象同在I/O线程；统计数据可在任意线程读取
+    SendScheduler *sendScheduler() { return scheduler; }
+    // 文件发送器，与本对象同在I/O线程；进度可在任意线程读取
+    FileSender *fileSender() { return transfer; }
+    // 链路统计，收发和错误在I/O线程中计入
+    LinkStats *stats() { return &linkStats; }
+    // 本机套接字桥接，与本对象同在I/O线程；状态可在任意线程读取
+    PortBridge *portBridge() { return bridge; }
+    // 录制文件回放引擎，与本对象同在I/O线程；统计数据可在任意线程读取
+    ReplayEngine *replayEngine() { return replay; }
+    // 接收数据触发器，与本对象同在I/O线程；事件队列和统计数据由GUI线程读取
+    TriggerEngine *triggerEngine() { return triggers; }
+    
+    // 以下两个函数由GUI线程调用
+    // 取数据前调用，表示已经收到 rxReady 通知，之后的新数据会再次通知
+    void acknowledgeRx();
+    // 取完数据后调用，若I/O线程曾因缓冲区满而暂停读取则恢复读取
+    void releaseRx();
+
+public slots:
+    // 以下槽函数都应通过排队连接在I/O线程中调用
+    void openPort(const SerialConfig &config);
+    void closePort();
+    void writeData(const QByteArray &data);
+    // 开始/停止把收发数据写入录制文件，writer 为 nullptr 时停止
+    void setCaptureWriter(CaptureWriter *writer);
+
+signals:
+    void portOpened();
+    void portOpenFailed(const QString &errorString);
+    void portClosed();
+    void dataWritten(qint64 bytes);
+    // 环形缓冲区中有新数据，多次写入只会通知一次，直到GUI调用 acknowledgeRx
+    void rxReady();
+
+private slots:
+    void onReadyRead();
+    void onErrorOccurred(QSerialPort::SerialPortError error);
+
+private:
+    // 发送的数据计入统计并写入录制文件
+    void recordTx(const char *data, qint64 length);
+    
+    QSerialPort *serial;
+    SendScheduler *scheduler;
+    FileSender *transfer;
+    PortBridge *bridge;
+    ReplayEngine *replay;
+    TriggerEngine *triggers;
+    SpscRingBuffer rxRing;
+    SpscQueue<RxMark> rxMarkQueue;
+    LinkStats linkStats;
+    std::atomic<bool> rxNotifyPending;
+    std::atomic<bool> rxStalled;
+    CaptureWriter *capture;
+    quint16 capturePort;
+};
+
+#endif // SERIALWORKER_H
\ No newline at end of file
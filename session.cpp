@@ -0,0 +1,607 @@
+#include "session.h"
+#include "capturefile.h"
+#include "sessioncodec.h"
+#include "timestamp.h"
+
+// 被截断的多字节字符最多等待后续字节的时间（毫秒）
+static const int CARRY_TIMEOUT_MS = 100;
+
+Session::Session(QObject *parent)
+    : QObject(parent)
+    , ioThread(new QThread(this))
+    , worker(new SerialWorker)
+    , receiveStore(new ChunkStore)
+    , receiveCodec(nullptr)
+    , portOpen(false)
+    , opening(false)
+    , receiveCarryTime(0)
+    , carryFlushTimer(new QTimer(this))
+    , checksumTrailer(0)
+    , rxSegmentTime(0)
+    , frameIdleTimer(new QTimer(this))
+    , autoSending(false)
+    , autoSendPeriod(0)
+    , autoSendCount(1)
+    , autoSendBytesCleared(0)
+    , sendingFile(false)
+    , fileBytesCleared(0)
+    , replaying(false)
+    , replayBytesCleared(0)
+    , bridging(false)
+    , triggerGeneration(0)
+    , triggerBytesCleared(0)
+    , sendBytes(0)
+    , receiveBytes(0)
+{
+    // 串口I/O放到会话自己的线程，界面卡顿或其他串口繁忙都不影响本串口读取
+    worker->moveToThread(ioThread);
+    ioThread->start();
+    
+    connect(worker, &SerialWorker::rxReady, this, &Session::updateRequested);
+    connect(worker, &SerialWorker::portOpened, this, &Session::onPortOpened);
+    connect(worker, &SerialWorker::portOpenFailed, this, &Session::onPortOpenFailed);
+    connect(worker, &SerialWorker::portClosed, this, &Session::onPortClosed);
+    connect(worker->fileSender(), &FileSender::finished, this, &Session::onFileSendFinished);
+    connect(worker->replayEngine(), &ReplayEngine::finished, this, &Session::onReplayFinished);
+    connect(worker, &SerialWorker::dataWritten, this, [this](qint64 bytes) {
+        // 计数在下一帧与接收计数一起刷新
+        sendBytes += bytes;
+        emit updateRequested();
+    });
+    
+    PortBridge *bridge = worker->portBridge();
+    connect(bridge, &PortBridge::listening, this, [this](const QString &address) {
+        bridging = true;
+        bridgeListenAddress = address;
+        emit bridgeChanged();
+    });
+    connect(bridge, &PortBridge::listenFailed, this, [this](const QString &errorString) {
+        bridging = false;
+        emit bridgeFailed(errorString);
+    });
+    connect(bridge, &PortBridge::closed, this, [this]() {
+        bridging = false;
+        emit bridgeChanged();
+    });
+    connect(bridge, &PortBridge::clientsChanged, this, &Session::bridgeChanged);
+    connect(bridge, &PortBridge::dataWritten, this, [this](qint64 timestamp, const QByteArray &data) {
+        // 桥接控制端发出的数据与手动发送一样记入接收存储和发送计数
+        receiveStore->append(timestamp, RecordDirection::Tx, data);
+        sendBytes += data.size();
+        emit updateRequested();
+    });
+    
+    // 每凑齐一帧保存一条记录，时间为帧第一个字节的读取时刻；完整的帧再核对末尾的校验值
+    framer.setFrameHandler([this](const char *data, qint64 length, qint64 timestamp, bool error) {
+        const bool checksumError = !error && frameChecksum.type() != Checksum::None
+            && !frameChecksum.verify(data, length - qMin<qint64>(checksumTrailer, length));
+        const quint8 flags = (error ? RecordFrameError : 0) | (checksumError ? RecordChecksumError : 0);
+        receiveStore->append(timestamp, RecordDirection::Rx, data, length, flags);
+        worker->stats()->addFrame(timestamp, error, checksumError);
+    });
+    frameIdleTimer->setSingleShot(true);
+    connect(frameIdleTimer, &QTimer::timeout, this, &Session::updateRequested);
+    carryFlushTimer->setSingleShot(true);
+    connect(carryFlushTimer, &QTimer::timeout, this, &Session::updateRequested);
+}
+
+Session::~Session()
+{
+    // 在I/O线程中关闭串口，然后停止线程
+    QMetaObject::invokeMethod(worker, &SerialWorker::closePort, Qt::BlockingQueuedConnection);
+    ioThread->quit();
+    ioThread->wait();
+    delete worker;
+    delete receiveStore;
+}
+
+ChunkStore *Session::store() const
+{
+    return receiveStore;
+}
+
+QString Session::name() const
+{
+    return sessionName;
+}
+
+void Session::setName(const QString &name)
+{
+    sessionName = name;
+}
+
+bool Session::isOpen() const
+{
+    return portOpen;
+}
+
+bool Session::isOpening() const
+{
+    return opening;
+}
+
+QString Session::errorString() const
+{
+    return lastError;
+}
+
+qint64 Session::sentBytes() const
+{
+    // 手动发送的字节数加上调度器自动发送、正在发送的文件和正在回放的录制文件已写出的字节数
+    qint64 bytes = sendBytes + worker->sendScheduler()->stats().bytes - autoSendBytesCleared;
+    if (sendingFile) {
+        bytes += worker->fileSender()->progress().sent - fileBytesCleared;
+    }
+    if (replaying) {
+        bytes += worker->replayEngine()->stats().bytes - replayBytesCleared;
+    }
+    // 触发发送由I/O线程直接写出，不经过 dataWritten
+    bytes += worker->triggerEngine()->stats().bytes - triggerBytesCleared;
+    return bytes;
+}
+
+qint64 Session::receivedBytes() const
+{
+    return receiveBytes;
+}
+
+SerialConfig Session::config() const
+{
+    return portConfig;
+}
+
+LinkStats *Session::stats() const
+{
+    return worker->stats();
+}
+
+void Session::setReceiveCodec(const SessionCodec *codec)
+{
+    receiveCodec = codec;
+}
+
+void Session::setFramingConfig(const FramingConfig &config)
+{
+    // 先按旧方式取走已收到的数据，未凑齐的帧原样保存后再切换
+    readData();
+    framer.flush();
+    if (config.mode != FramingConfig::None && !receiveCarry.isEmpty()) {
+        receiveStore->append(receiveCarryTime, RecordDirection::Rx, receiveCarry);
+        receiveCarry.resize(0);
+    }
+    framer.setConfig(config);
+    frameChecksum = config.mode != FramingConfig::None ? config.checksum : Checksum();
+    checksumTrailer = config.mode == FramingConfig::Delimiter && config.keepDelimiter
+        ? static_cast<int>(config.delimiter.size()) : 0;
+    frameIdleTimer->stop();
+    emit updateRequested();
+}
+
+void Session::setCaptureWriter(CaptureWriter *writer)
+{
+    QMetaObject::invokeMethod(worker, [this, writer]() {
+        worker->setCaptureWriter(writer);
+    }, Qt::BlockingQueuedConnection);
+}
+
+void Session::startAutoSend(const QByteArray &payload, int interval, int burst)
+{
+    if (!portOpen || payload.isEmpty()) {
+        return;
+    }
+    autoSending = true;
+    autoSendPeriod = interval;
+    autoSendCount = burst;
+    SendScheduler *scheduler = worker->sendScheduler();
+    QMetaObject::invokeMethod(scheduler, [scheduler, payload, interval, burst]() {
+        scheduler->start(payload, interval, burst);
+    }, Qt::QueuedConnection);
+}
+
+void Session::stopAutoSend()
+{
+    autoSending = false;
+    QMetaObject::invokeMethod(worker->sendScheduler(), &SendScheduler::stop, Qt::QueuedConnection);
+}
+
+void Session::setAutoSendPayload(const QByteArray &payload)
+{
+    if (!autoSending) {
+        return;
+    }
+    SendScheduler *scheduler = worker->sendScheduler();
+    QMetaObject::invokeMethod(scheduler, [scheduler, payload]() {
+        scheduler->setPayload(payload);
+    }, Qt::QueuedConnection);
+}
+
+bool Session::isAutoSending() const
+{
+    return autoSending;
+}
+
+int Session::autoSendInterval() const
+{
+    return autoSendPeriod;
+}
+
+int Session::autoSendBurst() const
+{
+    return autoSendCount;
+}
+
+SendScheduler::Stats Session::autoSendStats() const
+{
+    return worker->sendScheduler()->stats();
+}
+
+void Session::sendFile(const QString &fileName)
+{
+    if (!portOpen || sendingFile) {
+        return;
+    }
+    sendingFile = true;
+    fileBytesCleared = 0;
+    FileSender *transfer = worker->fileSender();
+    QMetaObject::invokeMethod(transfer, [transfer, fileName]() {
+        transfer->start(fileName);
+    }, Qt::QueuedConnection);
+}
+
+void Session::cancelFileSend()
+{
+    QMetaObject::invokeMethod(worker->fileSender(), &FileSender::cancel, Qt::QueuedConnection);
+}
+
+bool Session::isSendingFile() const
+{
+    return sendingFile;
+}
+
+FileSender::Progress Session::fileSendProgress() const
+{
+    return worker->fileSender()->progress();
+}
+
+void Session::startReplay(const ReplayOptions &options)
+{
+    if (!portOpen || replaying) {
+        return;
+    }
+    replaying = true;
+    replayBytesCleared = 0;
+    ReplayEngine *replay = worker->replayEngine();
+    QMetaObject::invokeMethod(replay, [replay, options]() {
+        replay->start(options);
+    }, Qt::QueuedConnection);
+}
+
+void Session::stopReplay()
+{
+    QMetaObject::invokeMethod(worker->replayEngine(), &ReplayEngine::stop, Qt::QueuedConnection);
+}
+
+bool Session::isReplaying() const
+{
+    return replaying;
+}
+
+ReplayEngine::Stats Session::replayStats() const
+{
+    return worker->replayEngine()->stats();
+}
+
+void Session::setTriggerRules(const QVector<TriggerRule> &rules)
+{
+    // 旧规则产生、尚未取走的事件按代数忽略
+    triggerRuleList = rules;
+    ++triggerGeneration;
+    TriggerEngine *triggers = worker->triggerEngine();
+    QMetaObject::invokeMethod(triggers, [triggers, rules]() {
+        triggers->setRules(rules);
+    }, Qt::QueuedConnection);
+}
+
+QVector<TriggerRule> Session::triggerRules() const
+{
+    return triggerRuleList;
+}
+
+TriggerEngine::Stats Session::triggerStats() const
+{
+    return worker->triggerEngine()->stats();
+}
+
+void Session::startBridge(const QString &address)
+{
+    if (!portOpen) {
+        return;
+    }
+    PortBridge *bridge = worker->portBridge();
+    QMetaObject::invokeMethod(bridge, [bridge, address]() {
+        bridge->listen(address);
+    }, Qt::QueuedConnection);
+}
+
+void Session::stopBridge()
+{
+    QMetaObject::invokeMethod(worker->portBridge(), &PortBridge::close, Qt::QueuedConnection);
+}
+
+bool Session::isBridging() const
+{
+    return bridging;
+}
+
+QString Session::bridgeAddress() const
+{
+    return bridgeListenAddress;
+}
+
+PortBridge::Status Session::bridgeStatus() const
+{
+    return worker->portBridge()->status();
+}
+
+void Session::open(const SerialConfig &config)
+{
+    // 在I/O线程中打开串口，结果通过 opened/openFailed 返回
+    opening = true;
+    sessionName = config.portName;
+    portConfig = config;
+    QMetaObject::invokeMethod(worker, [this, config]() {
+        worker->openPort(config);
+    }, Qt::QueuedConnection);
+}
+
+void Session::close()
+{
+    // 界面状态在 closed 信号中更新
+    QMetaObject::invokeMethod(worker, &SerialWorker::closePort, Qt::QueuedConnection);
+}
+
+void Session::send(const QByteArray &data)
+{
+    if (!portOpen || data.isEmpty()) {
+        return;
+    }
+    
+    // 写操作交给I/O线程完成，发送计数在 dataWritten 中更新
+    QMetaObject::invokeMethod(worker, [this, data]() {
+        worker->writeData(data);
+    }, Qt::QueuedConnection);
+    
+    // 发送数据也记入接收存储，是否显示由日志模式决定
+    receiveStore->append(TimestampClock::now(), RecordDirection::Tx, data);
+    emit updateRequested();
+}
+
+void Session::readData()
+{
+    readReceived();
+    readTriggerEvents();
+}
+
+void Session::readReceived()
+{
+    // 把环形缓冲区中的原始数据追加到接收存储，由界面每帧统一刷新
+    // 先确认通知，再取数据，保证之后到达的数据会再次触发 rxReady
+    worker->acknowledgeRx();
+    
+    if (framer.config().mode != FramingConfig::None) {
+        readFrames();
+        worker->releaseRx();
+        return;
+    }
+    
+    // 本次只取调用时已有的数据，之后到达的留到下一帧；先取出对应的读取时刻，记录时间为其中第一次读取的时刻
+    SpscRingBuffer *ring = worker->rxBuffer();
+    const qint64 available = ring->size();
+    const quint64 end = ring->readPosition() + static_cast<quint64>(available);
+    qint64 firstRead = -1;
+    qint64 lastRead = -1;
+    RxMark mark;
+    while (worker->rxMarks()->peek(&mark) && mark.position < end) {
+        if (firstRead < 0) {
+            firstRead = mark.timestamp;
+        }
+        lastRead = mark.timestamp;
+        worker->rxMarks()->pop();
+    }
+    if (firstRead < 0) {
+        firstRead = lastRead = TimestampClock::now();
+    }
+    const qint64 carried = receiveCarry.size();
+    const qint64 timestamp = carried > 0 ? receiveCarryTime : firstRead;
+    
+    if (available == 0) {
+        worker->releaseRx();
+        // 没有新数据：未完整的字符等到超时仍未补齐才原样保存
+        if (carried > 0 && carryTimer.hasExpired(CARRY_TIMEOUT_MS)) {
+            receiveStore->append(timestamp, RecordDirection::Rx, receiveCarry);
+            receiveCarry.resize(0);
+        }
+        return;
+    }
+    receiveBytes += available;
+    
+    // 没有遗留字符且数据在环形缓冲区中连续时（绝大多数情况）直接从环形缓冲区存入接收存储；
+    // 否则拼接到复用的暂存区。两种情况都不分配内存
+    qint64 length = 0;
+    const char *data = ring->readRegion(&length);
+    qint64 size = available;
+    qint64 inRing = 0;
+    if (carried == 0 && length >= available) {
+        inRing = available;
+    } else {
+        receiveScratch.resize(0);
+        receiveScratch.append(receiveCarry);
+        qint64 remaining = available;
+        while (remaining > 0 && length > 0) {
+            const qint64 n = qMin(length, remaining);
+            receiveScratch.append(data, n);
+            ring->commitRead(n);
+            remaining -= n;
+            data = ring->readRegion(&length);
+        }
+        receiveCarry.resize(0);
+        data = receiveScratch.constData();
+        size = receiveScratch.size();
+    }
+    
+    // 多字节编码下末尾被截断的字符留到下一块，避免一个字符被拆进两条记录而显示成乱码
+    const qint64 complete = receiveCodec ? receiveCodec->completeLength(data, size) : size;
+    if (complete < size) {
+        receiveCarry.append(data + complete, size - complete);
+        receiveCarryTime = complete > 0 ? lastRead : timestamp;
+        carryTimer.start();
+        carryFlushTimer->start(CARRY_TIMEOUT_MS);
+    }
+    
+    // 保存原始字节和时间，格式化推迟到显示控件绘制可见行时进行
+    if (complete > 0) {
+        receiveStore->append(timestamp, RecordDirection::Rx, data, complete);
+    }
+    if (inRing > 0) {
+        ring->commitRead(inRing);
+    }
+    worker->releaseRx();
+}
+
+void Session::readTriggerEvents()
+{
+    // 只处理匹配位置已经取到接收存储的事件，标记和触发发送的记录因此排在所匹配的数据之后
+    SpscQueue<TriggerEngine::Event> *events = worker->triggerEngine()->events();
+    const quint64 received = worker->rxBuffer()->readPosition();
+    bool appended = false;
+    TriggerEngine::Event event;
+    while (events->peek(&event) && event.position <= received) {
+        events->pop();
+        if (event.generation != triggerGeneration || event.rule < 0 || event.rule >= triggerRuleList.size()) {
+            continue;
+        }
+        const TriggerRule &rule = triggerRuleList.at(event.rule);
+        switch (event.action) {
+        case TriggerRule::Send:
+            // 已由I/O线程发出并计入发送字节数，这里只记入接收存储
+            receiveStore->append(event.timestamp, RecordDirection::Tx, rule.payload);
+            appended = true;
+            break;
+        case TriggerRule::Marker:
+            receiveStore->append(event.timestamp, RecordDirection::Rx, rule.markerText(), RecordMarker);
+            appended = true;
+            break;
+        default:
+            emit triggerFired(event.action);
+            break;
+        }
+    }
+    if (appended) {
+        emit updateRequested();
+    }
+}
+
+void Session::readFrames()
+{
+    // 直接从环形缓冲区分帧，不再拼接整块数据；按读取时刻标记把数据切成段，每段使用自己的读取时刻
+    SpscRingBuffer *ring = worker->rxBuffer();
+    SpscQueue<RxMark> *marks = worker->rxMarks();
+    qint64 length = 0;
+    const char *region = ring->readRegion(&length);
+    while (length > 0) {
+        quint64 position = ring->readPosition();
+        while (length > 0) {
+            RxMark mark;
+            while (marks->peek(&mark) && mark.position <= position) {
+                rxSegmentTime = mark.timestamp;
+                marks->pop();
+            }
+            qint64 n = length;
+            if (marks->peek(&mark) && mark.position < position + length) {
+                n = static_cast<qint64>(mark.position - position);
+            }
+            if (rxSegmentTime == 0) {
+                rxSegmentTime = TimestampClock::now();
+            }
+            framer.feed(region, n, rxSegmentTime);
+            ring->commitRead(n);
+            receiveBytes += n;
+            region += n;
+            length -= n;
+            position += n;
+        }
+        region = ring->readRegion(&length);
+    }
+    
+    // 空闲分帧：最后一帧在数据停止后空闲时间到时输出，不必等下一批数据
+    if (framer.config().mode == FramingConfig::IdleGap && framer.hasPending()
+        && !framer.flushIfIdle(TimestampClock::now())) {
+        const qint64 elapsed = TimestampClock::now() - framer.lastByteTime();
+        const qint64 remaining = static_cast<qint64>(framer.config().idleGapUs) * 1000 - elapsed;
+        frameIdleTimer->start(static_cast<int>(qMax<qint64>(1, (remaining + 999999) / 1000000)));
+    }
+}
+
+void Session::clear()
+{
+    receiveStore->clear();
+    receiveCarry.resize(0);
+    framer.reset();
+    sendBytes = 0;
+    autoSendBytesCleared = worker->sendScheduler()->stats().bytes;
+    worker->stats()->reset();
+    fileBytesCleared = sendingFile ? worker->fileSender()->progress().sent : 0;
+    replayBytesCleared = replaying ? worker->replayEngine()->stats().bytes : 0;
+    triggerBytesCleared = worker->triggerEngine()->stats().bytes;
+    receiveBytes = 0;
+}
+
+void Session::onPortOpened()
+{
+    portOpen = true;
+    opening = false;
+    lastError.clear();
+    emit opened();
+}
+
+void Session::onPortOpenFailed(const QString &errorString)
+{
+    portOpen = false;
+    opening = false;
+    lastError = errorString;
+    emit openFailed(errorString);
+}
+
+void Session::onFileSendFinished(bool ok, const QString &errorString)
+{
+    // 文件已写出的字节数并入发送计数
+    sendBytes += worker->fileSender()->progress().sent - fileBytesCleared;
+    fileBytesCleared = 0;
+    sendingFile = false;
+    emit fileSendFinished(ok, errorString);
+    emit updateRequested();
+}
+
+void Session::onReplayFinished(bool ok, const QString &errorString)
+{
+    // 回放已写出的字节数并入发送计数
+    sendBytes += worker->replayEngine()->stats().bytes - replayBytesCleared;
+    replayBytesCleared = 0;
+    replaying = false;
+    emit replayFinished(ok, errorString);
+    emit updateRequested();
+}
+
+void Session::onPortClosed()
+{
+    portOpen = false;
+    opening = false;
+    // I/O线程在关闭串口前已停止自动发送
+    autoSending = false;
+    
+    // 取走剩余数据，未凑齐的帧原样保存
+    readData();
+    framer.flush();
+    emit closed();
+    emit updateRequested();
+}
\ No newline at end of file
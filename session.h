@@ -0,0 +1,150 @@
+#ifndef SESSION_H
+#define SESSION_H
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QThread>
+#include <QTimer>
+
+#include "chunkstore.h"
+#include "framer.h"
+#include "serialworker.h"
+
+class CaptureWriter;
+class SessionCodec;
+
+// 一个串口会话
+// 包含一个串口的全部状态：独立的I/O线程和串口工作对象、接收存储、分帧状态、收发计数和自动发送调度器。
+// 多个会话各用各的I/O线程同时收发，互不阻塞；界面上的串口参数、编码和分帧方式由 MainWindow 传入。
+class Session : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit Session(QObject *parent = nullptr);
+    ~Session();
+    
+    ChunkStore *store() const;
+    // 会话名称，串口打开后为端口名
+    QString name() const;
+    void setName(const QString &name);
+    bool isOpen() const;
+    // 正在打开串口，结果尚未返回
+    bool isOpening() const;
+    QString errorString() const;
+    qint64 sentBytes() const;
+    qint64 receivedBytes() const;
+    // 最近一次打开串口使用的参数
+    SerialConfig config() const;
+    LinkStats *stats() const;
+    
+    // 接收编码只用于判断多字节字符是否被截断，由调用者持有
+    void setReceiveCodec(const SessionCodec *codec);
+    void setFramingConfig(const FramingConfig &config);
+    // 在I/O线程中切换录制文件，返回时I/O线程已不再使用旧的写入器
+    void setCaptureWriter(CaptureWriter *writer);
+    
+    // 自动发送在I/O线程中进行，payload 为编码好的数据；interval 为0时连续发送
+    void startAutoSend(const QByteArray &payload, int interval, int burst);
+    void stopAutoSend();
+    // 发送内容改变时只替换数据，发送节奏不变
+    void setAutoSendPayload(const QByteArray &payload);
+    bool isAutoSending() const;
+    int autoSendInterval() const;
+    int autoSendBurst() const;
+    SendScheduler::Stats autoSendStats() const;
+    
+    // 在I/O线程中按块发送文件，结束时发出 fileSendFinished
+    void sendFile(const QString &fileName);
+    void cancelFileSend();
+    bool isSendingFile() const;
+    FileSender::Progress fileSendProgress() const;
+    
+    // 在I/O线程中按录制时的时间间隔回放录制文件，结束时发出 replayFinished
+    void startReplay(const ReplayOptions &options);
+    void stopReplay();
+    bool isReplaying() const;
+    ReplayEngine::Stats replayStats() const;
+    
+    // 在I/O线程中匹配接收数据并执行触发动作，rules 为空时停用
+    void setTriggerRules(const QVector<TriggerRule> &rules);
+    QVector<TriggerRule> triggerRules() const;
+    TriggerEngine::Stats triggerStats() const;
+    
+    // 在I/O线程中把串口桥接到本机套接字，结果通过 bridgeChanged/bridgeFailed 返回
+    void startBridge(const QString &address);
+    void stopBridge();
+    bool isBridging() const;
+    // 实际监听的地址，端口为0时为系统分配的端口
+    QString bridgeAddress() const;
+    PortBridge::Status bridgeStatus() const;
+    
+    void open(const SerialConfig &config);
+    void close();
+    // 交给I/O线程发送，同时记入接收存储
+    void send(const QByteArray &data);
+    // 把I/O线程收到的数据取到接收存储，每个显示帧调用一次
+    void readData();
+    void clear();
+
+signals:
+    void opened();
+    void openFailed(const QString &errorString);
+    void closed();
+    // 有新数据或计数变化，需要刷新显示
+    void updateRequested();
+    void fileSendFinished(bool ok, const QString &errorString);
+    void replayFinished(bool ok, const QString &errorString);
+    // 桥接开始、停止或客户端数变化
+    void bridgeChanged();
+    void bridgeFailed(const QString &errorString);
+    // 需要界面执行的触发动作（开始/停止录制、暂停显示），在取走对应数据的那一帧发出
+    void triggerFired(TriggerRule::Action action);
+
+private:
+    void readReceived();
+    void readFrames();
+    void readTriggerEvents();
+    void onPortOpened();
+    void onPortOpenFailed(const QString &errorString);
+    void onPortClosed();
+    void onFileSendFinished(bool ok, const QString &errorString);
+    void onReplayFinished(bool ok, const QString &errorString);
+    
+    QThread *ioThread;
+    SerialWorker *worker;
+    ChunkStore *receiveStore;
+    const SessionCodec *receiveCodec;
+    QString sessionName;
+    QString lastError;
+    SerialConfig portConfig;
+    bool portOpen;
+    bool opening;
+    QByteArray receiveCarry;    // 上一块末尾未完整的多字节字符
+    qint64 receiveCarryTime;
+    QElapsedTimer carryTimer;
+    QTimer *carryFlushTimer;    // 未完整的字符超时后再取一次数据，把它原样保存
+    QByteArray receiveScratch;  // 遗留字符或环形缓冲区回绕时拼接数据用，容量保留复用
+    Framer framer;              // 接收数据分帧，每帧一条记录
+    Checksum frameChecksum;     // 逐帧校验，不分帧时为 None
+    int checksumTrailer;        // 帧末尾保留的分隔符长度，校验值在它之前
+    qint64 rxSegmentTime;       // 当前数据段的读取时刻
+    QTimer *frameIdleTimer;     // 空闲分帧时，最后一帧在空闲时间到后输出
+    bool autoSending;
+    int autoSendPeriod;
+    int autoSendCount;
+    qint64 autoSendBytesCleared;    // 清空计数时调度器已发送的字节数
+    bool sendingFile;
+    qint64 fileBytesCleared;        // 清空计数时正在发送的文件已发送的字节数
+    bool replaying;
+    qint64 replayBytesCleared;      // 清空计数时正在进行的回放已发送的字节数
+    bool bridging;
+    QString bridgeListenAddress;
+    QVector<TriggerRule> triggerRuleList;   // 与I/O线程中的规则相同，用于解释触发事件
+    int triggerGeneration;                  // 与 TriggerEngine 的规则代数同步递增
+    qint64 triggerBytesCleared;             // 清空计数时触发器已发送的字节数
+    qint64 sendBytes;
+    qint64 receiveBytes;
+};
+
+#endif // SESSION_H
\ No newline at end of file
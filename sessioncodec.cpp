@@ -0,0 +1,314 @@
+#include "sessioncodec.h"
+#include "recordsource.h"
+#include <QSysInfo>
+#include <QtCore5Compat/QTextCodec>
+
+// QTextCodec 的 MIB 编号
+static const int MIB_ASCII = 3;
+static const int MIB_LATIN1 = 4;
+static const int MIB_UTF8 = 106;
+
+static inline bool inRange(uchar byte, uchar low, uchar high)
+{
+    return byte >= low && byte <= high;
+}
+
+// 编码为 ASCII：纯 7 位文本直接截成字节；其余字符与 QTextCodec 一样每个码点替换为 '?'，
+// 不能用 toLatin1()，否则 0x80-0xFF 的字符会变成 Latin-1 字节
+static QByteArray toAscii(const QString &text)
+{
+    const char16_t *p = reinterpret_cast<const char16_t *>(text.constData());
+    const qsizetype length = text.size();
+    char16_t bits = 0;
+    for (qsizetype i = 0; i < length; ++i) {
+        bits |= p[i];
+    }
+    if (bits < 0x80) {
+        return text.toLatin1();
+    }
+    QByteArray out;
+    out.reserve(length);
+    for (qsizetype i = 0; i < length; ++i) {
+        if (p[i] < 0x80) {
+            out.append(static_cast<char>(p[i]));
+            continue;
+        }
+        out.append('?');
+        if (QChar::isHighSurrogate(p[i]) && i + 1 < length && QChar::isLowSurrogate(p[i + 1])) {
+            ++i;
+        }
+    }
+    return out;
+}
+
+// 按 ASCII 解码：0x80 以上的字节不是 ASCII 字符，显示为替换字符而不是 Latin-1 字符
+static QString fromAscii(const char *data, qint64 length)
+{
+    const uchar *bytes = reinterpret_cast<const uchar *>(data);
+    uchar bits = 0;
+    for (qint64 i = 0; i < length; ++i) {
+        bits |= bytes[i];
+    }
+    if (bits < 0x80) {
+        return QString::fromLatin1(data, length);
+    }
+    QString out(static_cast<qsizetype>(length), Qt::Uninitialized);
+    char16_t *p = reinterpret_cast<char16_t *>(out.data());
+    for (qint64 i = 0; i < length; ++i) {
+        p[i] = bytes[i] < 0x80 ? bytes[i] : char16_t(QChar::ReplacementCharacter);
+    }
+    return out;
+}
+
+SessionCodec::SessionCodec(const QString &name)
+    : kind(Kind::Utf8)
+    , boundary(Boundary::Utf8)
+    , codec(nullptr)
+{
+    setName(name);
+}
+
+SessionCodec::~SessionCodec()
+{
+}
+
+void SessionCodec::setName(const QString &name)
+{
+    if (name == codecName && !codecName.isEmpty()) {
+        return;
+    }
+    
+    codecName = name;
+    codec = QTextCodec::codecForName(name.toUtf8());
+    decoder.reset();
+    encoder.reset();
+    pending.clear();
+    
+    const int mib = codec ? codec->mibEnum() : 0;
+    const QString upper = name.toUpper();
+    if (!codec || mib == MIB_UTF8) {
+        // 找不到的编码按 UTF-8 处理
+        kind = Kind::Utf8;
+        boundary = Boundary::Utf8;
+        return;
+    }
+    if (mib == MIB_LATIN1) {
+        kind = Kind::Latin1;
+        boundary = Boundary::None;
+        return;
+    }
+    if (mib == MIB_ASCII || upper == "ASCII" || upper == "US-ASCII") {
+        kind = Kind::Ascii;
+        boundary = Boundary::None;
+        return;
+    }
+    
+    kind = Kind::Generic;
+    decoder.reset(codec->makeDecoder());
+    encoder.reset(codec->makeEncoder());
+    
+    const QString canonical = QString::fromLatin1(codec->name()).toUpper();
+    if (canonical.startsWith("GB")) {
+        boundary = Boundary::Gb18030;
+    } else if (canonical.startsWith("UTF-16")) {
+        boundary = canonical == "UTF-16LE" ? Boundary::Utf16Le : canonical == "UTF-16BE" ? Boundary::Utf16Be : Boundary::Utf16;
+    } else if (canonical.startsWith("UTF-32")) {
+        boundary = Boundary::Utf32;
+    } else if (canonical.contains("SHIFT_JIS") || canonical.contains("SJIS") || canonical == "WINDOWS-31J") {
+        boundary = Boundary::ShiftJis;
+    } else if (canonical == "EUC-JP") {
+        boundary = Boundary::EucJp;
+    } else if (canonical.startsWith("BIG5") || canonical == "EUC-KR" || canonical.contains("949")
+               || canonical.contains("936") || canonical.contains("950")) {
+        boundary = Boundary::DoubleByte;
+    } else if (canonical.startsWith("ISO-2022") || canonical.startsWith("UTF-7") || canonical.startsWith("HZ")) {
+        boundary = Boundary::Unknown;
+    } else {
+        boundary = Boundary::None;
+    }
+}
+
+QString SessionCodec::name() const
+{
+    return codecName;
+}
+
+bool SessionCodec::isMultiByte() const
+{
+    return boundary != Boundary::None;
+}
+
+bool SessionCodec::hasByteNewline() const
+{
+    return boundary != Boundary::Utf16 && boundary != Boundary::Utf16Le && boundary != Boundary::Utf16Be
+        && boundary != Boundary::Utf32;
+}
+
+int SessionCodec::countLineBreaks(const char *data, qint64 length) const
+{
+    if (hasByteNewline()) {
+        return static_cast<int>(::countLineBreaks(data, length));
+    }
+    // UTF-16/32 中 0x0A 字节可能只是字符的一部分，字节序又取决于字节序标记，解码后再数
+    const QString text = toUnicode(data, length);
+    int count = static_cast<int>(text.count(QLatin1Char('\n')));
+    if (text.endsWith(QLatin1Char('\n'))) {
+        --count;
+    }
+    return count;
+}
+
+QString SessionCodec::decode(const char *data, qint64 length)
+{
+    switch (kind) {
+    case Kind::Utf8: {
+        if (pending.isEmpty()) {
+            const qint64 complete = completeLength(data, length);
+            pending.append(data + complete, length - complete);
+            return QString::fromUtf8(data, complete);
+        }
+        QByteArray joined = pending + QByteArray::fromRawData(data, length);
+        const qint64 complete = completeLength(joined.constData(), joined.size());
+        pending = joined.mid(complete);
+        return QString::fromUtf8(joined.constData(), complete);
+    }
+    case Kind::Latin1:
+        return QString::fromLatin1(data, length);
+    case Kind::Ascii:
+        return fromAscii(data, length);
+    case Kind::Generic:
+        break;
+    }
+    return decoder->toUnicode(data, static_cast<int>(length));
+}
+
+QString SessionCodec::toUnicode(const char *data, qint64 length) const
+{
+    switch (kind) {
+    case Kind::Utf8:
+        return QString::fromUtf8(data, length);
+    case Kind::Latin1:
+        return QString::fromLatin1(data, length);
+    case Kind::Ascii:
+        return fromAscii(data, length);
+    case Kind::Generic:
+        break;
+    }
+    return codec->toUnicode(data, static_cast<int>(length));
+}
+
+QByteArray SessionCodec::encode(const QString &text)
+{
+    switch (kind) {
+    case Kind::Utf8:
+        return text.toUtf8();
+    case Kind::Latin1:
+        return text.toLatin1();
+    case Kind::Ascii:
+        return toAscii(text);
+    case Kind::Generic:
+        break;
+    }
+    return encoder->fromUnicode(text);
+}
+
+qint64 SessionCodec::completeLength(const char *data, qint64 length) const
+{
+    const uchar *bytes = reinterpret_cast<const uchar *>(data);
+    
+    switch (boundary) {
+    case Boundary::None:
+    case Boundary::Unknown:
+        return length;
+    case Boundary::Utf8: {
+        // 从末尾向前找最后一个首字节，检查它需要的字节是否都已到齐
+        for (qint64 i = length - 1; i >= 0 && i >= length - 4; --i) {
+            const uchar byte = bytes[i];
+            if ((byte & 0xC0) == 0x80) {
+                continue;
+            }
+            int need = 1;
+            if (byte >= 0xF0) {
+                need = 4;
+            } else if (byte >= 0xE0) {
+                need = 3;
+            } else if (byte >= 0xC0) {
+                need = 2;
+            }
+            return i + need > length ? i : length;
+        }
+        return length;
+    }
+    case Boundary::Utf16:
+    case Boundary::Utf16Le:
+    case Boundary::Utf16Be: {
+        // 按 2 字节对齐；最后一个单元是高代理项时，与之配对的低代理项还没到，一起留到下一块
+        const qint64 even = length & ~qint64(1);
+        if (even < 2) {
+            return even;
+        }
+        bool bigEndian = boundary == Boundary::Utf16Be;
+        if (boundary == Boundary::Utf16) {
+            bigEndian = QSysInfo::ByteOrder == QSysInfo::BigEndian;
+            if (bytes[0] == 0xFE && bytes[1] == 0xFF) {
+                bigEndian = true;
+            } else if (bytes[0] == 0xFF && bytes[1] == 0xFE) {
+                bigEndian = false;
+            }
+        }
+        const uchar high = bigEndian ? bytes[even - 2] : bytes[even - 1];
+        return (high & 0xFC) == 0xD8 ? even - 2 : even;
+    }
+    case Boundary::Utf32:
+        return length & ~qint64(3);
+    default:
+        break;
+    }
+    
+    // 双字节类编码的后续字节都不小于 0x30，因此小于 0x30 的字节（换行、空格等）
+    // 一定是字符边界，只需从最后一个这样的字节之后向前扫描
+    qint64 i = length;
+    while (i > 0 && bytes[i - 1] >= 0x30) {
+        --i;
+    }
+    while (i < length) {
+        const uchar byte = bytes[i];
+        int need = 1;
+        switch (boundary) {
+        case Boundary::Gb18030:
+            if (inRange(byte, 0x81, 0xFE)) {
+                // 第二字节为数字的是 GB18030 四字节字符
+                need = (i + 1 < length && inRange(bytes[i + 1], 0x30, 0x39)) ? 4 : 2;
+            }
+            break;
+        case Boundary::DoubleByte:
+            need = inRange(byte, 0x81, 0xFE) ? 2 : 1;
+            break;
+        case Boundary::ShiftJis:
+            need = (inRange(byte, 0x81, 0x9F) || inRange(byte, 0xE0, 0xFC)) ? 2 : 1;
+            break;
+        case Boundary::EucJp:
+            if (byte == 0x8F) {
+                need = 3;
+            } else if (byte == 0x8E || inRange(byte, 0xA1, 0xFE)) {
+                need = 2;
+            }
+            break;
+        default:
+            break;
+        }
+        if (i + need > length) {
+            return i;
+        }
+        i += need;
+    }
+    return length;
+}
+
+void SessionCodec::reset()
+{
+    pending.clear();
+    if (kind == Kind::Generic) {
+        decoder.reset(codec->makeDecoder());
+    }
+}
\ No newline at end of file
@@ -0,0 +1,85 @@
+#ifndef SESSIONCODEC_H
+#define SESSIONCODEC_H
+
+#include <QByteArray>
+#include <QString>
+#include <memory>
+
+class QTextCodec;
+class QTextDecoder;
+class QTextEncoder;
+
+// 一个会话使用的文本编码
+// 按名称查找编码只在 setName 时进行一次，之后的编解码直接使用缓存的编码对象。
+// UTF-8、ASCII、Latin-1 走 Qt 自带的快速转换，不经过 QTextCodec；ASCII 中 0x80 以上的字节显示为替换字符。
+// 其余编码保留持久的 QTextDecoder/QTextEncoder，跨数据块的多字节字符可以正确拼接。
+class SessionCodec
+{
+public:
+    explicit SessionCodec(const QString &name = QStringLiteral("UTF-8"));
+    ~SessionCodec();
+    
+    SessionCodec(const SessionCodec &) = delete;
+    SessionCodec &operator=(const SessionCodec &) = delete;
+    
+    // 切换编码，重建编解码器并清除未完成的字符状态；名称不变时什么也不做
+    void setName(const QString &name);
+    QString name() const;
+    // 是否为一个字符可能占多个字节的编码
+    bool isMultiByte() const;
+    // 换行是否就是单个 0x0A 字节（UTF-16/32 以外的编码），是则可以直接使用按字节统计的换行数
+    bool hasByteNewline() const;
+    // 按本编码统计一段完整数据中的换行数（不计末尾的换行），与解码后按 '\n' 拆行的结果一致
+    int countLineBreaks(const char *data, qint64 length) const;
+    int countLineBreaks(const QByteArray &data) const { return countLineBreaks(data.constData(), data.size()); }
+    
+    // 流式解码：上一块末尾不完整的字符与本块开头拼接
+    QString decode(const char *data, qint64 length);
+    QString decode(const QByteArray &data) { return decode(data.constData(), data.size()); }
+    // 解码一段完整的数据，不使用也不改变流式状态
+    QString toUnicode(const char *data, qint64 length) const;
+    QString toUnicode(const QByteArray &data) const { return toUnicode(data.constData(), data.size()); }
+    // 编码发送文本，多次发送之间不重复输出字节序标记
+    QByteArray encode(const QString &text);
+    
+    // data 中以完整字符结尾的最长前缀长度，剩余字节是被截断的多字节字符的开头
+    qint64 completeLength(const char *data, qint64 length) const;
+    
+    // 清除流式解码状态
+    void reset();
+
+private:
+    enum class Kind
+    {
+        Utf8,
+        Latin1,
+        Ascii,
+        Generic
+    };
+    
+    // 多字节编码的字符边界规则
+    enum class Boundary
+    {
+        None,           // 单字节编码
+        Utf8,
+        Gb18030,        // GB18030/GBK/GB2312：双字节及 GB18030 四字节
+        DoubleByte,     // Big5/EUC-KR 等：0x81-0xFE 开头的双字节
+        ShiftJis,
+        EucJp,
+        Utf16,          // 按字节序标记，没有时按本机字节序
+        Utf16Le,
+        Utf16Be,
+        Utf32,
+        Unknown         // 未知的多字节编码，不做截断判断
+    };
+    
+    QString codecName;
+    Kind kind;
+    Boundary boundary;
+    QTextCodec *codec;
+    std::unique_ptr<QTextDecoder> decoder;
+    std::unique_ptr<QTextEncoder> encoder;
+    QByteArray pending;     // 快速路径下上一块末尾未完整的 UTF-8 字节
+};
+
+#endif // SESSIONCODEC_H
\ No newline at end of file
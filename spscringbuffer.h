@@ -0,0 +1,186 @@
+#ifndef SPSCRINGBUFFER_H
+#define SPSCRINGBUFFER_H
+
+#include <QtGlobal>
+#include <atomic>
+#include <cstring>
+#include <memory>
+
+// 单生产者/单消费者无锁字节环形缓冲区
+// I/O线程是唯一的生产者，GUI线程是唯一的消费者，两端都不需要加锁。
+// head/tail 使用单调递增的64位计数，取模由容量掩码完成，因此容量必须是2的幂。
+class SpscRingBuffer
+{
+public:
+    explicit SpscRingBuffer(qint64 capacity)
+    {
+        qint64 size = 1;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        buffer.reset(new char[size]);
+        mask = size - 1;
+    }
+    
+    SpscRingBuffer(const SpscRingBuffer &) = delete;
+    SpscRingBuffer &operator=(const SpscRingBuffer &) = delete;
+    
+    qint64 capacity() const { return mask + 1; }
+    
+    // 当前可读字节数（任意一端调用都只是一个快照）
+    qint64 size() const
+    {
+        return static_cast<qint64>(head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire));
+    }
+    
+    qint64 freeSpace() const { return capacity() - size(); }
+    
+    // 累计写入/读出的字节数，可用作数据在整个流中的位置
+    quint64 writePosition() const { return head.load(std::memory_order_acquire); }
+    quint64 readPosition() const { return tail.load(std::memory_order_acquire); }
+    
+    // ---- 生产者接口 ----
+    
+    // 返回一段连续的可写区域，长度通过 length 返回；缓冲区已满时 length 为0
+    char *writeRegion(qint64 *length)
+    {
+        const quint64 h = head.load(std::memory_order_relaxed);
+        const quint64 t = tail.load(std::memory_order_acquire);
+        const qint64 free = capacity() - static_cast<qint64>(h - t);
+        const qint64 index = static_cast<qint64>(h & static_cast<quint64>(mask));
+        *length = qMin(free, capacity() - index);
+        return buffer.get() + index;
+    }
+    
+    // 提交 writeRegion 中实际写入的字节数，数据对消费者可见
+    void commitWrite(qint64 length)
+    {
+        head.store(head.load(std::memory_order_relaxed) + static_cast<quint64>(length), std::memory_order_release);
+    }
+    
+    // 尽可能多地写入数据，返回实际写入的字节数
+    qint64 write(const char *data, qint64 length)
+    {
+        qint64 written = 0;
+        while (written < length) {
+            qint64 region = 0;
+            char *dest = writeRegion(&region);
+            if (region == 0) {
+                break;
+            }
+            const qint64 n = qMin(region, length - written);
+            std::memcpy(dest, data + written, static_cast<size_t>(n));
+            commitWrite(n);
+            written += n;
+        }
+        return written;
+    }
+    
+    // ---- 消费者接口 ----
+    
+    // 返回一段连续的可读区域，长度通过 length 返回；缓冲区为空时 length 为0
+    const char *readRegion(qint64 *length) const
+    {
+        const quint64 t = tail.load(std::memory_order_relaxed);
+        const quint64 h = head.load(std::memory_order_acquire);
+        const qint64 available = static_cast<qint64>(h - t);
+        const qint64 index = static_cast<qint64>(t & static_cast<quint64>(mask));
+        *length = qMin(available, capacity() - index);
+        return buffer.get() + index;
+    }
+    
+    // 释放 readRegion 中已经处理完的字节，空间归还给生产者
+    void commitRead(qint64 length)
+    {
+        tail.store(tail.load(std::memory_order_relaxed) + static_cast<quint64>(length), std::memory_order_release);
+    }
+    
+    // 尽可能多地读出数据，返回实际读取的字节数
+    qint64 read(char *data, qint64 length)
+    {
+        qint64 readBytes = 0;
+        while (readBytes < length) {
+            qint64 region = 0;
+            const char *src = readRegion(&region);
+            if (region == 0) {
+                break;
+            }
+            const qint64 n = qMin(region, length - readBytes);
+            std::memcpy(data + readBytes, src, static_cast<size_t>(n));
+            commitRead(n);
+            readBytes += n;
+        }
+        return readBytes;
+    }
+
+private:
+    std::unique_ptr<char[]> buffer;
+    qint64 mask = 0;
+    // 生产者和消费者各自的计数放在不同的缓存行，避免伪共享
+    alignas(64) std::atomic<quint64> head{0};
+    alignas(64) std::atomic<quint64> tail{0};
+};
+
+// 单生产者/单消费者无锁定长队列，用于随字节流传递少量附加信息（如读取时刻）
+// 与 SpscRingBuffer 相同，容量向上取整为2的幂。
+template <typename T>
+class SpscQueue
+{
+public:
+    explicit SpscQueue(qint64 capacity)
+    {
+        qint64 size = 1;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        items.reset(new T[size]);
+        mask = size - 1;
+    }
+    
+    SpscQueue(const SpscQueue &) = delete;
+    SpscQueue &operator=(const SpscQueue &) = delete;
+    
+    qint64 capacity() const { return mask + 1; }
+    
+    bool isEmpty() const
+    {
+        return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+    }
+    
+    // 生产者调用；队列已满时返回 false
+    bool push(const T &item)
+    {
+        const quint64 h = head.load(std::memory_order_relaxed);
+        if (static_cast<qint64>(h - tail.load(std::memory_order_acquire)) >= capacity()) {
+            return false;
+        }
+        items[h & static_cast<quint64>(mask)] = item;
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+    
+    // 消费者调用：查看队首元素而不取出；队列为空时返回 false
+    bool peek(T *item) const
+    {
+        const quint64 t = tail.load(std::memory_order_relaxed);
+        if (t == head.load(std::memory_order_acquire)) {
+            return false;
+        }
+        *item = items[t & static_cast<quint64>(mask)];
+        return true;
+    }
+    
+    // 消费者调用：丢弃队首元素
+    void pop()
+    {
+        tail.store(tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+private:
+    std::unique_ptr<T[]> items;
+    qint64 mask = 0;
+    alignas(64) std::atomic<quint64> head{0};
+    alignas(64) std::atomic<quint64> tail{0};
+};
+
+#endif // SPSCRINGBUFFER_H
\ No newline at end of file
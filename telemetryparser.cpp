@@ -0,0 +1,224 @@
+#include "telemetryparser.h"
+#include <cmath>
+#include <cstring>
+
+static inline bool isSeparator(char c)
+{
+    return c == ',' || c == ';' || c == ' ' || c == '\t';
+}
+
+static inline bool isDigit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+TelemetryParser::TelemetryParser()
+    : used(0)
+    , overflow(false)
+    , lines(0)
+{
+}
+
+void TelemetryParser::setSampleHandler(const SampleHandler &value)
+{
+    handler = value;
+}
+
+void TelemetryParser::feed(const char *data, qint64 length)
+{
+    const char *end = data + length;
+    while (data < end) {
+        const char *newline = static_cast<const char *>(std::memchr(data, '\n', end - data));
+        const char *stop = newline ? newline : end;
+        const qint64 n = stop - data;
+        if (!overflow) {
+            if (used == 0 && newline) {
+                // 整行都在本块中：直接在输入数据上解析，不经过行缓冲区
+                parseLine(data, stop);
+            } else if (used + n <= MAX_LINE) {
+                std::memcpy(line + used, data, static_cast<size_t>(n));
+                used += static_cast<int>(n);
+                if (newline) {
+                    parseLine(line, line + used);
+                }
+            } else {
+                overflow = true;
+            }
+        }
+        if (newline) {
+            used = 0;
+            overflow = false;
+            data = newline + 1;
+        } else {
+            data = end;
+        }
+    }
+}
+
+void TelemetryParser::reset()
+{
+    used = 0;
+    overflow = false;
+    names.clear();
+    lines = 0;
+}
+
+int TelemetryParser::channelCount() const
+{
+    return names.size();
+}
+
+QString TelemetryParser::channelName(int channel) const
+{
+    return QString::fromUtf8(names.value(channel));
+}
+
+qint64 TelemetryParser::lineCount() const
+{
+    return lines;
+}
+
+const char *TelemetryParser::parseNumber(const char *p, const char *end, double *value)
+{
+    bool negative = false;
+    if (p < end && (*p == '+' || *p == '-')) {
+        negative = *p == '-';
+        ++p;
+    }
+    
+    // 有效数字先按整数累计，最后一次性乘以10的幂
+    quint64 mantissa = 0;
+    int exponent = 0;
+    int digits = 0;
+    for (; p < end && isDigit(*p); ++p, ++digits) {
+        if (mantissa < 100000000000000000ull) {
+            mantissa = mantissa * 10 + static_cast<quint64>(*p - '0');
+        } else {
+            ++exponent;
+        }
+    }
+    if (p < end && *p == '.') {
+        for (++p; p < end && isDigit(*p); ++p, ++digits) {
+            if (mantissa < 100000000000000000ull) {
+                mantissa = mantissa * 10 + static_cast<quint64>(*p - '0');
+                --exponent;
+            }
+        }
+    }
+    if (digits == 0) {
+        return nullptr;
+    }
+    
+    // 指数部分不完整时（如 "2e"）只取前面的数值
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        const char *q = p + 1;
+        bool negativeExponent = false;
+        if (q < end && (*q == '+' || *q == '-')) {
+            negativeExponent = *q == '-';
+            ++q;
+        }
+        if (q < end && isDigit(*q)) {
+            int e = 0;
+            for (; q < end && isDigit(*q); ++q) {
+                if (e < 10000) {
+                    e = e * 10 + (*q - '0');
+                }
+            }
+            exponent += negativeExponent ? -e : e;
+            p = q;
+        }
+    }
+    
+    // 负指数用除法，常见的短小数（如 25.3）能得到与 strtod 相同的结果
+    double result = static_cast<double>(mantissa);
+    if (exponent > 0) {
+        result *= std::pow(10.0, exponent);
+    } else if (exponent < 0) {
+        result /= std::pow(10.0, -exponent);
+    }
+    *value = negative ? -result : result;
+    return p;
+}
+
+void TelemetryParser::parseLine(const char *begin, const char *end)
+{
+    if (end > begin && end[-1] == '\r') {
+        --end;
+    }
+    
+    bool sampled = false;
+    int column = 0;
+    const char *p = begin;
+    while (p < end) {
+        while (p < end && isSeparator(*p)) {
+            ++p;
+        }
+        const char *token = p;
+        while (p < end && !isSeparator(*p)) {
+            ++p;
+        }
+        if (token == p) {
+            break;
+        }
+        
+        // 名字与数值之间用 = 或 :，没有名字的字段按列位置编号（不是数值的列也占位置）
+        const char *valueStart = token;
+        const char *nameEnd = nullptr;
+        for (const char *q = token + 1; q < p; ++q) {
+            if (*q == '=' || *q == ':') {
+                nameEnd = q;
+                valueStart = q + 1;
+                break;
+            }
+        }
+        if (!nameEnd) {
+            ++column;
+        }
+        double value = 0;
+        if (!parseNumber(valueStart, p, &value)) {
+            continue;
+        }
+        
+        int channel = -1;
+        if (nameEnd) {
+            channel = channelFor(token, static_cast<int>(nameEnd - token));
+        } else {
+            char name[16];
+            int length = 0;
+            int number = column;
+            char digits[16];
+            int count = 0;
+            do {
+                digits[count++] = static_cast<char>('0' + number % 10);
+                number /= 10;
+            } while (number > 0);
+            while (count > 0) {
+                name[length++] = digits[--count];
+            }
+            channel = channelFor(name, length);
+        }
+        if (channel >= 0 && handler) {
+            handler(channel, lines, value);
+        }
+        sampled = true;
+    }
+    if (sampled) {
+        ++lines;
+    }
+}
+
+int TelemetryParser::channelFor(const char *name, int length)
+{
+    for (int i = 0; i < names.size(); ++i) {
+        const QByteArray &known = names.at(i);
+        if (known.size() == length && std::memcmp(known.constData(), name, static_cast<size_t>(length)) == 0) {
+            return i;
+        }
+    }
+    // 通道数有上限，避免把非遥测数据解析出大量通道
+    if (names.size() >= MAX_CHANNELS) {
+        return -1;
+    }
+    names.append(QByteArray(name, length));
+    return names.size() - 1;
+}
\ No newline at end of file
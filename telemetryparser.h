@@ -0,0 +1,53 @@
+#ifndef TELEMETRYPARSER_H
+#define TELEMETRYPARSER_H
+
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+#include <functional>
+
+// 数值遥测的增量解析器
+// 按行解析接收数据，一行是一组采样，行内以逗号、分号、空格或制表符分隔：
+//   25.3,40.1,1013          纯数值按列位置编为通道 "1"、"2"、"3"
+//   T=25.3 H=40.1 P:1013    带名字的值按名字编为通道，= 和 : 都可以作分隔
+// 数值后面的单位（如 25.3C）被忽略，不是数值的字段跳过。数据可以在任意位置被切开，
+// 行缓冲区长度固定，解析过程不分配内存，只有第一次出现的通道名会分配一次。
+class TelemetryParser
+{
+public:
+    static const int MAX_CHANNELS = 16;
+    static const int MAX_LINE = 1024;      // 超过该长度的行被丢弃
+    
+    // 采样回调：通道号、行号（含有数值的行从0开始计数）、数值
+    using SampleHandler = std::function<void(int channel, qint64 line, double value)>;
+    
+    TelemetryParser();
+    
+    void setSampleHandler(const SampleHandler &handler);
+    
+    void feed(const char *data, qint64 length);
+    // 丢弃未完成的行、通道和行号
+    void reset();
+    
+    int channelCount() const;
+    QString channelName(int channel) const;
+    // 已解析出数值的行数，也是下一行的行号
+    qint64 lineCount() const;
+    
+    // 从 [p, end) 开头解析一个十进制数（可带符号、小数和指数），不受本地化设置影响；
+    // 成功时返回数值之后的位置，否则返回空指针
+    static const char *parseNumber(const char *p, const char *end, double *value);
+
+private:
+    void parseLine(const char *begin, const char *end);
+    int channelFor(const char *name, int length);
+    
+    SampleHandler handler;
+    char line[MAX_LINE];
+    int used;
+    bool overflow;              // 当前行超长，丢弃到行尾
+    QVector<QByteArray> names;
+    qint64 lines;
+};
+
+#endif // TELEMETRYPARSER_H
\ No newline at end of file
@@ -0,0 +1,111 @@
+#include "timestamp.h"
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <algorithm>
+
+static const qint64 NS_PER_US = 1000;
+static const qint64 NS_PER_MS = 1000 * 1000;
+static const qint64 NS_PER_SECOND = 1000 * 1000 * 1000;
+static const qint64 NS_PER_HOUR = 3600 * NS_PER_SECOND;
+
+namespace {
+// 单调时钟与系统时间的对齐点，第一次取时间时建立
+struct ClockBase
+{
+    ClockBase()
+        : epoch(QDateTime::currentMSecsSinceEpoch() * NS_PER_MS)
+    {
+        timer.start();
+    }
+    
+    QElapsedTimer timer;
+    qint64 epoch;
+};
+}
+
+qint64 TimestampClock::now()
+{
+    static const ClockBase base;
+    return base.epoch + base.timer.nsecsElapsed();
+}
+
+// 写入固定位数的十进制数字
+static inline char16_t *writeDigits(char16_t *out, qint64 value, int digits)
+{
+    for (int i = digits - 1; i >= 0; --i) {
+        out[i] = static_cast<char16_t>(u'0' + value % 10);
+        value /= 10;
+    }
+    return out + digits;
+}
+
+TimestampFormatter::TimestampFormatter(Precision precision)
+    : prec(precision)
+    , hourStart(0)
+    , hourEnd(0)
+{
+}
+
+void TimestampFormatter::setPrecision(Precision precision)
+{
+    prec = precision;
+}
+
+TimestampFormatter::Precision TimestampFormatter::precision() const
+{
+    return prec;
+}
+
+QString TimestampFormatter::format(qint64 timestamp)
+{
+    if (timestamp < hourStart || timestamp >= hourEnd) {
+        // 跨过整点（或时间戳倒退）时才做一次完整的本地时间转换
+        const QDateTime time = QDateTime::fromMSecsSinceEpoch(timestamp / NS_PER_MS);
+        const QDateTime hour(time.date(), QTime(time.time().hour(), 0));
+        hourStart = hour.toMSecsSinceEpoch() * NS_PER_MS;
+        hourEnd = hourStart + NS_PER_HOUR;
+        hourPrefix = hour.toString("[yyyy-MM-dd HH:");
+        if (timestamp < hourStart || timestamp >= hourEnd) {
+            // 夏令时切换等导致整点无法对齐时，本次按完整格式输出；QDateTime 只到毫秒，微秒另外补上
+            hourEnd = hourStart;
+            QString text = time.toString(prec == Seconds ? "[yyyy-MM-dd HH:mm:ss" : "[yyyy-MM-dd HH:mm:ss.zzz");
+            if (prec == Microseconds) {
+                text += QString("%1").arg((timestamp % NS_PER_MS) / NS_PER_US, 3, 10, QLatin1Char('0'));
+            }
+            return text + QLatin1String("] ");
+        }
+    }
+    
+    const qint64 offset = timestamp - hourStart;
+    const qint64 seconds = offset / NS_PER_SECOND;
+    const int fractionDigits = prec == Microseconds ? 6 : (prec == Milliseconds ? 3 : 0);
+    
+    QString text(hourPrefix.size() + 5 + (fractionDigits ? fractionDigits + 1 : 0) + 2, Qt::Uninitialized);
+    char16_t *out = reinterpret_cast<char16_t *>(text.data());
+    std::copy(hourPrefix.utf16(), hourPrefix.utf16() + hourPrefix.size(), out);
+    out += hourPrefix.size();
+    out = writeDigits(out, seconds / 60, 2);
+    *out++ = u':';
+    out = writeDigits(out, seconds % 60, 2);
+    if (fractionDigits == 3) {
+        *out++ = u'.';
+        out = writeDigits(out, (offset % NS_PER_SECOND) / NS_PER_MS, 3);
+    } else if (fractionDigits == 6) {
+        *out++ = u'.';
+        out = writeDigits(out, (offset % NS_PER_SECOND) / NS_PER_US, 6);
+    }
+    *out++ = u']';
+    *out++ = u' ';
+    return text;
+}
+
+QString TimestampFormatter::formatDelta(qint64 nanoseconds) const
+{
+    const QLatin1Char sign(nanoseconds < 0 ? '-' : '+');
+    const qint64 value = qAbs(nanoseconds);
+    if (prec == Microseconds) {
+        return QString("[%1%2.%3ms] ").arg(sign).arg(value / NS_PER_MS)
+            .arg((value % NS_PER_MS) / NS_PER_US, 3, 10, QLatin1Char('0'));
+    }
+    return QString("[%1%2ms] ").arg(sign).arg(value / NS_PER_MS);
+}
\ No newline at end of file
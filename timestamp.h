@@ -0,0 +1,46 @@
+#ifndef TIMESTAMP_H
+#define TIMESTAMP_H
+
+#include <QString>
+#include <QtGlobal>
+
+// 时间戳时钟
+// 以单调时钟计时，启动时与系统时间对齐一次，返回自1970-01-01 UTC起的纳秒数。
+// 调整系统时间不会让时间戳倒退；任意线程都可以调用，I/O线程在读到数据的当下取时间。
+class TimestampClock
+{
+public:
+    static qint64 now();
+};
+
+// 时间戳前缀格式化
+// 只在跨过整点时做一次本地时间转换并缓存 "[yyyy-MM-dd HH:" 部分，
+// 同一小时内的时间戳只按数字写出分、秒和小数部分，不再解析格式字符串。
+class TimestampFormatter
+{
+public:
+    enum Precision
+    {
+        Seconds,
+        Milliseconds,
+        Microseconds
+    };
+    
+    explicit TimestampFormatter(Precision precision = Seconds);
+    
+    void setPrecision(Precision precision);
+    Precision precision() const;
+    
+    // 输出 "[yyyy-MM-dd HH:mm:ss] "，按精度带 ".zzz" 或 ".zzzzzz"
+    QString format(qint64 timestamp);
+    // 与上一条记录的时间差，输出 "[+12ms] "，微秒精度时为 "[+12.345ms] "
+    QString formatDelta(qint64 nanoseconds) const;
+
+private:
+    Precision prec;
+    qint64 hourStart;       // 缓存的整点时刻（纳秒）
+    qint64 hourEnd;
+    QString hourPrefix;     // 该整点的 "[yyyy-MM-dd HH:"
+};
+
+#endif // TIMESTAMP_H
\ No newline at end of file
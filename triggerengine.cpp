@@ -0,0 +1,122 @@
+#include "triggerengine.h"
+#include "timestamp.h"
+#include <QSerialPort>
+
+// 触发事件队列容量；GUI线程每帧取走，一帧内的触发一般远少于此
+static const qint64 EVENT_CAPACITY = 1024;
+
+TriggerEngine::TriggerEngine(QIODevice *device, QObject *parent)
+    : QObject(parent)
+    , device(device)
+    , eventQueue(EVENT_CAPACITY)
+    , generation(0)
+    , scanPosition(0)
+    , scanTimestamp(0)
+    , enabled(false)
+    , matchCount(0)
+    , byteCount(0)
+    , lastLatency(0)
+    , maxLatency(0)
+    , latencySum(0)
+{
+    matcher.setMatchHandler([this](int rule, qint64 end) {
+        fire(rule, end);
+    });
+}
+
+void TriggerEngine::setWriteHook(const std::function<void(const char *, qint64)> &hook)
+{
+    writeHook = hook;
+}
+
+void TriggerEngine::setActionHook(const std::function<void(const TriggerRule &, qint64)> &hook)
+{
+    actionHook = hook;
+}
+
+bool TriggerEngine::isEnabled() const
+{
+    return enabled.load(std::memory_order_relaxed);
+}
+
+TriggerEngine::Stats TriggerEngine::stats() const
+{
+    Stats result;
+    result.matches = matchCount.load(std::memory_order_relaxed);
+    result.bytes = byteCount.load(std::memory_order_relaxed);
+    result.lastLatency = lastLatency.load(std::memory_order_relaxed);
+    result.maxLatency = maxLatency.load(std::memory_order_relaxed);
+    result.latencySum = latencySum.load(std::memory_order_relaxed);
+    return result;
+}
+
+void TriggerEngine::scan(const char *data, qint64 length, quint64 position, qint64 timestamp)
+{
+    if (!enabled.load(std::memory_order_relaxed)) {
+        return;
+    }
+    scanPosition = position - static_cast<quint64>(matcher.position());
+    scanTimestamp = timestamp;
+    matcher.feed(data, length);
+}
+
+void TriggerEngine::setRules(const QVector<TriggerRule> &rules)
+{
+    ruleList = rules;
+    ++generation;
+    QVector<QByteArray> patterns;
+    patterns.reserve(rules.size());
+    for (const TriggerRule &rule : rules) {
+        patterns.append(rule.pattern);
+    }
+    matcher.setPatterns(patterns);
+    matchCount.store(0, std::memory_order_relaxed);
+    lastLatency.store(0, std::memory_order_relaxed);
+    maxLatency.store(0, std::memory_order_relaxed);
+    latencySum.store(0, std::memory_order_relaxed);
+    enabled.store(!rules.isEmpty(), std::memory_order_relaxed);
+}
+
+void TriggerEngine::reset()
+{
+    matcher.reset();
+}
+
+void TriggerEngine::fire(int rule, qint64 end)
+{
+    const TriggerRule &trigger = ruleList.at(rule);
+    if (trigger.action == TriggerRule::Send) {
+        if (device->isOpen()) {
+            const qint64 written = device->write(trigger.payload);
+            if (written > 0) {
+                // QSerialPort 默认等回到事件循环才真正写出，这里立即交给驱动
+                if (QSerialPort *port = qobject_cast<QSerialPort *>(device)) {
+                    port->flush();
+                }
+                byteCount.fetch_add(written, std::memory_order_relaxed);
+                if (writeHook) {
+                    writeHook(trigger.payload.constData(), written);
+                }
+            }
+        }
+    } else if (actionHook) {
+        actionHook(trigger, scanTimestamp);
+    }
+    
+    // 从读到数据到动作执行完毕
+    const qint64 latency = TimestampClock::now() - scanTimestamp;
+    matchCount.fetch_add(1, std::memory_order_relaxed);
+    lastLatency.store(latency, std::memory_order_relaxed);
+    latencySum.fetch_add(latency, std::memory_order_relaxed);
+    if (latency > maxLatency.load(std::memory_order_relaxed)) {
+        maxLatency.store(latency, std::memory_order_relaxed);
+    }
+    
+    Event event;
+    event.rule = rule;
+    event.generation = generation;
+    event.action = trigger.action;
+    event.position = scanPosition + static_cast<quint64>(end);
+    event.timestamp = scanTimestamp;
+    eventQueue.push(event);
+}
\ No newline at end of file
@@ -0,0 +1,91 @@
+#ifndef TRIGGERENGINE_H
+#define TRIGGERENGINE_H
+
+#include <QObject>
+#include <QVector>
+#include <atomic>
+#include <functional>
+
+#include "spscringbuffer.h"
+#include "triggermatcher.h"
+
+class QIODevice;
+
+// 触发引擎，运行在会话的I/O线程中
+// 串口读到的每段数据在存入环形缓冲区之前先做多模式匹配，跨 readyRead 的匹配同样能找到。
+// 匹配到规则后当场在I/O线程中执行动作：发送数据直接写串口并立即刷出，标记和停止录制由动作回调完成，
+// 都不经过界面的事件循环；开始录制和暂停显示需要界面参与，由GUI线程在下一帧从事件队列中取出后执行。
+// 响应延迟为从读到数据到I/O线程执行完动作的时间。
+class TriggerEngine : public QObject
+{
+    Q_OBJECT
+
+public:
+    // 一次触发，由I/O线程放入队列，GUI线程取出
+    struct Event
+    {
+        int rule = -1;              // 规则序号
+        int generation = 0;         // 第几次 setRules 之后的规则，GUI线程据此忽略旧规则的事件
+        TriggerRule::Action action = TriggerRule::Send;
+        quint64 position = 0;       // 匹配末尾在接收流中的位置，对应 SpscRingBuffer 的读写位置
+        qint64 timestamp = 0;       // 匹配所在数据的读取时刻
+    };
+    
+    // 统计数据，任意线程都可以读取
+    struct Stats
+    {
+        qint64 matches = 0;         // 本组规则生效后的触发次数
+        qint64 bytes = 0;           // 自创建以来触发发送的总字节数
+        qint64 lastLatency = 0;     // 纳秒
+        qint64 maxLatency = 0;
+        qint64 latencySum = 0;
+        
+        double meanLatency() const
+        {
+            return matches > 0 ? static_cast<double>(latencySum) / matches : 0.0;
+        }
+    };
+    
+    explicit TriggerEngine(QIODevice *device, QObject *parent = nullptr);
+    
+    // 每次写入成功后在I/O线程中调用，用于统计和录制
+    void setWriteHook(const std::function<void(const char *, qint64)> &hook);
+    // 发送以外的动作在I/O线程中先交给该回调，timestamp 为匹配所在数据的读取时刻
+    void setActionHook(const std::function<void(const TriggerRule &, qint64)> &hook);
+    // 触发事件队列，I/O线程写入，GUI线程读取；队列满时事件被丢弃，I/O线程中的动作照常执行
+    SpscQueue<Event> *events() { return &eventQueue; }
+    
+    bool isEnabled() const;
+    Stats stats() const;
+    
+    // 在I/O线程中调用：检查刚读到的一段数据，position 为这段数据在接收流中的起点，timestamp 为读取时刻
+    void scan(const char *data, qint64 length, quint64 position, qint64 timestamp);
+
+public slots:
+    // 以下槽函数都应通过排队连接在I/O线程中调用
+    // 替换全部规则并清零统计，空列表为停用；每次调用规则代数加一
+    void setRules(const QVector<TriggerRule> &rules);
+    // 丢弃跨数据块的部分匹配，例如重新打开串口时
+    void reset();
+
+private:
+    void fire(int rule, qint64 end);
+    
+    QIODevice *device;
+    std::function<void(const char *, qint64)> writeHook;
+    std::function<void(const TriggerRule &, qint64)> actionHook;
+    QVector<TriggerRule> ruleList;
+    TriggerMatcher matcher;
+    SpscQueue<Event> eventQueue;
+    int generation;
+    quint64 scanPosition;       // 匹配器位置 0 对应的接收流位置
+    qint64 scanTimestamp;
+    std::atomic<bool> enabled;
+    std::atomic<qint64> matchCount;
+    std::atomic<qint64> byteCount;
+    std::atomic<qint64> lastLatency;
+    std::atomic<qint64> maxLatency;
+    std::atomic<qint64> latencySum;
+};
+
+#endif // TRIGGERENGINE_H
\ No newline at end of file
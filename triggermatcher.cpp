@@ -0,0 +1,228 @@
+#include "triggermatcher.h"
+#include "hexparser.h"
+#include <QStringList>
+#include <cstring>
+
+bool TriggerRule::parse(const QString &text, QString *errorString)
+{
+    auto fail = [errorString](const QString &message) {
+        if (errorString) {
+            *errorString = message;
+        }
+        return false;
+    };
+    
+    const int arrow = text.indexOf("=>");
+    if (arrow < 0) {
+        return fail("格式为 匹配内容 => 动作[:参数]");
+    }
+    QByteArray bytes;
+    if (!HexParser::parseEscaped(text.left(arrow).trimmed(), &bytes) || bytes.isEmpty()) {
+        return fail("匹配内容为空或转义无效");
+    }
+    
+    const QString command = text.mid(arrow + 2).trimmed();
+    const int colon = command.indexOf(':');
+    const QString name = (colon < 0 ? command : command.left(colon)).trimmed().toLower();
+    const QString argument = colon < 0 ? QString() : command.mid(colon + 1).trimmed();
+    // 顺序与 Action 一致
+    const QStringList names = {"send", "mark", "record", "stop", "pause"};
+    const int action = names.indexOf(name);
+    if (action < 0) {
+        return fail("动作应为 send、mark、record、stop 或 pause");
+    }
+    QByteArray data;
+    if (!HexParser::parseEscaped(argument, &data)) {
+        return fail("参数转义无效");
+    }
+    if (action == Send && data.isEmpty()) {
+        return fail("send 需要发送内容，例如 send:root\\r");
+    }
+    
+    pattern = bytes;
+    this->action = static_cast<Action>(action);
+    payload = data;
+    return true;
+}
+
+bool TriggerRule::parseList(const QString &text, QVector<TriggerRule> *rules, QString *errorString)
+{
+    rules->clear();
+    const QStringList lines = text.split('\n');
+    for (int i = 0; i < lines.size(); ++i) {
+        const QString line = lines.at(i).trimmed();
+        if (line.isEmpty() || line.startsWith('#')) {
+            continue;
+        }
+        TriggerRule rule;
+        QString error;
+        if (!rule.parse(line, &error)) {
+            if (errorString) {
+                *errorString = QString("第 %1 行：%2").arg(i + 1).arg(error);
+            }
+            return false;
+        }
+        rules->append(rule);
+    }
+    return true;
+}
+
+TriggerMatcher::TriggerMatcher()
+    : patterns(0)
+    , singleStart(-1)
+    , state(0)
+    , streamPosition(0)
+{
+    setPatterns(QVector<QByteArray>());
+}
+
+void TriggerMatcher::setPatterns(const QVector<QByteArray> &list)
+{
+    patterns = static_cast<int>(list.size());
+    
+    // 先建字典树：跳转表中 0 表示没有子节点（根状态不会是任何节点的子节点）
+    std::vector<std::vector<int>> matches(1);
+    transitions.assign(256, 0);
+    std::memset(startByte, 0, sizeof(startByte));
+    qint64 totalBytes = 0;
+    for (int index = 0; index < list.size(); ++index) {
+        const QByteArray &pattern = list.at(index);
+        if (pattern.isEmpty() || totalBytes + pattern.size() > MAX_PATTERN_BYTES) {
+            continue;
+        }
+        totalBytes += pattern.size();
+        startByte[static_cast<uchar>(pattern.at(0))] = true;
+        quint32 node = 0;
+        for (const char c : pattern) {
+            quint32 &next = transitions[node * 256 + static_cast<uchar>(c)];
+            if (next == 0) {
+                next = static_cast<quint32>(matches.size());
+                matches.emplace_back();
+                transitions.resize(transitions.size() + 256, 0);
+            }
+            // resize 之后重新取下标，不能沿用引用
+            node = transitions[node * 256 + static_cast<uchar>(c)];
+        }
+        matches[node].push_back(index);
+    }
+    
+    // 按层次遍历求失配链接，缺失的跳转直接填成沿失配链接得到的状态，
+    // 每个状态的匹配输出并入其失配状态的输出
+    const size_t states = matches.size();
+    std::vector<quint32> failure(states, 0);
+    std::vector<quint32> queue;
+    queue.reserve(states);
+    for (int c = 0; c < 256; ++c) {
+        if (transitions[c] != 0) {
+            queue.push_back(transitions[c]);
+        }
+    }
+    for (size_t head = 0; head < queue.size(); ++head) {
+        const quint32 node = queue[head];
+        const std::vector<int> &inherited = matches[failure[node]];
+        matches[node].insert(matches[node].end(), inherited.begin(), inherited.end());
+        for (int c = 0; c < 256; ++c) {
+            quint32 &next = transitions[node * 256 + c];
+            const quint32 fallback = transitions[failure[node] * 256 + c];
+            if (next != 0) {
+                failure[next] = fallback;
+                queue.push_back(next);
+            } else {
+                next = fallback;
+            }
+        }
+    }
+    
+    // 压平匹配输出，并在跳转表中标出带输出的目标状态
+    outputStart.assign(states + 1, 0);
+    outputs.clear();
+    for (size_t s = 0; s < states; ++s) {
+        outputStart[s] = static_cast<int>(outputs.size());
+        outputs.insert(outputs.end(), matches[s].begin(), matches[s].end());
+    }
+    outputStart[states] = static_cast<int>(outputs.size());
+    for (quint32 &next : transitions) {
+        if (!matches[next].empty()) {
+            next |= OUTPUT_FLAG;
+        }
+    }
+    
+    singleStart = -1;
+    int starts = 0;
+    for (int c = 0; c < 256; ++c) {
+        if (startByte[c]) {
+            singleStart = c;
+            ++starts;
+        }
+    }
+    if (starts != 1) {
+        singleStart = -1;
+    }
+    reset();
+}
+
+int TriggerMatcher::patternCount() const
+{
+    return patterns;
+}
+
+void TriggerMatcher::setMatchHandler(const MatchHandler &value)
+{
+    handler = value;
+}
+
+void TriggerMatcher::feed(const char *data, qint64 length)
+{
+    const uchar *begin = reinterpret_cast<const uchar *>(data);
+    const uchar *p = begin;
+    const uchar *end = begin + length;
+    const quint32 *table = transitions.data();
+    quint32 s = state;
+    while (p < end) {
+        if (s == 0) {
+            // 初始状态：跳过不可能开始匹配的字节
+            if (singleStart >= 0) {
+                const void *hit = std::memchr(p, singleStart, static_cast<size_t>(end - p));
+                if (!hit) {
+                    break;
+                }
+                p = static_cast<const uchar *>(hit);
+            } else {
+                while (p < end && !startByte[*p]) {
+                    ++p;
+                }
+                if (p == end) {
+                    break;
+                }
+            }
+        }
+        const quint32 next = table[s * 256 + *p++];
+        s = next & ~OUTPUT_FLAG;
+        if (next & OUTPUT_FLAG) {
+            emitMatches(s, streamPosition + (p - begin));
+        }
+    }
+    state = s;
+    streamPosition += length;
+}
+
+void TriggerMatcher::reset()
+{
+    state = 0;
+    streamPosition = 0;
+}
+
+qint64 TriggerMatcher::position() const
+{
+    return streamPosition;
+}
+
+void TriggerMatcher::emitMatches(quint32 s, qint64 end)
+{
+    if (!handler) {
+        return;
+    }
+    for (int i = outputStart[s]; i < outputStart[s + 1]; ++i) {
+        handler(outputs[i], end);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,82 @@
+#ifndef TRIGGERMATCHER_H
+#define TRIGGERMATCHER_H
+
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+#include <functional>
+#include <vector>
+
+// 一条触发规则：接收数据中出现 pattern 时执行 action
+struct TriggerRule
+{
+    enum Action
+    {
+        Send,               // 发送 payload
+        Marker,             // 插入一条标记，payload 为标记文字，为空时用匹配内容
+        StartRecord,        // 开始录制
+        StopRecord,         // 停止录制
+        PauseDisplay        // 暂停接收区显示，数据照常保存
+    };
+    
+    QByteArray pattern;
+    Action action = Send;
+    QByteArray payload;
+    
+    // 标记文字：没有参数时为匹配内容
+    QByteArray markerText() const
+    {
+        return payload.isEmpty() ? pattern : payload;
+    }
+    
+    // 按一行文本设置，格式为 匹配内容 => 动作[:参数]，动作为 send、mark、record、stop 或 pause；
+    // 匹配内容和参数的转义与分隔符参数相同，两端空白被去掉，需要空格时写作 \x20
+    bool parse(const QString &text, QString *errorString = nullptr);
+    // 每行一条规则，忽略空行和以 # 开头的行；出错时给出行号
+    static bool parseList(const QString &text, QVector<TriggerRule> *rules, QString *errorString = nullptr);
+};
+
+// 多模式匹配（Aho–Corasick）
+// 所有模式建成一个按字节跳转的确定自动机，每个输入字节只查一次表，与模式个数无关；
+// 状态在 feed 之间保留，跨数据块的匹配同样能找到。在初始状态时先跳过不可能开始匹配的字节，
+// 所有模式首字节相同时用 memchr 跳过，没有匹配的数据几乎不花时间。
+class TriggerMatcher
+{
+public:
+    // 匹配回调：模式序号和匹配末尾之后的字节在数据流中的位置
+    using MatchHandler = std::function<void(int pattern, qint64 end)>;
+    
+    // 所有模式合计的最大字节数，限制跳转表的大小
+    static const int MAX_PATTERN_BYTES = 4096;
+    
+    TriggerMatcher();
+    
+    // 重建自动机并回到初始状态；空模式不会匹配，超过总长度上限的模式被忽略
+    void setPatterns(const QVector<QByteArray> &patterns);
+    int patternCount() const;
+    void setMatchHandler(const MatchHandler &handler);
+    
+    void feed(const char *data, qint64 length);
+    // 丢弃跨数据块的部分匹配，数据流位置归零
+    void reset();
+    // 已输入的字节数
+    qint64 position() const;
+
+private:
+    // 跳转表中目标状态带有匹配输出时置该位
+    static const quint32 OUTPUT_FLAG = 0x80000000u;
+    
+    void emitMatches(quint32 state, qint64 end);
+    
+    MatchHandler handler;
+    int patterns;
+    std::vector<quint32> transitions;   // 状态数 * 256，低 31 位为下一状态
+    std::vector<int> outputStart;       // 状态 s 的匹配模式为 outputs[outputStart[s], outputStart[s + 1])
+    std::vector<int> outputs;
+    bool startByte[256];                // 能作为某个模式第一个字节
+    int singleStart;                    // 所有模式首字节相同时为该字节，否则为 -1
+    quint32 state;
+    qint64 streamPosition;
+};
+
+#endif // TRIGGERMATCHER_H
\ No newline at end of file